@@ -0,0 +1,105 @@
+/*
+capture.c
+2026-10-18
+Public Domain
+
+http://abyz.me.uk/lg/lgpio.html
+
+gcc -Wall -o capture capture.c -llgpio
+
+./capture file seconds [chip:]gpio ...
+
+Records the edges on the GPIO to file for seconds.  The file may
+be replayed with replay.
+
+e.g.
+
+./capture edges.lgcap 10 23 24 # record gpiochip0: 23,24 for 10 seconds
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <lgpio.h>
+
+#define MAX_REPORTS 1000000
+
+int main(int argc, char *argv[])
+{
+   int i, h=-1, err, nfy;
+   int chip = 0;
+   int c, g;
+   char d;
+   double seconds;
+   lgNotifyStats_t stats;
+
+   if (argc < 4)
+   {
+      fprintf(stderr, "usage: capture file seconds [chip:]gpio ...\n");
+      return -1;
+   }
+
+   seconds = atof(argv[2]);
+
+   nfy = lgNotifyOpenCapture(argv[1], MAX_REPORTS);
+
+   if (nfy < 0)
+   {
+      fprintf(stderr, "can't create %s (%s)\n", argv[1], lguErrorText(nfy));
+      return -1;
+   }
+
+   for (i=3; i<argc; i++)
+   {
+      c=-1; g=-1; d=-1;
+
+      if (sscanf(argv[i], "%d:%d%c", &c, &g, &d) == 2)
+      {
+         if (c != chip) h = -1; /* force open of new gpiochip */
+
+         chip = c;
+      }
+      else if (sscanf(argv[i], "%d%c", &g, &d) != 1)
+      {
+         printf("don't understand %s\n", argv[i]);
+         return -1;
+      }
+
+      if (h < 0)
+      {
+         /* get a handle to the gpiochip */
+         h = lgGpiochipOpen(chip);
+
+         if (h < 0)
+         {
+            fprintf(stderr, "can't open gpiochip %d (%s)\n",
+               chip, lguErrorText(h));
+            return -1;
+         }
+      }
+
+      /* send the GPIO alerts to the capture file */
+      err = lgGpioClaimAlert(h, 0, LG_BOTH_EDGES, g, nfy);
+
+      if (err < 0)
+      {
+         fprintf(stderr, "GPIO in use %d:%d (%s)\n",
+            chip, g, lguErrorText(err));
+         return -1;
+      }
+   }
+
+   lguSleep(seconds);
+
+   lgNotifyGetStats(nfy, &stats);
+
+   lgNotifyClose(nfy);
+
+   printf("recorded %"PRIu64" edges, dropped %"PRIu64"\n",
+      stats.sent, stats.dropped);
+
+   return 0;
+}
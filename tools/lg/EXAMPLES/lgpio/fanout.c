@@ -0,0 +1,195 @@
+/*
+fanout.c
+2026-10-18
+Public Domain
+
+http://abyz.me.uk/lg/lgpio.html
+
+gcc -Wall -o fanout fanout.c -llgpio
+
+./fanout chip subscribers seconds [sim_dir]
+
+Notification fan-out load test.  Each subscriber is a ring
+notification of its own which is given the alerts of one line of
+the gpiochip, lines 0 to subscribers-1.  At the end it reports how
+many subscribers received reports and how many reports were dropped.
+
+The edges may come from outside or, with sim_dir, be generated on a
+gpio-sim chip by toggling the pull of each line in turn.  A 200 line
+gpio-sim chip may be made with
+
+mkdir /sys/kernel/config/gpio-sim/fan
+mkdir /sys/kernel/config/gpio-sim/fan/bank0
+echo 200 >/sys/kernel/config/gpio-sim/fan/bank0/num_lines
+echo 1 >/sys/kernel/config/gpio-sim/fan/live
+
+e.g.
+
+./fanout 1 200 10 /sys/devices/platform/gpio-sim.0/gpiochip1
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <lgpio.h>
+
+#define MAX_SUBSCRIBERS 1000
+#define READ_REPORTS 256
+
+static int nfy[MAX_SUBSCRIBERS];
+static lgNotifyRing_p ring[MAX_SUBSCRIBERS];
+static uint64_t got[MAX_SUBSCRIBERS];
+static uint64_t toggled[MAX_SUBSCRIBERS];
+
+static int setPull(char *simDir, int line, int up)
+{
+   FILE *f;
+   char path[256];
+
+   snprintf(path, sizeof(path), "%s/sim_gpio%d/pull", simDir, line);
+
+   f = fopen(path, "w");
+
+   if (f == NULL) return -1;
+
+   fputs(up ? "pull-up" : "pull-down", f);
+
+   fclose(f);
+
+   return 0;
+}
+
+static void drain(int subscribers)
+{
+   int i, count;
+   lgGpioReport_t reports[READ_REPORTS];
+
+   for (i=0; i<subscribers; i++)
+   {
+      while ((count = lgNotifyRingRead(ring[i], READ_REPORTS, reports, 0)) > 0)
+         got[i] += count;
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   int h, i, fd, err, subscribers, served, pass;
+   char *simDir = NULL;
+   double seconds, start, end;
+   uint64_t total, expected, sent, dropped;
+   lgNotifyStats_t stats;
+
+   if (argc < 4)
+   {
+      fprintf(stderr, "usage: fanout chip subscribers seconds [sim_dir]\n");
+      return 1;
+   }
+
+   subscribers = atoi(argv[2]);
+   seconds = atof(argv[3]);
+   if (argc > 4) simDir = argv[4];
+
+   if ((subscribers < 1) || (subscribers > MAX_SUBSCRIBERS))
+   {
+      fprintf(stderr, "subscribers must be 1-%d\n", MAX_SUBSCRIBERS);
+      return 1;
+   }
+
+   h = lgGpiochipOpen(atoi(argv[1]));
+
+   if (h < 0)
+   {
+      fprintf(stderr, "can't open gpiochip %s (%s)\n",
+         argv[1], lguErrorText(h));
+      return 1;
+   }
+
+   for (i=0; i<subscribers; i++)
+   {
+      nfy[i] = lgNotifyOpenRing(0);
+
+      if (nfy[i] < 0)
+      {
+         fprintf(stderr, "notification %d failed (%s)\n",
+            i, lguErrorText(nfy[i]));
+         return 1;
+      }
+
+      fd = lgNotifyRingFd(nfy[i]);
+      ring[i] = lgNotifyRingMap(fd);
+      close(fd);
+
+      if (simDir) setPull(simDir, i, 0);
+
+      err = lgGpioClaimAlert(h, 0, LG_BOTH_EDGES, i, nfy[i]);
+
+      if ((err < 0) || (ring[i] == NULL))
+      {
+         fprintf(stderr, "subscriber %d failed (%s)\n", i, lguErrorText(err));
+         return 1;
+      }
+   }
+
+   start = lguTime();
+   end = start + seconds;
+   pass = 0;
+
+   while (lguTime() < end)
+   {
+      if (simDir)
+      {
+         pass++;
+
+         for (i=0; i<subscribers; i++)
+         {
+            if (setPull(simDir, i, pass & 1) == 0) toggled[i]++;
+         }
+      }
+      else lguSleep(0.01);
+
+      drain(subscribers);
+   }
+
+   lguSleep(0.1); /* let the alert thread emit the last edges */
+
+   drain(subscribers);
+
+   end = lguTime();
+
+   served = 0;
+   total = 0;
+   expected = 0;
+   sent = 0;
+   dropped = 0;
+
+   for (i=0; i<subscribers; i++)
+   {
+      if (got[i]) served++;
+
+      total += got[i];
+      expected += toggled[i];
+
+      if (lgNotifyGetStats(nfy[i], &stats) == 0)
+      {
+         sent += stats.sent;
+         dropped += stats.dropped;
+      }
+
+      lgGpioFree(h, i);
+      lgNotifyRingUnmap(ring[i]);
+      lgNotifyClose(nfy[i]);
+   }
+
+   printf("subscribers served %d/%d\n", served, subscribers);
+   printf("reports read %"PRIu64" sent %"PRIu64" dropped %"PRIu64,
+      total, sent, dropped);
+   if (simDir) printf(" expected %"PRIu64, expected);
+   printf("\n%.0f reports per second\n", total / (end - start));
+
+   lgGpiochipClose(h);
+
+   return (served == subscribers) ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+/*
+replay.c
+2026-10-18
+Public Domain
+
+http://abyz.me.uk/lg/lgpio.html
+
+gcc -Wall -o replay replay.c -llgpio
+
+./replay file [speed]
+
+Replays a file recorded by capture.  speed is 1 for the recorded
+timing (the default), 2 for twice as fast, etc., or 0 to replay
+as fast as possible.
+
+e.g.
+
+./replay edges.lgcap     # replay in real time
+./replay edges.lgcap 0   # replay as fast as possible
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <lgpio.h>
+
+/* callback function */
+void cbf(int e, lgGpioAlert_p evt, void *data)
+{
+   int i;
+   int secs, nanos;
+
+   for (i=0; i<e; i++)
+   {
+      secs = evt[i].report.timestamp / 1000000000L;
+      nanos = evt[i].report.timestamp % 1000000000L;
+
+      printf("chip=%d gpio=%d level=%d time=%d.%09d\n",
+         evt[i].report.chip, evt[i].report.gpio, evt[i].report.level,
+         secs, nanos);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   int count;
+   double speed = 1.0;
+
+   if (argc < 2)
+   {
+      fprintf(stderr, "usage: replay file [speed]\n");
+      return -1;
+   }
+
+   if (argc > 2) speed = atof(argv[2]);
+
+   lgGpioSetSamplesFunc(cbf, NULL); /* call cbf for the replayed alerts */
+
+   count = lgCaptureReplay(argv[1], 0, speed);
+
+   if (count < 0)
+   {
+      fprintf(stderr, "can't replay %s (%s)\n", argv[1], lguErrorText(count));
+      return -1;
+   }
+
+   fprintf(stderr, "replayed %d edges\n", count);
+
+   return 0;
+}
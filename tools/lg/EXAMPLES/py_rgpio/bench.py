@@ -31,9 +31,23 @@ for i in range(LOOPS):
 
 t1 = time.time()
 
-sbc.gpiochip_close(h)
-
 print("{:.0f} toggles per second".format(LOOPS/(t1-t0)))
 
+t0 = time.time()
+
+sbc.pipeline_start()
+
+for i in range(LOOPS):
+   sbc.gpio_write(h, OUT, 0)
+   sbc.gpio_write(h, OUT, 1)
+
+sbc.pipeline_stop()
+
+t1 = time.time()
+
+print("{:.0f} pipelined toggles per second".format(LOOPS/(t1-t0)))
+
+sbc.gpiochip_close(h)
+
 sbc.stop()
 
@@ -5,9 +5,16 @@ Public Domain
 
 http://abyz.me.uk/lg/rgpio.html
 
-gcc Wall -o bench bench.c -lrgpio
+gcc -Wall -o bench bench.c -lrgpio
 
-./bench
+./bench [address ...]
+
+Reports the command round trip time and GPIO toggle rate for each
+address, or for the default daemon if none is given.  Give both a
+TCP and a Unix socket address to compare them, e.g. for a daemon
+started with rgpiod -u /run/rgpiod.sock
+
+./bench localhost unix:/run/rgpiod.sock
 */
 
 #include <stdio.h>
@@ -21,21 +28,32 @@ gcc Wall -o bench bench.c -lrgpio
 #define OUT 21
 #define LOOPS 5000
 
-int main(int argc, char *argv[])
+void bench(const char *addr)
 {
    int sbc;
    int h;
    int i;
+   char name[64];
    double t0, t1;
 
-   sbc = rgpiod_start(NULL, NULL);
+   sbc = rgpiod_start(addr, NULL);
 
    if (sbc < 0)
    {
-      printf("connection failed\n");
-      exit(-1);
+      printf("%s: connection failed\n", addr ? addr : "default");
+      return;
    }
 
+   printf("%s:\n", addr ? addr : "default");
+
+   t0 = lgu_time();
+
+   for (i=0; i<LOOPS; i++) lgu_get_sbc_name(sbc, name, sizeof(name));
+
+   t1 = lgu_time();
+
+   printf("%.1f us round trip\n", 1E6 * (t1-t0) / LOOPS);
+
    h = gpiochip_open(sbc, 0);
 
    if (h >= 0)
@@ -54,6 +72,22 @@ int main(int argc, char *argv[])
          t1 = lgu_time();
 
          printf("%.0f toggles per second\n", (1.0 * LOOPS)/(t1-t0));
+
+         t0 = lgu_time();
+
+         lgu_pipeline_start(sbc);
+
+         for (i=0; i<LOOPS; i++)
+         {
+            gpio_write(sbc, h, OUT, 0);
+            gpio_write(sbc, h, OUT, 1);
+         }
+
+         lgu_pipeline_stop(sbc, NULL, 0);
+
+         t1 = lgu_time();
+
+         printf("%.0f pipelined toggles per second\n", (1.0 * LOOPS)/(t1-t0));
       }
 
       gpiochip_close(sbc, h);
@@ -62,3 +96,13 @@ int main(int argc, char *argv[])
    rgpiod_stop(sbc);
 }
 
+int main(int argc, char *argv[])
+{
+   int i;
+
+   if (argc < 2) bench(NULL);
+
+   for (i=1; i<argc; i++) bench(argv[i]);
+
+   return 0;
+}
@@ -0,0 +1,115 @@
+/*
+pool.c
+2026-10-18
+Public Domain
+
+http://abyz.me.uk/lg/rgpio.html
+
+gcc -Wall -o pool pool.c -lrgpio -lpthread
+
+./pool
+
+Checks that a handle opened by one thread of a connection pool can
+be used by another thread, which has its own channel, that the pool
+refuses lgu_use_share_id, and that the handle is freed when the pool
+is stopped.  A script handle is used as it needs no hardware.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <lgpio.h>
+#include <rgpio.h>
+
+#define CHANNELS 4
+
+static int sbc;
+static int handle;
+static int failed;
+
+static void *opener(void *x)
+{
+   handle = script_store(sbc, "tag 1 mils 100 jmp 1");
+
+   return NULL;
+}
+
+static void *user(void *x)
+{
+   int status;
+   uint32_t par[10];
+
+   status = script_status(sbc, handle, par);
+
+   printf("%s: status from another channel %d (%s)\n",
+      (char *)x, status, status < 0 ? lgu_error_text(status) : "OK");
+
+   if (status < 0) failed++;
+
+   return NULL;
+}
+
+static void inThread(void *(*func)(void *), char *name)
+{
+   pthread_t thr;
+
+   pthread_create(&thr, NULL, func, name);
+   pthread_join(thr, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+   int other, status;
+   uint32_t par[10];
+
+   sbc = rgpiod_start_pool(NULL, NULL, CHANNELS);
+
+   if (sbc < 0)
+   {
+      printf("connection failed\n");
+      exit(-1);
+   }
+
+   /* each new thread is given the next channel */
+
+   inThread(opener, "open");
+
+   if (handle < 0)
+   {
+      printf("script_store failed (%s)\n", lgu_error_text(handle));
+      exit(-1);
+   }
+
+   inThread(user, "pool share");
+
+   status = lgu_use_share_id(sbc, 23);
+
+   printf("use share 23: status %d (%s)\n", status, lgu_error_text(status));
+
+   if (status != lgif_pool_share) failed++;
+
+   inThread(user, "after use share 23");
+
+   rgpiod_stop(sbc);
+
+   /* the handle should have been freed with the pool */
+
+   other = rgpiod_start(NULL, NULL);
+
+   if (other >= 0)
+   {
+      status = script_status(other, handle, par);
+
+      printf("after stop: status %d (%s)\n", status,
+         status < 0 ? lgu_error_text(status) : "OK");
+
+      if (status != LG_BAD_HANDLE) failed++;
+
+      rgpiod_stop(other);
+   }
+
+   printf("%s\n", failed ? "FAILED" : "OK");
+
+   return failed ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+/*
+script_speed.c
+2026-10-18
+Public Domain
+
+http://abyz.me.uk/lg/rgpio.html
+
+gcc -Wall -o script_speed script_speed.c -lrgpio
+
+./script_speed [loops [chip gpio]]
+
+Reports how many script instructions rgpiod executes per second.
+
+The first script only uses the script's own instructions.  The second
+also reads a GPIO each time around its loop.  If no gpiochip is given
+it reads from a handle which isn't open, each read fails at once so
+only the cost of running the command is measured.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <lgpio.h>
+#include <rgpio.h>
+
+#define NO_HANDLE 0xffff
+
+/* 3 instructions a loop */
+#define VM_SCRIPT "ld v0 p0 tag 1 inra dcr v0 jnz 1"
+
+/* 3 instructions a loop, one a GPIO read */
+#define GR_SCRIPT "ld v0 p0 tag 1 gr p1 p2 dcr v0 jnz 1"
+
+#define CHIP_SCRIPT \
+   "go p1 sta v1 gsi v1 p2 ld v0 p0 tag 1 gr v1 p2 dcr v0 jnz 1 gc v1"
+
+int run(int sbc, char *name, char *text, int loops, uint32_t *par, int pars)
+{
+   int h, status;
+   uint32_t p[10]; /* a script has 10 parameters */
+   double t0, t1;
+
+   h = script_store(sbc, text);
+
+   if (h < 0)
+   {
+      printf("%s: script_store failed (%s)\n", name, lgu_error_text(h));
+      return -1;
+   }
+
+   while (script_status(sbc, h, p) == LG_SCRIPT_INITING) lgu_sleep(0.001);
+
+   t0 = lgu_time();
+
+   status = script_run(sbc, h, pars, par);
+
+   if (status < 0)
+   {
+      printf("%s: script_run failed (%s)\n", name, lgu_error_text(status));
+      script_delete(sbc, h);
+      return -1;
+   }
+
+   while ((status = script_status(sbc, h, p)) == LG_SCRIPT_RUNNING)
+      lgu_sleep(0.0005);
+
+   t1 = lgu_time();
+
+   printf("%s: %d loops in %.3f s, %.0f instructions per second\n",
+      name, loops, t1 - t0, (3.0 * loops) / (t1 - t0));
+
+   script_delete(sbc, h);
+
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   int sbc;
+   int loops = 1000000;
+   uint32_t par[3];
+
+   if (argc > 1) loops = atoi(argv[1]);
+
+   sbc = rgpiod_start(NULL, NULL);
+
+   if (sbc < 0)
+   {
+      printf("connection failed\n");
+      exit(-1);
+   }
+
+   par[0] = loops;
+
+   run(sbc, "script", VM_SCRIPT, loops, par, 1);
+
+   if (argc > 3)
+   {
+      par[1] = atoi(argv[2]);
+      par[2] = atoi(argv[3]);
+
+      run(sbc, "gpio read", CHIP_SCRIPT, loops, par, 3);
+   }
+   else
+   {
+      par[1] = NO_HANDLE;
+      par[2] = 0;
+
+      run(sbc, "command", GR_SCRIPT, loops, par, 3);
+   }
+
+   rgpiod_stop(sbc);
+
+   return 0;
+}
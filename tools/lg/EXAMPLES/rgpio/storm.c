@@ -0,0 +1,132 @@
+/*
+storm.c
+2026-10-18
+Public Domain
+
+http://abyz.me.uk/lg/rgpio.html
+
+gcc -Wall -o storm storm.c -lrgpio -lpthread
+
+./storm [clients [seconds]]
+
+Simulates a reconnect storm.  Each client repeatedly connects to
+rgpiod, sends one command, and disconnects.  Reports connections
+per second and connect latency percentiles.  Compare runs against
+rgpiod and rgpiod -a 4.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <lgpio.h>
+#include <rgpio.h>
+
+#define MAX_CLIENTS 30 /* rgpio allows 32 connected SBCs */
+#define MAX_SAMPLES 100000
+
+static double gSeconds = 5.0;
+static double gLatency[MAX_CLIENTS][MAX_SAMPLES];
+static int gCount[MAX_CLIENTS];
+static int gFailed[MAX_CLIENTS];
+
+static void *client(void *x)
+{
+   int id = *(int *)x;
+   int sbc;
+   char name[64];
+   double t0, t1, end;
+
+   end = lgu_time() + gSeconds;
+
+   while ((t0 = lgu_time()) < end)
+   {
+      sbc = rgpiod_start(NULL, NULL);
+
+      if ((sbc >= 0) && (lgu_get_sbc_name(sbc, name, sizeof(name)) >= 0))
+      {
+         t1 = lgu_time();
+
+         if (gCount[id] < MAX_SAMPLES) gLatency[id][gCount[id]++] = t1 - t0;
+      }
+      else gFailed[id]++;
+
+      if (sbc >= 0) rgpiod_stop(sbc);
+   }
+
+   return NULL;
+}
+
+static int cmp(const void *a, const void *b)
+{
+   double d = *(double *)a - *(double *)b;
+
+   return (d > 0) - (d < 0);
+}
+
+int main(int argc, char *argv[])
+{
+   int clients = 16;
+   int i, total, failed;
+   int ids[MAX_CLIENTS];
+   pthread_t thr[MAX_CLIENTS];
+   double *all;
+
+   if (argc > 1) clients = atoi(argv[1]);
+   if (argc > 2) gSeconds = atof(argv[2]);
+
+   if ((clients < 1) || (clients > MAX_CLIENTS))
+   {
+      printf("clients must be 1-%d\n", MAX_CLIENTS);
+      exit(-1);
+   }
+
+   /* the first connection sets up the library */
+
+   i = rgpiod_start(NULL, NULL);
+
+   if (i < 0)
+   {
+      printf("connection failed\n");
+      exit(-1);
+   }
+
+   rgpiod_stop(i);
+
+   for (i=0; i<clients; i++)
+   {
+      ids[i] = i;
+      pthread_create(&thr[i], NULL, client, &ids[i]);
+   }
+
+   for (i=0; i<clients; i++) pthread_join(thr[i], NULL);
+
+   all = malloc(clients * MAX_SAMPLES * sizeof(double));
+
+   for (i=0, total=0, failed=0; i<clients; i++)
+   {
+      memcpy(all+total, gLatency[i], gCount[i] * sizeof(double));
+      total += gCount[i];
+      failed += gFailed[i];
+   }
+
+   if (total == 0)
+   {
+      printf("no connections succeeded\n");
+      exit(-1);
+   }
+
+   qsort(all, total, sizeof(double), cmp);
+
+   printf("%d clients, %.0f connections per second, %d failed\n",
+      clients, total / gSeconds, failed);
+
+   printf("connect+command ms: p50=%.3f p90=%.3f p99=%.3f max=%.3f\n",
+      all[total/2]*1000.0, all[(total*9)/10]*1000.0,
+      all[(total*99)/100]*1000.0, all[total-1]*1000.0);
+
+   free(all);
+
+   return 0;
+}
@@ -99,6 +99,7 @@ tx_room                   See if more room for tx on a GPIO or group
 
 gpio_set_debounce_micros  Sets the debounce time for a GPIO
 gpio_set_watchdog_micros  Sets the watchdog time for a GPIO
+gpio_set_line_info_alerts Starts alerts on GPIO ownership changes
 
 callback                  Starts a GPIO callback
 
@@ -138,6 +139,7 @@ notify_open               Request a notification handle
 notify_close              Close a notification
 notify_pause              Pause notifications
 notify_resume             Resume notifications
+notify_filter             Select the reports a notification receives
 
 SERIAL
 
@@ -629,6 +631,10 @@ extern int lgGpioSetDebounce(int handle, int gpio, int debounce_us);
 %rename(_gpio_set_watchdog_micros) lgGpioSetWatchdog;
 extern int lgGpioSetWatchdog(int handle, int gpio, int watchdog_us);
 
+%rename(_gpio_set_line_info_alerts) lgGpioSetLineInfoAlerts;
+extern int lgGpioSetLineInfoAlerts(
+   int handle, int gpio, int enable, int nfyHandle);
+
 %rename(_notify_open) lgNotifyOpen;
 extern int lgNotifyOpen(void);
 
@@ -641,6 +647,10 @@ extern int lgNotifyPause(int handle);
 %rename(_notify_close) lgNotifyClose;
 extern int lgNotifyClose(int handle);
 
+%rename(_notify_filter) lgNotifyFilter;
+extern int lgNotifyFilter(
+   int handle, int chip, uint64_t gpioMask, int edgeMask, int decimation);
+
 %rename(_i2c_open) lgI2cOpen;
 extern int lgI2cOpen(int i2cDev, int i2cAddr, int i2cFlags);
 
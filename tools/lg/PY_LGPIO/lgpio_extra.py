@@ -38,6 +38,16 @@ RISING_EDGE = 1
 FALLING_EDGE = 2
 BOTH_EDGES = 3
 
+# report flags
+
+REPORT_LINE_INFO = 1
+
+# line info report levels
+
+LINE_REQUESTED = 1
+LINE_RELEASED = 2
+LINE_RECONFIGURED = 3
+
 # tx constants
 
 TX_PWM = 0
@@ -156,6 +166,12 @@ BAD_PWM_FREQ = -102
 BAD_PWM_DUTY = -103
 GPIO_NOT_AN_OUTPUT = -104
 INVALID_GROUP_ALERT = -105
+BAD_NOTIFY_SLOTS = -106
+BAD_NOTIFY_FILTER = -107
+BAD_CAPTURE = -108
+BAD_ALERTS_QUEUE = -109
+BAD_BATCH = -110
+BAD_STREAM = -111
 
 class error(Exception):
    """
@@ -321,7 +337,7 @@ class _callback_thread(threading.Thread):
                for cb in self.callbacks:
                   if cb.chip == chip and cb.gpio == gpio:
                      cb.func(chip, gpio, level, tick)
-            else: # no flags currently defined, ignore.
+            else: # e.g. REPORT_LINE_INFO, not for edge callbacks.
                pass
 
          buf = buf[offset:]
@@ -1032,6 +1048,31 @@ def gpio_set_watchdog_micros(handle, gpio, watchdog_micros):
       handle&0xffff, gpio, watchdog_micros))
 
 
+def gpio_set_line_info_alerts(handle, gpio, enable, notify_handle):
+   """
+   This starts or stops alerts when a GPIO is claimed, released,
+   or reconfigured by any user.
+
+          handle:= >= 0 (as returned by [*gpiochip_open*]).
+            gpio:= >= 0, as legal for the gpiochip.
+          enable:= True to start alerts, False to stop them.
+   notify_handle:= >= 0 (as returned by [*notify_open*]).
+
+   If OK returns 0.
+
+   On failure returns a negative error code.
+
+   The GPIO does not need to be claimed.
+
+   Each change is sent to the notification handle as a report
+   with flags set to REPORT_LINE_INFO and level set to
+   LINE_REQUESTED, LINE_RELEASED, or LINE_RECONFIGURED.
+   These reports are not passed to callbacks.
+   """
+   return _u2i(_lgpio._gpio_set_line_info_alerts(
+      handle&0xffff, gpio, int(bool(enable)), notify_handle))
+
+
 def gpio_claim_alert(
    handle, gpio, eFlags, lFlags=0, notify_handle=None):
    """
@@ -1762,6 +1803,34 @@ def notify_close(handle):
    """
    return _u2i(_lgpio._notify_close(handle))
 
+def notify_filter(
+   handle, chip, gpio_mask, edge_mask=BOTH_EDGES, decimation=0):
+   """
+   Selects the reports delivered to a notification.
+
+       handle:= >= 0 (as returned by [*notify_open*])
+         chip:= the gpiochip device number, or -1 for any gpiochip.
+    gpio_mask:= bit n set to deliver reports for GPIO n.
+    edge_mask:= RISING_EDGE, FALLING_EDGE, BOTH_EDGES, or 0.
+   decimation:= 0 or 1 to deliver every edge, n to deliver every nth
+                edge of each GPIO.
+
+   If OK returns 0.
+
+   On failure returns a negative error code.
+
+   Reports for GPIO above 63 are not affected by gpio_mask.
+   Watchdog reports (level 2) and reports with non-zero flags
+   are not affected by edge_mask or decimation.
+
+   ...
+   # only rising edges of GPIO 5 and 6 on gpiochip 0
+   sbc.notify_filter(h, 0, (1<<5)|(1<<6), sbc.RISING_EDGE)
+   ...
+   """
+   return _u2i(_lgpio._notify_filter(
+      handle, chip, gpio_mask & 0xffffffffffffffff, edge_mask, decimation))
+
 # SERIAL
 
 def serial_open(tty, baud, ser_flags=0):
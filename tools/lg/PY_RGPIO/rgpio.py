@@ -141,6 +141,7 @@ tx_room                   See if more room for tx on a GPIO or group
 
 gpio_set_debounce_micros  Sets the debounce time for a GPIO
 gpio_set_watchdog_micros  Sets the watchdog time for a GPIO
+gpio_set_line_info_alerts Starts alerts on GPIO ownership changes
 
 callback                  Starts a GPIO callback
 
@@ -180,6 +181,7 @@ notify_open               Request a notification handle
 notify_close              Close a notification
 notify_pause              Pause notifications
 notify_resume             Resume notifications
+notify_filter             Select the reports a notification receives
 
 SCRIPTS
 
@@ -223,10 +225,20 @@ get_sbc_name              Get the SBC name
 get_internal              Get an SBC configuration value
 set_internal              Set an SBC configuration value
 
+get_cmd_stats             Get the daemon's per-command statistics
+
+set_frame_size            Allow larger commands and replies
+
 set_user                  Set the user (and associated permissions)
 set_share_id              Set the share id for a resource
 use_share_id              Use this share id when asking for a resource
 
+pipeline_start            Start sending commands without waiting for replies
+pipeline_stop             Wait for and return the pipelined command statuses
+
+batch_start               Start collecting commands into a batch
+batch_stop                Execute the batch in one round trip
+
 rgpio.get_module_version  Get the rgpio Python module version
 rgpio.error_text          Get the error text for an error code
 """
@@ -275,6 +287,16 @@ RISING_EDGE = 1
 FALLING_EDGE = 2
 BOTH_EDGES = 3
 
+# report flags
+
+REPORT_LINE_INFO = 1
+
+# line info report levels
+
+LINE_REQUESTED = 1
+LINE_RELEASED = 2
+LINE_RECONFIGURED = 3
+
 # tx constants
 
 TX_PWM = 0
@@ -312,6 +334,14 @@ SPI_MODE_2 = 2
 SPI_MODE_3 = 3
 
 _SOCK_CMD_LEN = 16
+_UNIX_ADDR_PREFIX = "unix:"
+_SOCK_ID_LEN = 4
+_PIPELINE_WINDOW = 1024
+_CMD_MAX_EXTENSION = 65536
+_BATCH_HDR_LEN = 8
+_BATCH_ALIGN = 8
+_STATS_BUCKETS = 24
+_STATS_FMT = 'II4Q{}Q'.format(_STATS_BUCKETS)
 
 # rgpiod command numbers
 
@@ -345,6 +375,7 @@ _CMD_GWDOG = 30
 _CMD_GIC = 31
 _CMD_GIL = 32
 _CMD_GMODE = 33
+_CMD_GILA = 34
 _CMD_I2CO = 40
 _CMD_I2CC = 41
 _CMD_I2CRD = 42
@@ -367,6 +398,7 @@ _CMD_NO = 70
 _CMD_NC = 71
 _CMD_NR = 72
 _CMD_NP = 73
+_CMD_NF = 74
 _CMD_PARSE = 80
 _CMD_PROC = 81
 _CMD_PROCD = 82
@@ -392,8 +424,15 @@ _CMD_CGI = 115
 _CMD_CSI = 116
 _CMD_NOIB = 117
 _CMD_SHELL = 118
+_CMD_NOIBC = 119
+
+_COMPACT_ALTERNATE = 0x80
 _CMD_SBC = 120
 _CMD_FREE = 121
+_CMD_RIDS = 122
+_CMD_BATCH = 123
+_CMD_STATS = 124
+_CMD_FRAME = 125
 _CMD_SHARE = 130
 _CMD_USER = 131
 _CMD_PASSW = 132
@@ -513,6 +552,12 @@ BAD_PWM_FREQ = -102
 BAD_PWM_DUTY = -103
 GPIO_NOT_AN_OUTPUT = -104
 INVALID_GROUP_ALERT = -105
+BAD_NOTIFY_SLOTS = -106
+BAD_NOTIFY_FILTER = -107
+BAD_CAPTURE = -108
+BAD_ALERTS_QUEUE = -109
+BAD_BATCH = -110
+BAD_STREAM = -111
 
 # rgpiod error text
 
@@ -623,6 +668,12 @@ _errors=[
    [BAD_PWM_DUTY,  "bad PWM dutycycle"],
    [GPIO_NOT_AN_OUTPUT,  "GPIO not set as an output"],
    [INVALID_GROUP_ALERT,  "can not set a group to alert"],
+   [BAD_NOTIFY_SLOTS,  "bad notification ring slots"],
+   [BAD_NOTIFY_FILTER,  "bad notification filter"],
+   [BAD_CAPTURE,  "bad capture file or size"],
+   [BAD_ALERTS_QUEUE,  "bad alerts queue size"],
+   [BAD_BATCH,  "bad batch command or batch too large"],
+   [BAD_STREAM,  "bad stream steps, period, or notification"],
 ]
 
 _except_a = "############################################################\n{}"
@@ -654,6 +705,15 @@ class _socklock:
    def __init__(self):
       self.s = None
       self.l = threading.Lock()
+      self.rids = False     # rgpiod echoes request ids
+      self.probed = False   # _CMD_RIDS has been tried
+      self.next_id = 0
+      self.first_id = 0     # id of the first pipelined command
+      self.done = 0         # replies received while pipelining
+      self.pipeline = None  # statuses while pipelining
+      self.batch = None     # commands while batching
+      self.reply_size = 0   # extension size of the last reply
+      self.frame = _CMD_MAX_EXTENSION # largest command or reply
 
 class error(Exception):
    """
@@ -746,50 +806,148 @@ def _u2i_list(lst):
          raise error(error_text(lst[0]))
    return lst
 
+def _lg_connect(host, port):
+   """
+   Connects over TCP, or to a Unix domain socket if host
+   is "unix:path".
+   """
+   if host.startswith(_UNIX_ADDR_PREFIX):
+      s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+      try:
+         s.connect(host[len(_UNIX_ADDR_PREFIX):])
+      except socket.error:
+         s.close()
+         raise
+   else:
+      s = socket.create_connection((host, port), None)
+   return s
+
+def _lg_recv(sl, count):
+   """
+   Receives exactly count bytes.
+   """
+   data = bytearray(count)
+   view = memoryview(data)
+   got = 0
+   while got < count:
+      n = sl.s.recv_into(view[got:])
+      if not n:
+         raise error(error_text(SOCK_READ_FAILED))
+      got += n
+   return data
+
+def _lg_sendall(sl, msg):
+   """
+   Sends a list of buffers without joining them.
+   """
+   bufs = [memoryview(b) for b in msg if len(b)]
+   while bufs:
+      sent = sl.s.sendmsg(bufs)
+      while bufs and sent >= len(bufs[0]):
+         sent -= len(bufs[0])
+         bufs.pop(0)
+      if bufs:
+         bufs[0] = bufs[0][sent:]
+
+def _lg_reply(sl):
+   """
+   Receives a reply and records its status if pipelining.
+   """
+   status, sl.reply_size, dummy = struct.unpack(
+      'II8s', _lg_recv(sl, _SOCK_CMD_LEN))
+   if sl.rids:
+      id = struct.unpack('I', _lg_recv(sl, _SOCK_ID_LEN))[0]
+   else:
+      id = sl.first_id + sl.done # older daemons reply in order
+   if sl.pipeline is not None:
+      index = (id - sl.first_id) & 0xffffffff
+      if index < len(sl.pipeline):
+         sl.pipeline[index] = u2i(status)
+      sl.done += 1
+   return status
+
+def _lg_drain(sl, outstanding):
+   """
+   Waits until at most outstanding commands await replies.
+   """
+   while (len(sl.pipeline) - sl.done) > outstanding:
+      _lg_reply(sl)
+
+def _lg_send(sl, msg, wait):
+   """
+   Sends a command.  Returns its status, or OKAY if pipelined.
+
+   A command whose caller reads a reply extension (wait) waits
+   for the earlier replies and then runs as usual.
+   """
+   if sl.batch is not None:
+      # queued, executed when the batch is sent
+      size = sum(len(b) for b in msg)
+      size += -size % _BATCH_ALIGN
+      if (_BATCH_HDR_LEN + len(sl.batch) + size >=
+         sl.frame - _SOCK_CMD_LEN):
+         return BAD_BATCH
+      start = len(sl.batch)
+      for b in msg:
+         sl.batch.extend(b)
+      sl.batch.extend(bytearray(start + size - len(sl.batch)))
+      return OKAY
+   if sl.rids:
+      msg.insert(1, struct.pack('I', sl.next_id))
+   if sl.pipeline is not None:
+      _lg_drain(sl, 0 if wait else _PIPELINE_WINDOW-1)
+      sl.pipeline.append(CMD_INTERRUPTED) # until the reply
+   _lg_sendall(sl, msg)
+   sl.next_id = (sl.next_id + 1) & 0xffffffff
+   if sl.pipeline is not None and not wait:
+      return OKAY
+   return _lg_reply(sl)
+
+def _lg_msg(cmd, p3, extents, Q, L, H):
+   """
+   Returns a command as a list of buffers, the header first.
+   The extents are not copied.
+   """
+   msg = [struct.pack('IIHHHH', MAGIC, p3, cmd, Q, L, H)]
+   for x in extents:
+      if type(x) == type(""):
+         msg.append(_b(x))
+      elif isinstance(x, (bytes, bytearray)):
+         msg.append(x)
+      else:
+         msg.append(bytes(x))
+   return msg
+
 def _lg_command(sl, cmd, Q=0, L=0, H=0):
    """
    """
    status = CMD_INTERRUPTED
    with sl.l:
-      sl.s.send(struct.pack('IIHHHH', MAGIC, 0, cmd, Q, L, H))
-      status, dummy = struct.unpack('I12s', sl.s.recv(_SOCK_CMD_LEN))
+      status = _lg_send(sl, _lg_msg(cmd, 0, [], Q, L, H), False)
    return status
 
 def _lg_command_nolock(sl, cmd, Q=0, L=0, H=0):
    """
    """
    status = CMD_INTERRUPTED
-   sl.s.send(struct.pack('IIHHHH', MAGIC, 0, cmd, Q, L, H))
-   status, dummy = struct.unpack('I12s', sl.s.recv(_SOCK_CMD_LEN))
+   status = _lg_send(sl, _lg_msg(cmd, 0, [], Q, L, H), True)
    return status
 
 def _lg_command_ext(sl, cmd, p3, extents, Q=0, L=0, H=0):
    """
    """
-   ext = bytearray(struct.pack('IIHHHH', MAGIC, p3, cmd, Q, L, H))
-   for x in extents:
-      if type(x) == type(""):
-         ext.extend(_b(x))
-      else:
-         ext.extend(x)
+   msg = _lg_msg(cmd, p3, extents, Q, L, H)
    status = CMD_INTERRUPTED
    with sl.l:
-      sl.s.sendall(ext)
-      status, dummy = struct.unpack('I12s', sl.s.recv(_SOCK_CMD_LEN))
+      status = _lg_send(sl, msg, False)
    return status
 
 def _lg_command_ext_nolock(sl, cmd, p3, extents, Q=0, L=0, H=0):
    """
    """
    status = CMD_INTERRUPTED
-   ext = bytearray(struct.pack('IIHHHH', MAGIC, p3, cmd, Q, L, H))
-   for x in extents:
-      if type(x) == type(""):
-         ext.extend(_b(x))
-      else:
-         ext.extend(x)
-   sl.s.sendall(ext)
-   status, dummy = struct.unpack('I12s', sl.s.recv(_SOCK_CMD_LEN))
+   msg = _lg_msg(cmd, p3, extents, Q, L, H)
+   status = _lg_send(sl, msg, True)
    return status
 
 class _callback_ADT:
@@ -828,9 +986,14 @@ class _callback_thread(threading.Thread):
       self.daemon = True
       self.monitor = 0
       self.callbacks = []
-      self.sl.s = socket.create_connection((host, port), None)
+      self.sl.s = _lg_connect(host, port)
       self.lastLevel = 0
-      self.handle = _u2i(_lg_command(self.sl, _CMD_NOIB))
+      # prefer the compact format, older daemons only have NOIB
+      h = u2i(_lg_command(self.sl, _CMD_NOIBC))
+      self.compact = h >= 0
+      if h == UNKNOWN_COMMAND:
+         h = _lg_command(self.sl, _CMD_NOIB)
+      self.handle = _u2i(h)
       self.go = True
       self.start()
 
@@ -843,11 +1006,28 @@ class _callback_thread(threading.Thread):
          ext = [struct.pack("I", self.handle)]
          _lg_command_ext(self.control, _CMD_NC, 4, ext, L=1)
 
+   def _filter(self):
+      """
+      Asks the daemon to only send reports for GPIO with callbacks.
+      """
+      chips = set(cb.chip for cb in self.callbacks)
+      if len(chips) == 1:
+         chip = chips.pop()
+      else:
+         chip = -1
+      mask = 0
+      for cb in self.callbacks:
+         mask |= 1 << cb.gpio
+      ext = [struct.pack("QIiII",
+         mask & 0xffffffffffffffff, self.handle, chip, BOTH_EDGES, 0)]
+      _lg_command_ext(self.control, _CMD_NF, 24, ext, Q=1, L=4)
+
    def append(self, callb):
       """
       Adds a callback to the notification thread.
       """
       self.callbacks.append(callb)
+      self._filter()
 
    def remove(self, callb):
       """
@@ -855,6 +1035,55 @@ class _callback_thread(threading.Thread):
       """
       if callb in self.callbacks:
          self.callbacks.remove(callb)
+         self._filter()
+
+   def _dispatch(self, chip, gpio, level, flags, tick):
+      """
+      Passes a report to the callbacks.
+      """
+      if flags == 0:
+         for cb in self.callbacks:
+            if cb.gpio == gpio:
+               cb.func(chip, gpio, level, tick)
+      else: # e.g. REPORT_LINE_INFO, not for edge callbacks.
+         pass
+
+   def _varint(self, buf, pos):
+      """
+      Returns a varint and the position after it, or None and
+      the position if the varint is incomplete.
+      """
+      val = 0
+      shift = 0
+      while pos < len(buf):
+         b = buf[pos]
+         pos += 1
+         val |= (b & 0x7f) << shift
+         if not (b & 0x80):
+            return val, pos
+         shift += 7
+      return None, pos
+
+   def _frame(self, buf, pos, end):
+      """
+      Decodes and dispatches the reports in a compact frame.
+      """
+      tick, pos = self._varint(buf, pos)
+      while self.go and pos < end:
+         chip, gpio, flags = buf[pos], buf[pos+1], buf[pos+2]
+         count, pos = self._varint(buf, pos+3)
+         levels = []
+         while len(levels) < count:
+            lvl = buf[pos]
+            run, pos = self._varint(buf, pos+1)
+            for i in range(run):
+               levels.append(lvl & ~_COMPACT_ALTERNATE)
+               if lvl & _COMPACT_ALTERNATE:
+                  lvl ^= 1
+         for level in levels:
+            zz, pos = self._varint(buf, pos)
+            tick += (zz >> 1) ^ -(zz & 1)
+            self._dispatch(chip, gpio, level, flags, tick)
 
    def run(self):
       """
@@ -871,18 +1100,21 @@ class _callback_thread(threading.Thread):
          buf += self.sl.s.recv(RECV_SIZ)
          offset = 0
 
-         while self.go and (len(buf) - offset) >= MSG_SIZ:
+         if self.compact:
+            while self.go:
+               size, pos = self._varint(buf, offset)
+               if size is None or (pos + size) > len(buf):
+                  break
+               self._frame(buf, pos, pos + size)
+               offset = pos + size
+
+         while self.go and not self.compact and (
+            len(buf) - offset) >= MSG_SIZ:
             msgbuf = buf[offset:offset + MSG_SIZ]
             offset += MSG_SIZ
             tick, chip, gpio, level, flags, pad = (
                struct.unpack('QBBBBI', msgbuf))
-
-            if flags == 0:
-               for cb in self.callbacks:
-                  if cb.gpio == gpio:
-                     cb.func(chip, gpio, level, tick)
-            else: # no flags currently defined, ignore.
-               pass
+            self._dispatch(chip, gpio, level, flags, tick)
 
          buf = buf[offset:]
 
@@ -975,10 +1207,7 @@ class sbc():
       """
       Returns count bytes from the command socket.
       """
-      ext = bytearray(self.sl.s.recv(count))
-      while len(ext) < count:
-         ext.extend(self.sl.s.recv(count - len(ext)))
-      return ext
+      return _lg_recv(self.sl, count)
 
    def __repr__(self):
       """
@@ -997,7 +1226,9 @@ class sbc():
 
       host:= the host name of the SBC on which the rgpiod daemon is
              running.  The default is localhost unless overridden by
-             the LG_ADDR environment variable.
+             the LG_ADDR environment variable.  "unix:path" connects
+             to a local daemon started with -u path, which avoids
+             the TCP stack.
       port:= the port number on which the rgpiod daemon is listening.
              The default is 8889 unless overridden by the LG_PORT
              environment variable.  The rgpiod daemon must have been
@@ -1018,6 +1249,7 @@ class sbc():
       sbc = rgpio.sbc()             # use defaults
       sbc = rgpio.sbc('mypi')       # specify host, default port
       sbc = rgpio.sbc('mypi', 7777) # specify host and port
+      sbc = rgpio.sbc('unix:/run/rgpiod.sock') # local Unix socket
 
       sbc = rgpio.sbc()             # exit script if no connection
       if not sbc.connected:
@@ -1038,10 +1270,11 @@ class sbc():
       self._port = port
 
       try:
-         self.sl.s = socket.create_connection((host, port), None)
+         self.sl.s = _lg_connect(host, port)
 
-         # Disable the Nagle algorithm.
-         self.sl.s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+         if self.sl.s.family != socket.AF_UNIX:
+            # Disable the Nagle algorithm.
+            self.sl.s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
 
          self._notify = _callback_thread(self.sl, host, port)
 
@@ -2007,6 +2240,31 @@ class sbc():
       ext = [struct.pack("III", handle&0xffff, gpio, watchdog_micros)]
       return _u2i(_lg_command_ext(self.sl, _CMD_GWDOG, 12, ext, L=3))
 
+   def gpio_set_line_info_alerts(self, handle, gpio, enable, notify_handle):
+      """
+      This starts or stops alerts when a GPIO is claimed, released,
+      or reconfigured by any user.
+
+             handle:= >= 0 (as returned by [*gpiochip_open*]).
+               gpio:= >= 0, as legal for the gpiochip.
+             enable:= True to start alerts, False to stop them.
+      notify_handle:= >= 0 (as returned by [*notify_open*]).
+
+      If OK returns 0.
+
+      On failure returns a negative error code.
+
+      The GPIO does not need to be claimed.
+
+      Each change is sent to the notification handle as a report
+      with flags set to REPORT_LINE_INFO and level set to
+      LINE_REQUESTED, LINE_RELEASED, or LINE_RECONFIGURED.
+      These reports are not passed to callbacks.
+      """
+      ext = [struct.pack("IIII",
+         handle&0xffff, gpio, int(bool(enable)), notify_handle)]
+      return _u2i(_lg_command_ext(self.sl, _CMD_GILA, 16, ext, L=4))
+
 
    def gpio_claim_alert(
       self, handle, gpio, eFlags, lFlags=0, notify_handle=None):
@@ -2805,6 +3063,41 @@ class sbc():
       ext = [struct.pack("I", handle)]
       return _u2i(_lg_command_ext(self.sl, _CMD_NC, 4, ext, L=1))
 
+   def notify_filter(
+      self, handle, chip, gpio_mask, edge_mask=BOTH_EDGES, decimation=0):
+      """
+      Selects the reports sent to a notification.
+
+          handle:= >= 0 (as returned by [*notify_open*])
+            chip:= the gpiochip device number, or -1 for any gpiochip.
+       gpio_mask:= bit n set to send reports for GPIO n.
+       edge_mask:= RISING_EDGE, FALLING_EDGE, BOTH_EDGES, or 0.
+      decimation:= 0 or 1 to send every edge, n to send every nth
+                   edge of each GPIO.
+
+      If OK returns 0.
+
+      On failure returns a negative error code.
+
+      Reports which are not selected are discarded by the daemon.
+
+      Reports for GPIO above 63 are not affected by gpio_mask.
+      Watchdog reports (level 2) and reports with non-zero flags
+      are not affected by edge_mask or decimation.
+
+      The notification used by [*callback*] is filtered
+      automatically so that it only receives reports for GPIO
+      with callbacks.
+
+      ...
+      # only rising edges of GPIO 5 and 6 on gpiochip 0
+      sbc.notify_filter(h, 0, (1<<5)|(1<<6), rgpio.RISING_EDGE)
+      ...
+      """
+      ext = [struct.pack("QIiII",
+         gpio_mask & 0xffffffffffffffff, handle, chip, edge_mask, decimation)]
+      return _u2i(_lg_command_ext(self.sl, _CMD_NF, 24, ext, Q=1, L=4))
+
    # SCRIPTS
 
    def script_store(self, script):
@@ -3480,6 +3773,154 @@ class sbc():
       ext = [struct.pack("I", share_id)]
       return _u2i(_lg_command_ext(self.sl, _CMD_SHRU, 4, ext, L=1))
 
+   def pipeline_start(self):
+      """
+      Starts pipelining commands to the rgpiod daemon.
+
+      If OK returns 0.
+
+      On failure returns a negative error code.
+
+      Until [*pipeline_stop*] is called commands which only return
+      a status (e.g. [*gpio_write*]) are sent without waiting for
+      the reply and return 0 immediately.  Their statuses are
+      collected as the replies arrive.  Up to 1024 commands may
+      await replies.  If pipelining has already started this
+      does nothing.
+
+      This hides the network round trip when the daemon is on
+      another machine.  Commands which return data (e.g.
+      [*i2c_read_device*]) wait for all earlier replies and then
+      behave as usual.
+
+      ...
+      sbc.pipeline_start()
+      for i in range(1000):
+         sbc.gpio_write(h, 4, i & 1)
+      status = sbc.pipeline_stop()
+      ...
+      """
+      if self.sl.pipeline is not None:
+         return OKAY
+
+      if not self.sl.probed:
+         # older daemons reply in order but don't echo request ids
+         status = u2i(_lg_command(self.sl, _CMD_RIDS))
+         if status < 0 and status != UNKNOWN_COMMAND:
+            return _u2i(status)
+         self.sl.rids = (status == OKAY)
+         self.sl.probed = True
+
+      with self.sl.l:
+         self.sl.first_id = self.sl.next_id
+         self.sl.done = 0
+         self.sl.pipeline = []
+
+      return OKAY
+
+   def pipeline_stop(self):
+      """
+      Waits for the replies to the commands sent since
+      [*pipeline_start*] and stops pipelining.
+
+      Returns a list of the command statuses in the order the
+      commands were sent, or None if pipelining wasn't started.
+
+      ...
+      status = sbc.pipeline_stop()
+      ...
+      """
+      with self.sl.l:
+         statuses = self.sl.pipeline
+         if statuses is not None:
+            try:
+               _lg_drain(self.sl, 0)
+            finally:
+               self.sl.pipeline = None
+      return statuses
+
+   def batch_start(self):
+      """
+      Starts collecting commands into a batch.
+
+      If OK returns 0.
+
+      Until [*batch_stop*] is called commands are not sent to the
+      rgpiod daemon.  Each returns 0 and is added to the batch.
+      [*batch_stop*] sends the batch as a single command, which
+      costs one network round trip however many commands it holds.
+
+      Commands which return data (e.g. [*spi_xfer*]) return no
+      data while batching.  [*batch_stop*] returns the data each
+      command would have returned.  If batching has already
+      started this does nothing.
+
+      The daemon checks the permissions of each batched command
+      as if it had been sent separately.
+
+      ...
+      sbc.batch_start()
+      for ch in range(8):
+         sbc.spi_xfer(adc, [1, (8+ch)<<4, 0])
+      for led in LEDS:
+         sbc.gpio_write(h, led, 1)
+      res = sbc.batch_stop()
+      ...
+      """
+      with self.sl.l:
+         if self.sl.batch is None:
+            self.sl.batch = bytearray()
+      return OKAY
+
+   def batch_stop(self, stop_on_error=False):
+      """
+      Sends the commands collected since [*batch_start*] to the
+      rgpiod daemon, which executes them in order.
+
+      stop_on_error:= if True the daemon stops after the first
+                      command which fails.
+
+      If OK returns a list with an entry for each command executed.
+      Each entry is a list of the command's status and the data it
+      returned (a bytearray, empty if the command returns no data).
+
+      On failure returns a negative error code.
+
+      Returns None if batching wasn't started.
+
+      The daemon also stops if the replies so far leave too little
+      room for the next command's reply.  In either case fewer
+      commands are executed than were batched.
+
+      A command which would make the batch too large to send returns
+      BAD_BATCH when added.
+
+      ...
+      for status, data in sbc.batch_stop():
+         print(status, data)
+      ...
+      """
+      with self.sl.l:
+         cmds = self.sl.batch
+         if cmds is None:
+            return None
+         self.sl.batch = None
+         flags = 1 if stop_on_error else 0
+         ext = [struct.pack('II', flags, 0), cmds]
+         count = u2i(_lg_send(self.sl, _lg_msg(
+            _CMD_BATCH, _BATCH_HDR_LEN + len(cmds), ext, 0, 0, 0), True))
+         if count < 0:
+            return _u2i(count)
+         data = _lg_recv(self.sl, self.sl.reply_size)
+      res = []
+      pos = 0
+      for i in range(count):
+         status, size = struct.unpack_from('iI', data, pos)
+         start = pos + _SOCK_CMD_LEN
+         res.append([status, data[start:start+size]])
+         pos += (_SOCK_CMD_LEN + size + _BATCH_ALIGN - 1) & ~(_BATCH_ALIGN - 1)
+      return res
+
    def get_internal(self, config_id):
       """
       Returns the value of a configuration item.
@@ -3533,6 +3974,83 @@ class sbc():
       ext = [struct.pack("QI", config_value, config_id)]
       return _u2i(_lg_command_ext(self.sl, _CMD_CSI, 12, ext, Q=1, L=1))
 
+   def get_cmd_stats(self, reset=False):
+      """
+      Returns the number of times each command has been executed
+      by the rgpiod daemon, how many of those failed, and how long
+      they took.
+
+      This is a privileged command. See [+Permits+].
+
+      reset:= if True the statistics are zeroed once read.
+
+      If OK returns a list of 0 (OK) and a list with an entry for
+      each command executed.  Each entry is a list of the command
+      number, the number of calls, the number of errors, the total
+      and the longest execution time in nanoseconds, and a list
+      of execution time histogram buckets.
+
+      On failure returns a list of negative error code and None.
+
+      Bucket 0 counts executions taking under 1 microsecond, bucket
+      n those taking from 2**(n-1) to 2**n microseconds.  The last
+      bucket also counts anything slower.
+
+      The statistics cover every client of the daemon.
+
+      ...
+      status, stats = sbc.get_cmd_stats()
+      for cmd, calls, errors, total, longest, buckets in stats:
+         print(cmd, calls, errors, total/calls, longest)
+      ...
+      """
+      ext = [struct.pack("I", 1 if reset else 0)]
+      status = CMD_INTERRUPTED
+      stats = None
+      with self.sl.l:
+         bytes = u2i(
+            _lg_command_ext_nolock(self.sl, _CMD_STATS, 4, ext, L=1))
+         if bytes >= 0:
+            data = self._rxbuf(bytes)
+            stats = []
+            for rec in struct.iter_unpack(_STATS_FMT, data):
+               stats.append(list(rec[:1]) + list(rec[2:6]) + [list(rec[6:])])
+            status = OKAY
+         else:
+            status = bytes
+      return _u2i_list([status, stats])
+
+   def set_frame_size(self, frame_size):
+      """
+      Asks the rgpiod daemon to accept larger commands and send
+      larger replies on this connection.  By default a command or
+      reply, its 16 byte header included, must be smaller than
+      65536 bytes.
+
+      frame_size:= the largest frame wanted, 65536 to 2097152.
+
+      If OK returns the frame size now in force.  A size outside
+      the range is clamped to it.
+
+      On failure returns a negative error code.  Daemons which
+      predate this command return UNKNOWN_COMMAND.
+
+      A larger frame lets a single [*file_read*], [*file_write*]
+      or batch move more data per round trip.
+
+      ...
+      if sbc.set_frame_size(1<<21) > 1<<20:
+         count, data = sbc.file_read(h, 1<<20)
+      ...
+      """
+      ext = [struct.pack("I", frame_size)]
+      with self.sl.l:
+         status = u2i(
+            _lg_command_ext_nolock(self.sl, _CMD_FRAME, 4, ext, L=1))
+         if status > 0:
+            self.sl.frame = status
+      return _u2i(status)
+
 
 def xref():
    """
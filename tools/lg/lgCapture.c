@@ -0,0 +1,293 @@
+/*
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+*/
+
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lgpio.h"
+
+#include "lgDbg.h"
+#include "lgGpio.h"
+
+#define LG_REPLAY_BATCH 64
+
+static size_t xCaptureSize(lgCaptureHeader_p cap)
+{
+   return cap->reportOffset + (cap->capacity * sizeof(lgGpioReport_t));
+}
+
+
+static uint64_t xNow(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return ((uint64_t)1E9 * ts.tv_sec) + ts.tv_nsec;
+}
+
+
+static void xSleepUntil(uint64_t when)
+{
+   struct timespec ts;
+
+   ts.tv_sec = when / 1000000000;
+   ts.tv_nsec = when % 1000000000;
+
+   while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+/* ----------------------------------------------------------------------- */
+
+lgCaptureHeader_p lgCaptureCreate(const char *path, int maxReports, int *fd)
+{
+   lgCaptureHeader_t hdr;
+   lgCaptureHeader_p cap;
+   int err;
+
+   memset(&hdr, 0, sizeof(hdr));
+
+   hdr.magic = LG_CAPTURE_MAGIC;
+   hdr.version = LG_CAPTURE_VERSION;
+   hdr.capacity = maxReports;
+   hdr.indexInterval = LG_CAPTURE_INDEX_INTERVAL;
+   hdr.indexOffset = sizeof(lgCaptureHeader_t);
+   hdr.reportOffset = hdr.indexOffset +
+      (((maxReports / LG_CAPTURE_INDEX_INTERVAL) + 1) * sizeof(uint64_t));
+
+   /* start the reports on a cache line */
+   hdr.reportOffset = (hdr.reportOffset + 63) & ~63;
+
+   *fd = open(path, O_RDWR|O_CREAT|O_TRUNC|O_CLOEXEC, 0664);
+
+   if (*fd < 0)
+   {
+      LG_DBG(LG_DEBUG_USER, "open %s failed (%m)", path);
+      return NULL;
+   }
+
+   /* allocate the whole file now so recording can't fail later */
+
+   err = posix_fallocate(*fd, 0, xCaptureSize(&hdr));
+
+   if (err)
+   {
+      LG_DBG(LG_DEBUG_USER, "allocate %s failed (%s)", path, strerror(err));
+      close(*fd);
+      return NULL;
+   }
+
+   cap = mmap(NULL, xCaptureSize(&hdr),
+      PROT_READ|PROT_WRITE, MAP_SHARED, *fd, 0);
+
+   if (cap == MAP_FAILED)
+   {
+      LG_DBG(LG_DEBUG_USER, "mmap %s failed (%m)", path);
+      close(*fd);
+      return NULL;
+   }
+
+   *cap = hdr;
+
+   return cap;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgCaptureWrite(lgCaptureHeader_p cap, lgGpioReport_t *reports, int count)
+{
+   /* Only called by the alert thread.  Returns the reports recorded. */
+
+   lgGpioReport_t *report;
+   uint64_t *index;
+   uint64_t n, pos;
+   int i;
+
+   pos = cap->count;
+
+   if (count > (cap->capacity - pos))
+   {
+      cap->dropped += count - (cap->capacity - pos);
+      count = cap->capacity - pos;
+   }
+
+   report = (lgGpioReport_t *)((uint8_t *)cap + cap->reportOffset);
+   index = (uint64_t *)((uint8_t *)cap + cap->indexOffset);
+
+   memcpy(report + pos, reports, count * sizeof(lgGpioReport_t));
+
+   for (i=0; i<count; i++)
+   {
+      n = pos + i;
+
+      if ((n % cap->indexInterval) == 0)
+      {
+         index[n / cap->indexInterval] = reports[i].timestamp;
+         cap->indexEntries = (n / cap->indexInterval) + 1;
+      }
+   }
+
+   /* publish the reports to anyone reading the file as it is recorded */
+
+   __atomic_store_n(&cap->count, pos + count, __ATOMIC_RELEASE);
+
+   return count;
+}
+
+/* ----------------------------------------------------------------------- */
+
+void lgCaptureClose(lgCaptureHeader_p cap)
+{
+   msync(cap, xCaptureSize(cap), MS_ASYNC);
+
+   munmap(cap, xCaptureSize(cap));
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgCaptureReplay(const char *path, uint64_t start, double speed)
+{
+   lgCaptureHeader_p cap;
+   lgGpioReport_t *report;
+   uint64_t *index;
+   lgGpioAlert_t alert[LG_REPLAY_BATCH];
+   struct stat st;
+   uint64_t count, i, from, lo, hi, mid;
+   uint64_t base, first, now;
+   int fd, n;
+
+   LG_DBG(LG_DEBUG_TRACE, "path=%s start=%"PRIu64" speed=%.2f",
+      path, start, speed);
+
+   if (speed < 0) PARAM_ERROR(LG_BAD_CAPTURE, "bad speed (%.2f)", speed);
+
+   fd = open(path, O_RDONLY|O_CLOEXEC);
+
+   if (fd < 0) PARAM_ERROR(LG_FILE_OPEN_FAILED, "open %s failed (%m)", path);
+
+   if ((fstat(fd, &st) < 0) || (st.st_size < sizeof(lgCaptureHeader_t)))
+   {
+      close(fd);
+      PARAM_ERROR(LG_BAD_CAPTURE, "%s is not a capture", path);
+   }
+
+   cap = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+   close(fd);
+
+   if (cap == MAP_FAILED) PARAM_ERROR(LG_BAD_CAPTURE, "mmap %s failed (%m)", path);
+
+   if ((cap->magic != LG_CAPTURE_MAGIC) ||
+       (cap->version != LG_CAPTURE_VERSION) ||
+       (cap->indexInterval == 0) ||
+       (cap->capacity > LG_MAX_CAPTURE_REPORTS) ||
+       (cap->count > cap->capacity) ||
+       (cap->indexOffset < sizeof(lgCaptureHeader_t)) ||
+       (cap->reportOffset < (cap->indexOffset +
+          (cap->indexEntries * sizeof(uint64_t)))) ||
+       (xCaptureSize(cap) > st.st_size))
+   {
+      munmap(cap, st.st_size);
+      PARAM_ERROR(LG_BAD_CAPTURE, "%s is not a capture", path);
+   }
+
+   report = (lgGpioReport_t *)((uint8_t *)cap + cap->reportOffset);
+   index = (uint64_t *)((uint8_t *)cap + cap->indexOffset);
+
+   count = __atomic_load_n(&cap->count, __ATOMIC_ACQUIRE);
+
+   i = 0;
+
+   if (start && cap->indexEntries)
+   {
+      /* find the last index entry at or before start, then scan */
+
+      lo = 0;
+      hi = cap->indexEntries;
+
+      while ((hi - lo) > 1)
+      {
+         mid = (lo + hi) / 2;
+
+         if (index[mid] <= start) lo = mid;
+         else hi = mid;
+      }
+
+      i = lo * cap->indexInterval;
+
+      while ((i < count) && (report[i].timestamp < start)) i++;
+   }
+
+   base = xNow();
+
+   if (i < count) first = report[i].timestamp;
+   else first = 0;
+
+   from = i;
+
+   now = base;
+
+   while (i < count)
+   {
+      if (speed > 0)
+      {
+         now = base + (uint64_t)((double)(report[i].timestamp - first) / speed);
+
+         if ((report[i].timestamp > first) && (now > xNow())) xSleepUntil(now);
+
+         now = xNow();
+      }
+
+      for (n=0; (n<LG_REPLAY_BATCH) && (i<count); n++, i++)
+      {
+         /* stop at the first report which is not due yet */
+
+         if ((speed > 0) && n && (report[i].timestamp > first) &&
+             ((base + (uint64_t)((double)(report[i].timestamp - first) / speed))
+                > now)) break;
+
+         alert[n].report = report[i];
+         alert[n].nfyHandle = -1;
+      }
+
+      if (lgGpioSamplesFunc)
+         (lgGpioSamplesFunc)(n, alert, lgGpioSamplesUserdata);
+   }
+
+   munmap(cap, st.st_size);
+
+   return i - from;
+}
@@ -58,6 +58,7 @@ cmdInfo_t cmdInfo[]=
    {LG_CMD_GIC,   "GIC",   101, 10, 0}, // lgGpioGetChipInfo
    {LG_CMD_GIL,   "GIL",   101, 11, 0}, // lgGpioGetLineInfo
    {LG_CMD_GMODE, "GMODE", 101,  2, 1}, // lgGpioGetMode
+   {LG_CMD_GILA,  "GILA",  101,  0, 1}, // lgGpioSetLineInfoAlerts
 
    {LG_CMD_GSI,   "GSI",   101, 0, 1}, // lgGpioClaimInput (simple)
    {LG_CMD_GSIX,  "GSIX",  101, 0, 1}, // lgGpioClaimInput
@@ -129,6 +130,7 @@ cmdInfo_t cmdInfo[]=
    {LG_CMD_NC,    "NC",    101, 0, 1}, // lgNotifyClose
    {LG_CMD_NP,    "NP",    101, 0, 1}, // lgNotifyPause
    {LG_CMD_NR,    "NR",    101, 0, 1}, // lgNotifyResume
+   {LG_CMD_NF,    "NF",    101, 0, 1}, // lgNotifyFilter
 
    /* SCRIPTS */
 
@@ -193,6 +195,8 @@ cmdInfo_t cmdInfo[]=
    {LG_CMD_PCD,   "PCD",   100, 6, 0}, // lguGetConfigDir
    {LG_CMD_PWD,   "PWD",   100, 6, 0}, // lguGetWorkDir
 
+   {LG_CMD_STATS, "STATS", 101, 12, 0}, // xStatsRead
+
    {LG_CMD_SHRS,  "SHRS",  101, 0, 1}, // lgHdlSetShare
    {LG_CMD_SHRU,  "SHRU",  101, 0, 1}, // xShareUse
 
@@ -327,6 +331,22 @@ char *cmdStr(void)
    return intCmdStr;
 }
 
+char *cmdName(int cmd)
+{
+   /* where a command has several names prefer the longest */
+
+   char *name = NULL;
+   int i;
+
+   for (i=0; i<(sizeof(cmdInfo)/sizeof(cmdInfo_t)); i++)
+   {
+      if ((cmdInfo[i].cmd == cmd) &&
+          ((name == NULL) || (strlen(cmdInfo[i].name) > strlen(name))))
+         name = cmdInfo[i].name;
+   }
+   return name;
+}
+
 int cmdScanf(char *text, cmdCtl_p ctlP, lgCmd_p cmdP, char *fmt, int *matched)
 {
    uint32_t *argI=(uint32_t*)&cmdP[1];
@@ -616,6 +636,7 @@ int cmdParse(char *text, cmdCtl_p ctlP, lgCmd_p cmdP, int cmdBufSize)
                valid = cmdScanf(text, ctlP, cmdP, "IIFF", &matches);
                break;
                               
+            case LG_CMD_GILA: // h g enable nfyh
             case LG_CMD_GP:   // h g m_on m_off
             case LG_CMD_GSOX: // h lf g v
             case LG_CMD_SPIO:
@@ -633,6 +654,11 @@ int cmdParse(char *text, cmdCtl_p ctlP, lgCmd_p cmdP, int cmdBufSize)
                valid = cmdScanf(text, ctlP, cmdP, "IIIII", &matches);
                break;
                               
+            case LG_CMD_NF: // h c gmaskQ e d -> gmaskQ h c e d
+               pars = 6; /* Q counts as 2 */
+               valid = cmdScanf(text, ctlP, cmdP, ">>II<<<<Q>>II", &matches);
+               break;
+                              
             case LG_CMD_GGWX: // h g bitsQ maskQ -> bitsQ maskQ h g
                pars = 6; /* Q counts as 2 */
                valid = cmdScanf(text, ctlP, cmdP, ">>>>II<<<<<<QQ", &matches);
@@ -656,6 +682,12 @@ int cmdParse(char *text, cmdCtl_p ctlP, lgCmd_p cmdP, int cmdBufSize)
                if (pars > 1) valid = 1;
                break;
 
+            case LG_CMD_STATS: // [flags]
+               valid = cmdScanf(text, ctlP, cmdP, "i", &matches);
+               pars = matches;
+               if (pars < 2) valid = 1;
+               break;
+
             case LG_CMD_GSGIX: // h lf g*
                valid = cmdScanf(text, ctlP, cmdP, "i", &matches);
                pars = matches;
@@ -35,6 +35,7 @@ For more information, please refer to <http://unlicense.org/>
 
 #define CMD_MAX_PARAM 512
 #define CMD_MAX_EXTENSION (1<<16)
+#define CMD_MAX_FRAME     (1<<21) /* largest frame LG_CMD_FRAME allows */
 
 #define CMD_UNKNOWN_CMD   -1
 #define CMD_BAD_PARAMETER -2
@@ -54,6 +55,52 @@ For more information, please refer to <http://unlicense.org/>
 
 #define LG_MAGIC 0x6c67646d /* ASCII lgdm */
 
+/*
+   Once LG_CMD_RIDS has succeeded every command and reply on the
+   connection carries a uint32_t request id, chosen by the client,
+   between the lgCmd_t and the extension.  The reply to a command
+   has the same id.
+*/
+#define LG_CMD_ID_BYTES 4
+
+/*
+   A command and its reply, the lgCmd_t included, must be smaller than
+   CMD_MAX_EXTENSION bytes.  LG_CMD_FRAME raises the limit for the rest
+   of the connection to the size asked for, at most CMD_MAX_FRAME.  The
+   reply status is the limit now in force.
+*/
+
+/*
+   The LG_CMD_BATCH extension is a uint32_t of LG_BATCH flags and a
+   uint32_t of padding followed by the sub-commands.  Each sub-command
+   is an lgCmd_t and its extension, padded to a multiple of
+   LG_BATCH_ALIGN bytes.
+
+   The reply status is the number of sub-commands executed.  The reply
+   extension holds one record per executed sub-command, an lgCmd_t
+   with its status and the size of its returned data followed by
+   that data, padded in the same way.
+*/
+#define LG_BATCH_HDR_BYTES 8
+#define LG_BATCH_ALIGN     8
+#define LG_BATCH_PAD(x) (((x) + LG_BATCH_ALIGN - 1) & ~(LG_BATCH_ALIGN - 1))
+
+/*
+   The LG_CMD_STRO extension is a uint32_t notification handle, a
+   uint32_t period in microseconds and a uint32_t count of records to
+   send (0 for no limit), followed by the steps laid out as an
+   LG_CMD_BATCH extension.  Only the commands which read or transfer
+   (see lgStream.c) may be steps.  The reply status is the stream
+   handle.
+
+   Each period the steps are executed as a batch and the replies are
+   written to the notification as a record, see lgStreamRecord_t.
+   Steps stop early if their replies would overflow the record.
+*/
+#define LG_STREAM_HDR_BYTES  12
+#define LG_STREAM_MIN_PERIOD 100 /* microseconds */
+#define LG_STREAM_MAX_STEPS  64
+
 typedef struct
 {
    union
@@ -123,5 +170,7 @@ int cmdParseScript(char *script, cmdScript_t *s, int diags);
 
 char *cmdStr(void);
 
+char *cmdName(int cmd);
+
 #endif
 
@@ -36,6 +36,8 @@ static pthread_key_t slgGlobalKey;
 
 static pthread_once_t xInited = PTHREAD_ONCE_INIT;
 
+static __thread lgCtx_p xCtx = NULL; /* avoids key lookup on hot paths */
+
 static void xInit(void)
 {
    LG_DBG(LG_DEBUG_ALLOC, "");
@@ -46,6 +48,8 @@ lgCtx_p lgCtxGet(void)
 {
    lgCtx_p ctx;
 
+   if (xCtx != NULL) return xCtx;
+
    pthread_once(&xInited, xInit);
 
    LG_DBG(LG_DEBUG_ALLOC, "thread=%llu", (long long int)pthread_self());
@@ -67,6 +71,27 @@ lgCtx_p lgCtxGet(void)
 
    LG_DBG(LG_DEBUG_ALLOC, "ctx=%p", ctx);
 
+   xCtx = ctx;
+
    return ctx;
 }
 
+void lgCtxSet(lgCtx_p ctx)
+{
+   /* lets one thread act for several clients, e.g. the socket workers */
+
+   pthread_once(&xInited, xInit);
+
+   pthread_setspecific(slgGlobalKey, ctx);
+
+   xCtx = ctx;
+}
+
+void lgCtxFree(lgCtx_p ctx)
+{
+   if (ctx == NULL) return;
+
+   free(ctx->permits.mem);
+   free(ctx);
+}
+
@@ -30,17 +30,60 @@ For more information, please refer to <http://unlicense.org/>
 
 #include <pthread.h>
 
+/*
+   A user's permits are compiled from the permits file when the user
+   is set, so that checking a permit doesn't parse any text.
+*/
+
+#define LG_PERMIT_SCRIPTS 1
+#define LG_PERMIT_NOTIFY  2
+#define LG_PERMIT_DEBUG   4
+#define LG_PERMIT_SHELL   8
+
+typedef struct lgPermitRange_s
+{
+   int lo;
+   int hi;
+} lgPermitRange_t, *lgPermitRange_p;
+
+typedef struct lgPermitDev_s
+{
+   lgPermitRange_t dev; /* devices, none if lo > hi */
+   int subCount;        /* sorted disjoint subdevice ranges */
+   lgPermitRange_p sub;
+} lgPermitDev_t, *lgPermitDev_p;
+
+typedef struct lgPermitDevs_s
+{
+   int count;
+   lgPermitDev_p entry;
+} lgPermitDevs_t;
+
+typedef struct lgPermitGlob_s
+{
+   char *pattern;
+   int perm;            /* files only, 'R', 'W', 'U' or 0 */
+   int order;           /* position in the permits entry */
+} lgPermitGlob_t, *lgPermitGlob_p;
+
+typedef struct lgPermitGlobs_s
+{
+   int literals;        /* sorted patterns without wildcards */
+   lgPermitGlob_p literal;
+   int wildcards;       /* patterns with wildcards, in permits order */
+   lgPermitGlob_p wildcard;
+} lgPermitGlobs_t;
+
 typedef struct lgPermit_s
 {
-   char *files;
-   char *scripts;
-   char *i2c;
-   char *spi;
-   char *serial;
-   char *gpio;
-   char *notify;
-   char *debug;
-   char *shell;
+   int gen;             /* permits file generation compiled */
+   int flags;           /* LG_PERMIT_* */
+   lgPermitGlobs_t files;
+   lgPermitGlobs_t serial;
+   lgPermitDevs_t i2c;
+   lgPermitDevs_t spi;
+   lgPermitDevs_t gpio;
+   void *mem;           /* holds everything the above point to */
 } lgPermit_t, *lgPermit_p;
 
 typedef struct lgCtx_s
@@ -52,10 +95,13 @@ typedef struct lgCtx_s
    int approved;
    int autoSetShare;
    int autoUseShare;
+   int autoShareTransient; /* created handles are freed with the owner */
    lgPermit_t permits;
 } lgCtx_t, *lgCtx_p;
 
 lgCtx_p lgCtxGet(void);
+void lgCtxSet(lgCtx_p ctx);
+void lgCtxFree(lgCtx_p ctx);
 
 #endif
 
@@ -141,6 +141,12 @@ static xErrInfo_t xErrInfo[]=
    {LG_BAD_PWM_DUTY,  "bad PWM dutycycle"},
    {LG_GPIO_NOT_AN_OUTPUT,  "GPIO not set as an output"},
    {LG_INVALID_GROUP_ALERT,  "can not set a group to alert"},
+   {LG_BAD_NOTIFY_SLOTS,  "bad notification ring slots"},
+   {LG_BAD_NOTIFY_FILTER,  "bad notification filter"},
+   {LG_BAD_CAPTURE,  "bad capture file or size"},
+   {LG_BAD_ALERTS_QUEUE,  "bad alerts queue size"},
+   {LG_BAD_BATCH,  "bad batch command or batch too large"},
+   {LG_BAD_STREAM,  "bad stream steps, period, or notification"},
 };
 
 const char *lguErrorText(int error)
@@ -53,10 +53,48 @@ typedef enum
    COMMA,
 } checkDevSubdev_t;
 
+/* smaller file reads are copied, not worth a descriptor */
+#define LG_SEND_FROM_FD_MIN 16384
+
+/*
+   Command statistics are kept in a shard per thread so that recording
+   them takes no lock.  A shard whose gen differs from xStatsGen holds
+   counts from before the last reset.  It is ignored when read and
+   cleared by its thread before the thread next records.
+*/
+
+#define LG_STATS_CMDS 256
+
+typedef struct
+{
+   uint64_t calls;
+   uint64_t errors;
+   uint64_t totalNanos;
+   uint64_t maxNanos;
+   uint64_t bucket[LG_STATS_BUCKETS];
+} lgStatsCmd_t;
+
+typedef struct lgStatsShard_s
+{
+   struct lgStatsShard_s *next;
+   int inUse;    /* owned by a live thread */
+   uint32_t gen; /* xStatsGen when last cleared */
+   lgStatsCmd_t cmd[LG_STATS_CMDS];
+} lgStatsShard_t, *lgStatsShard_p;
+
+/* Cfg is replaced by LCFG while other threads compile permits from it */
+static pthread_rwlock_t CfgLock = PTHREAD_RWLOCK_INITIALIZER;
 static lgCfg_p Cfg;
+static int CfgGen; /* incremented on each load, users' permits follow */
 
 static pthread_once_t xInited = PTHREAD_ONCE_INIT;
 
+static pthread_mutex_t xStatsMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t xStatsKey;
+static lgStatsShard_p xStatsShards;
+static uint32_t xStatsGen;
+static __thread lgStatsShard_p xShard = NULL;
+
 static uint64_t xMakeSalt(void)
 {
    struct timespec xts;
@@ -69,32 +107,300 @@ static uint64_t xMakeSalt(void)
 static int xLoadConfig(void)
 {
    char cfgFile[LG_MAX_PATH];
+   int status;
 
    snprintf(cfgFile, LG_MAX_PATH, "%s/permits", lguGetConfigDir());
 
+   pthread_rwlock_wrlock(&CfgLock);
+
    if (Cfg) lgCfgFree(Cfg);
 
    Cfg = lgCfgRead(cfgFile);
 
+   __atomic_add_fetch(&CfgGen, 1, __ATOMIC_RELEASE);
+
    if (Cfg) lgCfgPrint(Cfg, stderr);
 
-   if (Cfg) return LG_OKAY; else return LG_BAD_CONFIG_FILE;
+   if (Cfg) status = LG_OKAY; else status = LG_BAD_CONFIG_FILE;
+
+   pthread_rwlock_unlock(&CfgLock);
+
+   return status;
+}
+
+static void xStatsRelease(void *shard)
+{
+   /* the thread has exited, a new thread may take over its shard */
+
+   pthread_mutex_lock(&xStatsMutex);
+   ((lgStatsShard_p)shard)->inUse = 0;
+   pthread_mutex_unlock(&xStatsMutex);
 }
 
 static void xInit(void)
 {
+   pthread_key_create(&xStatsKey, xStatsRelease);
+
    xLoadConfig();
 }
 
-int xCheckDevSubdev(char *str, int dev, int subdev)
+static int xCheckYes(char *permit)
+{
+   if (permit && ((strcmp(permit, "Y") == 0) || (strcmp(permit, "y") == 0)))
+      return 1;
+
+   return 0;
+}
+
+static int xCheckDevs(lgPermitDevs_t *devs, int dev, int subdev)
+{
+   /* subdev < 0 checks the device alone */
+
+   lgPermitDev_p e;
+   int i, lo, hi, mid;
+
+   for (i=0; i<devs->count; i++)
+   {
+      e = &devs->entry[i];
+
+      if ((dev < e->dev.lo) || (dev > e->dev.hi)) continue;
+
+      if (subdev < 0) return 1;
+
+      lo = 0;
+      hi = e->subCount - 1;
+
+      while (lo <= hi)
+      {
+         mid = (lo + hi) / 2;
+
+         if (subdev < e->sub[mid].lo) hi = mid - 1;
+         else if (subdev > e->sub[mid].hi) lo = mid + 1;
+         else return 1;
+      }
+   }
+   return 0;
+}
+
+static lgPermitGlob_p xFindLiteral(lgPermitGlobs_t *globs, char *name)
+{
+   int lo, hi, mid, r;
+
+   lo = 0;
+   hi = globs->literals - 1;
+
+   while (lo <= hi)
+   {
+      mid = (lo + hi) / 2;
+
+      r = strcmp(name, globs->literal[mid].pattern);
+
+      if (r < 0) hi = mid - 1;
+      else if (r > 0) lo = mid + 1;
+      else return &globs->literal[mid];
+   }
+   return NULL;
+}
+
+static int xCheckDebugPermissions(lgCtx_p Ctx)
+   {return (Ctx->permits.flags & LG_PERMIT_DEBUG) != 0;}
+
+static int xCheckShellPermissions(lgCtx_p Ctx)
+   {return (Ctx->permits.flags & LG_PERMIT_SHELL) != 0;}
+
+static int xCheckNotifyPermissions(lgCtx_p Ctx)
+   {return (Ctx->permits.flags & LG_PERMIT_NOTIFY) != 0;}
+
+static int xCheckScriptPermissions(lgCtx_p Ctx)
+   {return (Ctx->permits.flags & LG_PERMIT_SCRIPTS) != 0;}
+
+static int xCheckSerialPermissions(lgCtx_p Ctx, char *serDev)
+{
+   lgPermitGlobs_t *globs = &Ctx->permits.serial;
+   int i;
+
+   if (xFindLiteral(globs, serDev)) return 1;
+
+   for (i=0; i<globs->wildcards; i++)
+   {
+      if (fnmatch(globs->wildcard[i].pattern, serDev, 0) == 0) return 1;
+   }
+   return 0;
+}
+
+static int xCheckI2cPermissions(lgCtx_p Ctx, int i2cDev, int i2cAddr)
+   {return xCheckDevs(&Ctx->permits.i2c, i2cDev, i2cAddr);}
+
+static int xCheckSpiPermissions(lgCtx_p Ctx, int spiDev, int spiChan)
+   {return xCheckDevs(&Ctx->permits.spi, spiDev, spiChan);}
+
+static int xCheckGpioPermissions(lgCtx_p Ctx, int gpioDev, int gpio)
+   {return xCheckDevs(&Ctx->permits.gpio, gpioDev, gpio);}
+
+static int xSetGpioPermissions(lgCtx_p Ctx, int gpioDev, int handle)
+{
+   lgChipInfo_t chipInfo;
+   int i, banned;
+
+   if (lgGpioGetChipInfo(handle, &chipInfo) == 0)
+   {
+      for (i=0; i<chipInfo.lines; i++)
+      {
+         if (xCheckGpioPermissions(Ctx, gpioDev, i)) banned = 0; else banned = 1;
+         lgGpioSetBannedState(handle, i, banned);
+      }
+      return 0;
+   }
+
+   return 1;
+}
+
+static int xPathBad(char *name)
+{
+   if (strstr(name, "..")) return 1;
+   if (strstr(name, "\\.")) return 1;
+   if (strstr(name, "./")) return 1;
+   return 0;
+}
+
+static int xApprove(lgCtx_p Ctx, char *filename, int mode)
+{
+   lgPermitGlobs_t *globs = &Ctx->permits.files;
+   lgPermitGlob_p g;
+   char *match=NULL;
+   char mperm=0;
+   int i;
+   int approve = 0;
+
+   if (xPathBad(filename))  return 0;
+
+   mode &= LG_FILE_RW;
+
+   if (!mode) return 0;
+
+   /* an exact path is more precise than any pattern matching it */
+
+   g = xFindLiteral(globs, filename);
+
+   if (g)
+   {
+      match = g->pattern;
+      mperm = g->perm;
+   }
+   else
+   {
+      for (i=0; i<globs->wildcards; i++)
+      {
+         g = &globs->wildcard[i];
+
+         if (fnmatch(g->pattern, filename, 0) == 0)
+         {
+            LG_DBG(LG_DEBUG_ALWAYS, "[%s] matches %s", g->pattern, filename);
+
+            // no prior match, or a more precise one?
+            if ((match == NULL) || (fnmatch(match, g->pattern, 0) == 0))
+            {
+               match = g->pattern;
+               mperm = g->perm;
+            }
+         }
+      }
+   }
+
+   if (match)
+   {
+      switch (mperm)
+      {
+         case 'R':
+            if (mode == LG_FILE_READ) approve = 1;
+            break;
+         case 'W':
+            if (mode == LG_FILE_WRITE) approve = 1;
+            break;
+         case 'U':
+            approve = 1;
+            break;
+      }
+   }
+
+   return approve;
+}
+
+static char *xPermitAlloc(char **arena, int bytes)
+{
+   /* carves space from a block sized in advance */
+
+   char *p = *arena;
+
+   *arena += (bytes + 7) & ~7;
+
+   return p;
+}
+
+static int xPermitBytes(char *permits)
+{
+   /* generous, one range or glob per character */
+
+   int len;
+
+   if (permits == NULL) return 0;
+
+   len = strlen(permits) + 1;
+
+   return (len * (8 + sizeof(lgPermitDev_t) +
+      sizeof(lgPermitRange_t) + (2 * sizeof(lgPermitGlob_t)))) + 64;
+}
+
+static int xRangeCmp(const void *a, const void *b)
+{
+   const lgPermitRange_t *ra = a, *rb = b;
+
+   if (ra->lo < rb->lo) return -1;
+   if (ra->lo > rb->lo) return 1;
+   return 0;
+}
+
+static int xGlobCmp(const void *a, const void *b)
+{
+   const lgPermitGlob_t *ga = a, *gb = b;
+   int r;
+
+   r = strcmp(ga->pattern, gb->pattern);
+
+   if (r) return r;
+
+   return ga->order - gb->order;
+}
+
+static void xAddRange(lgPermitDev_p e, int lo, int hi)
+{
+   if (lo > hi) return;
+
+   e->sub[e->subCount].lo = lo;
+   e->sub[e->subCount].hi = hi;
+   e->subCount++;
+}
+
+static void xCompileDevSubdev(char *str, lgPermitDev_p e)
 {
+   /*
+      Parses x.y where x and y may be *, n, or n-n, and y may also
+      be a comma separated list.  Parsing stops at anything unexpected,
+      keeping whatever was accepted before it.
+
+      e->sub must have room for a range per character of str.
+   */
+
    int num;
    int r1=0, r2=0;
    checkDevSubdev_t expect=DEV;
 
+   e->dev.lo = 1;
+   e->dev.hi = 0;
+   e->subCount = 0;
+
    while (1)
    {
-      printf("%c", *str);
       switch (*str)
       {
          case '0':
@@ -108,53 +414,48 @@ int xCheckDevSubdev(char *str, int dev, int subdev)
          case '8':
          case '9':
 
-            if ((expect == DEV) || (expect == SUBDEV))
+            num = 0;
+            while (isdigit(*str))
+               {num = (num * 10) + (*str) - '0'; ++str;}
+            --str;
+
+            if (expect == DEV)
             {
-               num = 0;
-               while (isdigit(*str))
-                  {num = (num * 10) + (*str) - '0'; ++str;}
-               --str;
                r1 = num;
+               e->dev.lo = e->dev.hi = r1;
+               expect = DEVNEXT;
+            }
 
-               if (expect == DEV)
-               {
-                  if ((dev == r1) && (subdev < 0)) return 1;
-                  expect = DEVNEXT;
-               }
-               else
-               {
-                  if (subdev == r1) return 1;
-                  expect = SUBDEVNEXT;
-               }
+            else if (expect == SUBDEV)
+            {
+               r1 = num;
+               xAddRange(e, r1, r1);
+               expect = SUBDEVNEXT;
             }
 
-            else if ((expect == DEV2) || (expect == SUBDEV2))
+            else if (expect == DEV2)
             {
-               num = 0;
-               while (isdigit(*str))
-                  {num = (num * 10) + (*str) - '0'; ++str;}
-               --str;
                r2 = num;
-
-               if (expect == DEV2)
-               {
-                  if ((dev < r1) || (dev > r2)) return 0;  /* fail */
-                  if (subdev < 0) return 1; /*pass */
-                  expect = DOT;
-               }
-               else
+               if (r1 > r2)
                {
-                  if ((subdev >= r1) && (subdev <= r2)) return 1;
-                  expect = COMMA;
+                  /* an inverted range grants no device */
+                  e->dev.lo = 1;
+                  e->dev.hi = 0;
+                  return;
                }
+               e->dev.hi = r2;
+               expect = DOT;
             }
 
-            else return 0;
+            else if (expect == SUBDEV2)
+            {
+               r2 = num;
+               xAddRange(e, r1, r2);
+               expect = COMMA;
+            }
 
-            break;
+            else return;
 
-         case '\0':
-            return 0;
             break;
 
          case ' ':
@@ -164,13 +465,18 @@ int xCheckDevSubdev(char *str, int dev, int subdev)
          case '*':
             if (expect == DEV)
             {
-               if (subdev < 0) return 1; /* pass */
+               e->dev.lo = INT32_MIN;
+               e->dev.hi = INT32_MAX;
                expect = DOT;
             }
 
-            else if (expect == SUBDEV) return 1;
+            else if (expect == SUBDEV)
+            {
+               xAddRange(e, 0, INT32_MAX);
+               return;
+            }
 
-            else return 0;
+            else return;
 
             break;
     
@@ -178,305 +484,217 @@ int xCheckDevSubdev(char *str, int dev, int subdev)
 
             if      (expect == DEVNEXT)    expect = DEV2;
             else if (expect == SUBDEVNEXT) expect = SUBDEV2;
-            else return 0;
+            else return;
 
             break;
             
          case '.':
 
-            if (expect == DOT) expect = SUBDEV;
-
-            else if (expect == DEVNEXT)
-            {
-               if (dev != r1) return 0; /* can't pass */
-               expect = SUBDEV;
-            }
-
-            else return 0;
+            if ((expect == DOT) || (expect == DEVNEXT)) expect = SUBDEV;
+            else return;
 
             break;
 
          case ',':
 
-            if ((expect == COMMA) || (expect == SUBDEVNEXT))
-            {
-               expect = SUBDEV;
-            }
-            else return 0;
+            if ((expect == COMMA) || (expect == SUBDEVNEXT)) expect = SUBDEV;
+            else return;
 
             break;
 
-         default:
-            return 0;
+         default: /* including the terminator */
+            return;
       }
       ++str;
    }
-
-   return 0;
-}
-
-static int xCheckDebugPermissions(lgCtx_p Ctx)
-{
-   if (Ctx->permits.debug)
-   {
-      if ((strcmp(Ctx->permits.debug, "Y") == 0) ||
-          (strcmp(Ctx->permits.debug, "y") == 0))
-      return 1;
-   }
-   return 0;
-}
-
-static int xCheckShellPermissions(lgCtx_p Ctx)
-{
-   if (Ctx->permits.shell)
-   {
-      if ((strcmp(Ctx->permits.shell, "Y") == 0) ||
-          (strcmp(Ctx->permits.shell, "y") == 0))
-      return 1;
-   }
-   return 0;
-}
-
-static int xCheckNotifyPermissions(lgCtx_p Ctx)
-{
-   if (Ctx->permits.notify)
-   {
-      if ((strcmp(Ctx->permits.notify, "Y") == 0) ||
-          (strcmp(Ctx->permits.notify, "y") == 0))
-      return 1;
-   }
-   return 0;
-}
-
-
-static int xCheckScriptPermissions(lgCtx_p Ctx)
-{
-   if (Ctx->permits.scripts)
-   {
-      if ((strcmp(Ctx->permits.scripts, "Y") == 0) ||
-          (strcmp(Ctx->permits.scripts, "y") == 0))
-      return 1;
-   }
-   return 0;
 }
 
-
-static int xCheckSerialPermissions(lgCtx_p Ctx, char *serDev)
+static void xCompileDevs(char *permits, lgPermitDevs_t *devs, char **arena)
 {
-   char buf[LG_MAX_PATH];
    char *str, *pos, *token;
    const char *delim = ":";
+   lgPermitDev_p e;
+   int i, j;
 
-   if (!Ctx->permits.serial) return 0;
-
-   strncpy(buf, Ctx->permits.serial, sizeof(buf)-1);
-   buf[sizeof(buf)-1] = 0;
+   devs->count = 0;
 
-   str = buf;
-   while ((token=lgCfgNextToken(&str, delim, &pos)))
-   {
-      LG_DBG(LG_DEBUG_ALWAYS, "%s and %s", serDev, token);
-
-      if (fnmatch(token, serDev, 0) == 0) return 1;
-   }
-   return 0;
-}
-
-static int xCheckI2cPermissions(lgCtx_p Ctx, int i2cDev, int i2cAddr)
-{
-   char buf[LG_MAX_PATH];
-   char *str, *pos, *token;
-   const char *delim = ":";
+   if (permits == NULL) return;
 
-   if (!Ctx->permits.i2c) return 0;
+   str = xPermitAlloc(arena, strlen(permits)+1);
+   strcpy(str, permits);
 
-   strncpy(buf, Ctx->permits.i2c, sizeof(buf)-1);
-   buf[sizeof(buf)-1] = 0;
+   devs->entry = (lgPermitDev_p)xPermitAlloc(
+      arena, (strlen(permits)+1) * sizeof(lgPermitDev_t));
 
-   str = buf;
    while ((token=lgCfgNextToken(&str, delim, &pos)))
    {
-      LG_DBG(LG_DEBUG_ALWAYS, "%d.%d and %s", i2cDev, i2cAddr, token);
+      e = &devs->entry[devs->count++];
 
-      if (xCheckDevSubdev(token, i2cDev, i2cAddr)) return 1;
-   }
-   return 0;
-}
+      e->sub = (lgPermitRange_p)xPermitAlloc(
+         arena, (strlen(token)+1) * sizeof(lgPermitRange_t));
 
-static int xCheckSpiPermissions(lgCtx_p Ctx, int spiDev, int spiChan)
-{
-   char buf[LG_MAX_PATH];
-   char *str, *pos, *token;
-   const char *delim = ":";
+      xCompileDevSubdev(token, e);
 
-   if (!Ctx->permits.spi) return 0;
+      /* sort and merge the subdevices for binary search */
 
-   strncpy(buf, Ctx->permits.spi, sizeof(buf)-1);
-   buf[sizeof(buf)-1] = 0;
+      qsort(e->sub, e->subCount, sizeof(lgPermitRange_t), xRangeCmp);
 
-   str = buf;
-   while ((token=lgCfgNextToken(&str, delim, &pos)))
-   {
-      LG_DBG(LG_DEBUG_ALWAYS, "%d.%d and %s", spiDev, spiChan, token);
-
-      if (xCheckDevSubdev(token, spiDev, spiChan)) return 1;
-   }
-   return 0;
-}
-
-static int xCheckGpioPermissions(lgCtx_p Ctx, int gpioDev, int gpio)
-{
-   char buf[LG_MAX_PATH];
-   char *str, *pos, *token;
-   const char *delim = ":";
-
-   if (!Ctx->permits.gpio) return 0;
-
-   strncpy(buf, Ctx->permits.gpio, sizeof(buf)-1);
-   buf[sizeof(buf)-1] = 0;
-
-   str = buf;
-   while ((token=lgCfgNextToken(&str, delim, &pos)))
-   {
-      LG_DBG(LG_DEBUG_ALWAYS, "%d.%d and %s", gpioDev, gpio, token);
-
-      if (xCheckDevSubdev(token, gpioDev, gpio)) return 1;
-   }
-   return 0;
-}
-
-static int xSetGpioPermissions(lgCtx_p Ctx, int gpioDev, int handle)
-{
-   lgChipInfo_t chipInfo;
-   int i, banned;
-
-   if (lgGpioGetChipInfo(handle, &chipInfo) == 0)
-   {
-      for (i=0; i<chipInfo.lines; i++)
+      for (i=0, j=1; j<e->subCount; j++)
       {
-         if (xCheckGpioPermissions(Ctx, gpioDev, i)) banned = 0; else banned = 1;
-         lgGpioSetBannedState(handle, i, banned);
+         if ((e->sub[i].hi == INT32_MAX) || (e->sub[j].lo <= e->sub[i].hi+1))
+         {
+            if (e->sub[j].hi > e->sub[i].hi) e->sub[i].hi = e->sub[j].hi;
+         }
+         else e->sub[++i] = e->sub[j];
       }
-      return 0;
-   }
 
-   return 1;
-}
+      if (e->subCount) e->subCount = i + 1;
 
-static int xPathBad(char *name)
-{
-   if (strstr(name, "..")) return 1;
-   if (strstr(name, "\\.")) return 1;
-   if (strstr(name, "./")) return 1;
-   return 0;
+      LG_DBG(LG_DEBUG_TRACE, "%s: devices %d-%d with %d subdevice ranges",
+         token, e->dev.lo, e->dev.hi, e->subCount);
+   }
 }
 
-static int xApprove(lgCtx_p Ctx, char *filename, int mode)
+static void xCompileGlobs(
+   char *permits, lgPermitGlobs_t *globs, int files, char **arena)
 {
-   char match[LG_MAX_PATH];
-   char buffer[LG_MAX_PATH];
-   char paths[LG_MAX_PATH];
-   char mperm=0;
-   char perm;
-   char term;
-   char *token, *pos, *str;
-   const char *delim =":";
-   int approve = 0;
+   char *str, *pos, *token, *buffer;
+   const char *delim = ":";
+   lgPermitGlob_p g;
+   char perm, term;
+   int i, n;
 
-   if (!Ctx->permits.files) return 0;
+   memset(globs, 0, sizeof(lgPermitGlobs_t));
 
-   if (xPathBad(filename))  return 0;
+   if (permits == NULL) return;
 
-   mode &= LG_FILE_RW;
+   str = xPermitAlloc(arena, strlen(permits)+1);
+   strcpy(str, permits);
 
-   if (!mode) return 0;
+   n = strlen(permits) + 1;
 
-   buffer[0] = 0;
-   match[0] = 0;
+   globs->wildcard = (lgPermitGlob_p)xPermitAlloc(
+      arena, n * sizeof(lgPermitGlob_t));
 
-   strncpy(paths, Ctx->permits.files, sizeof(paths)-1);
-   paths[sizeof(paths)-1] = 0;
+   globs->literal = (lgPermitGlob_p)xPermitAlloc(
+      arena, n * sizeof(lgPermitGlob_t));
+
+   n = 0;
 
-   str = paths;
    while ((token=lgCfgNextToken(&str, delim, &pos)))
    {
-      LG_DBG(LG_DEBUG_ALWAYS, "token: '%s'", token);
-      buffer[0] = 0;
       perm = 0;
-      term = 0;
-      sscanf(token, " %1000s %c%c", buffer, &perm, &term);
 
-      if (term != 0)
+      if (files)
       {
-         LG_DBG(LG_DEBUG_ALWAYS, "ignored, bad termination: %s", token);
-         continue;
-      }
+         /* path and permission, the path is no longer than the token */
 
-      if (xPathBad(buffer))
-      {
-         LG_DBG(LG_DEBUG_ALWAYS, "ignored, risky: %s", token);
-         continue;
-      }
+         buffer = xPermitAlloc(arena, strlen(token)+1);
+         buffer[0] = 0;
+         term = 0;
+         sscanf(token, " %1000s %c%c", buffer, &perm, &term);
 
-      if (fnmatch(buffer, filename, 0) == 0)
-      {
-         LG_DBG(LG_DEBUG_ALWAYS, "[%s] matches %s", buffer, filename);
-         if (match[0])  // prior match?
+         if (term != 0)
          {
-            if (fnmatch(match, buffer, 0) == 0)  // more precise match?
-            {
-               LG_DBG(LG_DEBUG_ALWAYS, "%s matches [%s]", match, buffer);
-               strcpy(match, buffer); // most precise match so far
-               mperm = perm;
-            }
+            LG_DBG(LG_DEBUG_ALWAYS, "ignored, bad termination: %s", token);
+            continue;
          }
-         else  // no prior match
+
+         if (xPathBad(buffer))
          {
-            strcpy(match, buffer);
-            mperm = perm;
+            LG_DBG(LG_DEBUG_ALWAYS, "ignored, risky: %s", token);
+            continue;
          }
       }
+      else buffer = token;
+
+      if (strpbrk(buffer, "*?[\\"))
+         g = &globs->wildcard[globs->wildcards++];
+      else
+         g = &globs->literal[globs->literals++];
+
+      g->pattern = buffer;
+      g->perm = toupper(perm);
+      g->order = n++;
    }
 
-   if (match[0])
+   /*
+      Sort the literals for binary search.  Where a literal repeats
+      the last one wins, as it would if they were matched in order.
+   */
+
+   qsort(globs->literal, globs->literals, sizeof(lgPermitGlob_t), xGlobCmp);
+
+   for (i=0, n=1; n<globs->literals; n++)
    {
-      switch (toupper(mperm))
-      {
-         case 'R':
-            if (mode == LG_FILE_READ) approve = 1;
-            break;
-         case 'W':
-            if (mode == LG_FILE_WRITE) approve = 1;
-            break;
-         case 'U':
-            approve = 1;
-            break;
-      }
+      if (strcmp(globs->literal[i].pattern, globs->literal[n].pattern))
+         ++i;
+
+      globs->literal[i] = globs->literal[n];
    }
 
-   return approve;
+   if (globs->literals) globs->literals = i + 1;
 }
 
 static void xClearUserPermits(lgCtx_p Ctx)
 {
+   free(Ctx->permits.mem);
    memset(&Ctx->permits, 0, sizeof(Ctx->permits));
 }
 
 static void xSetUserPermits(lgCtx_p Ctx)
 {
-   if (Cfg)
+   char *files, *scripts, *i2c, *spi, *serial, *gpio, *notify, *debug, *shell;
+   char *arena;
+
+   xClearUserPermits(Ctx);
+
+   pthread_rwlock_rdlock(&CfgLock);
+
+   Ctx->permits.gen = CfgGen;
+
+   if (Cfg == NULL)
+   {
+      pthread_rwlock_unlock(&CfgLock);
+      return;
+   }
+
+   files =   lgCfgGetValue(Cfg, "files",   Ctx->user);
+   scripts = lgCfgGetValue(Cfg, "scripts", Ctx->user);
+   i2c =     lgCfgGetValue(Cfg, "i2c",     Ctx->user);
+   spi =     lgCfgGetValue(Cfg, "spi",     Ctx->user);
+   serial =  lgCfgGetValue(Cfg, "serial",  Ctx->user);
+   gpio =    lgCfgGetValue(Cfg, "gpio",    Ctx->user);
+   notify =  lgCfgGetValue(Cfg, "notify",  Ctx->user);
+   debug =   lgCfgGetValue(Cfg, "debug",   Ctx->user);
+   shell =   lgCfgGetValue(Cfg, "shell",   Ctx->user);
+
+   if (xCheckYes(scripts)) Ctx->permits.flags |= LG_PERMIT_SCRIPTS;
+   if (xCheckYes(notify))  Ctx->permits.flags |= LG_PERMIT_NOTIFY;
+   if (xCheckYes(debug))   Ctx->permits.flags |= LG_PERMIT_DEBUG;
+   if (xCheckYes(shell))   Ctx->permits.flags |= LG_PERMIT_SHELL;
+
+   Ctx->permits.mem = malloc(
+      xPermitBytes(files) + xPermitBytes(serial) + xPermitBytes(i2c) +
+      xPermitBytes(spi) + xPermitBytes(gpio));
+
+   if (Ctx->permits.mem == NULL)
    {
-      Ctx->permits.files =   lgCfgGetValue(Cfg, "files",   Ctx->user);
-      Ctx->permits.scripts = lgCfgGetValue(Cfg, "scripts", Ctx->user);
-      Ctx->permits.i2c =     lgCfgGetValue(Cfg, "i2c",     Ctx->user);
-      Ctx->permits.spi =     lgCfgGetValue(Cfg, "spi",     Ctx->user);
-      Ctx->permits.serial =  lgCfgGetValue(Cfg, "serial",  Ctx->user);
-      Ctx->permits.gpio =    lgCfgGetValue(Cfg, "gpio",    Ctx->user);
-      Ctx->permits.notify =  lgCfgGetValue(Cfg, "notify",  Ctx->user);
-      Ctx->permits.debug =   lgCfgGetValue(Cfg, "debug",   Ctx->user);
-      Ctx->permits.shell =   lgCfgGetValue(Cfg, "shell",   Ctx->user);
+      /* device and file permits all refused */
+      LG_DBG(LG_DEBUG_ALWAYS, "no memory for %s permits", Ctx->user);
    }
-   else xClearUserPermits(Ctx);
+   else
+   {
+      arena = Ctx->permits.mem;
+
+      xCompileGlobs(files,  &Ctx->permits.files,  1, &arena);
+      xCompileGlobs(serial, &Ctx->permits.serial, 0, &arena);
+      xCompileDevs(i2c,     &Ctx->permits.i2c,       &arena);
+      xCompileDevs(spi,     &Ctx->permits.spi,       &arena);
+      xCompileDevs(gpio,    &Ctx->permits.gpio,      &arena);
+   }
+
+   pthread_rwlock_unlock(&CfgLock);
 }
 
 static int xSetUser(lgCtx_p Ctx, char *user, char *buf)
@@ -502,12 +720,13 @@ static int xSetUser(lgCtx_p Ctx, char *user, char *buf)
    return result;
 }
 
-static int xShareSetUse(lgCtx_p Ctx, int share)
+static int xShareSetUse(lgCtx_p Ctx, int share, int flags)
 {
-   LG_DBG(LG_DEBUG_TRACE, "share=%d", share);
+   LG_DBG(LG_DEBUG_TRACE, "share=%d flags=%d", share, flags);
 
    Ctx->autoSetShare = share;
    Ctx->autoUseShare = share;
+   Ctx->autoShareTransient = (flags & LG_SHARE_TRANSIENT) != 0;
 
    return LG_OKAY;
 }
@@ -560,30 +779,266 @@ static int xPassword(lgCtx_p Ctx, char *hash)
    return result;
 }
 
-int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
+static int xBatchValid(char *in, int size)
+{
+   /* checked in full so a bad batch has no side effects */
+
+   int pos;
+   lgCmd_p subP;
+
+   pos = LG_BATCH_HDR_BYTES;
+
+   while (pos < size)
+   {
+      subP = (lgCmd_p)(in + pos);
+
+      /* truncated or unpadded sub-command */
+      if (((size - pos) < sizeof(lgCmd_t)) ||
+          (subP->size > (size - pos - sizeof(lgCmd_t))) ||
+          (LG_BATCH_PAD(sizeof(lgCmd_t) + subP->size) > (size - pos)))
+         return 0;
+
+      /* these need the connection, not just the context */
+      if ((subP->cmd == LG_CMD_BATCH) || (subP->cmd == LG_CMD_RIDS) ||
+          (subP->cmd == LG_CMD_FRAME) ||
+          (subP->cmd == LG_CMD_NOIB) || (subP->cmd == LG_CMD_NOIBC))
+         return 0;
+
+      pos += LG_BATCH_PAD(sizeof(lgCmd_t) + subP->size);
+   }
+
+   return 1;
+}
+
+static int xExecBatch(lgCmd_p cmdP, int size, int cmdBufSize)
+{
+   /*
+      Each sub-command is copied to the end of the reply built so far
+      and executed there, so its reply lands in place.  The input is
+      copied first as replies may be longer than their commands.
+   */
+
+   char *cmdExt=(char*)&cmdP[1];
+   char *in;
+   uint32_t flags;
+   int inPos, outPos, room, subSize, count;
+   lgCmd_p subP;
+
+   if ((size < LG_BATCH_HDR_BYTES) || (size > cmdBufSize))
+      return LG_BAD_BATCH;
+
+   in = malloc(size);
+
+   if (in == NULL) return LG_NO_MEMORY;
+
+   memcpy(in, cmdExt, size);
+
+   if (!xBatchValid(in, size))
+   {
+      free(in);
+      return LG_BAD_BATCH;
+   }
+
+   flags = *(uint32_t*)in;
+
+   inPos = LG_BATCH_HDR_BYTES;
+   outPos = 0;
+   count = 0;
+
+   while (inPos < size)
+   {
+      subP = (lgCmd_p)(in + inPos);
+
+      subSize = sizeof(lgCmd_t) + subP->size;
+
+      /* stop when the rest of the reply might not fit */
+      room = (cmdBufSize - outPos) & ~(LG_BATCH_ALIGN - 1);
+
+      if (subSize >= room) break;
+
+      memcpy(cmdExt + outPos, subP, subSize);
+
+      subP = (lgCmd_p)(cmdExt + outPos);
+
+      lgExecCmd(subP, room);
+
+      count++;
+
+      outPos += LG_BATCH_PAD(sizeof(lgCmd_t) + subP->size);
+      inPos += LG_BATCH_PAD(subSize);
+
+      if ((subP->status < 0) && (flags & LG_BATCH_STOP_ON_ERROR)) break;
+   }
+
+   free(in);
+
+   cmdP->size = outPos;
+
+   return count;
+}
+
+static lgStatsShard_p xStatsGetShard(void)
+{
+   lgStatsShard_p shard;
+
+   pthread_mutex_lock(&xStatsMutex);
+
+   for (shard=xStatsShards; shard; shard=shard->next)
+   {
+      if (!shard->inUse) break;
+   }
+
+   if (shard == NULL)
+   {
+      shard = calloc(1, sizeof(lgStatsShard_t));
+
+      if (shard)
+      {
+         shard->gen = xStatsGen;
+         shard->next = xStatsShards;
+         xStatsShards = shard;
+      }
+   }
+
+   if (shard)
+   {
+      shard->inUse = 1;
+      pthread_setspecific(xStatsKey, shard);
+   }
+
+   pthread_mutex_unlock(&xStatsMutex);
+
+   return shard;
+}
+
+static void xStatsRecord(int cmd, int status, uint64_t nanos)
+{
+   lgStatsCmd_t *st;
+   uint32_t gen;
+   uint64_t micros;
+   int b;
+
+   if (cmd >= LG_STATS_CMDS) return;
+
+   if (xShard == NULL)
+   {
+      xShard = xStatsGetShard();
+
+      if (xShard == NULL) return;
+   }
+
+   gen = __atomic_load_n(&xStatsGen, __ATOMIC_RELAXED);
+
+   if (xShard->gen != gen)
+   {
+      /* the statistics have been reset, readers skip us meanwhile */
+      memset(xShard->cmd, 0, sizeof(xShard->cmd));
+      __atomic_store_n(&xShard->gen, gen, __ATOMIC_RELEASE);
+   }
+
+   micros = nanos / 1000;
+
+   if (micros)
+   {
+      b = 64 - __builtin_clzll(micros);
+      if (b >= LG_STATS_BUCKETS) b = LG_STATS_BUCKETS - 1;
+   }
+   else b = 0;
+
+   /* only this thread writes, the atomic stores keep readers sane */
+
+   st = &xShard->cmd[cmd];
+
+   __atomic_store_n(&st->calls, st->calls + 1, __ATOMIC_RELAXED);
+
+   if (status < 0)
+      __atomic_store_n(&st->errors, st->errors + 1, __ATOMIC_RELAXED);
+
+   __atomic_store_n(&st->totalNanos, st->totalNanos + nanos, __ATOMIC_RELAXED);
+
+   if (nanos > st->maxNanos)
+      __atomic_store_n(&st->maxNanos, nanos, __ATOMIC_RELAXED);
+
+   __atomic_store_n(&st->bucket[b], st->bucket[b] + 1, __ATOMIC_RELAXED);
+}
+
+static int xStatsRead(int flags, lgCmdStats_p stats, int max)
+{
+   /* returns the number of commands with statistics */
+
+   lgStatsShard_p shard;
+   lgStatsCmd_t *st;
+   lgCmdStats_t sum;
+   uint64_t v;
+   int cmd, b, count;
+
+   pthread_mutex_lock(&xStatsMutex);
+
+   count = 0;
+
+   for (cmd=0; (cmd<LG_STATS_CMDS) && (count<max); cmd++)
+   {
+      memset(&sum, 0, sizeof(sum));
+
+      for (shard=xStatsShards; shard; shard=shard->next)
+      {
+         if (__atomic_load_n(&shard->gen, __ATOMIC_ACQUIRE) != xStatsGen)
+            continue;
+
+         st = &shard->cmd[cmd];
+
+         sum.calls += __atomic_load_n(&st->calls, __ATOMIC_RELAXED);
+         sum.errors += __atomic_load_n(&st->errors, __ATOMIC_RELAXED);
+         sum.totalNanos += __atomic_load_n(&st->totalNanos, __ATOMIC_RELAXED);
+
+         v = __atomic_load_n(&st->maxNanos, __ATOMIC_RELAXED);
+         if (v > sum.maxNanos) sum.maxNanos = v;
+
+         for (b=0; b<LG_STATS_BUCKETS; b++)
+            sum.bucket[b] += __atomic_load_n(&st->bucket[b], __ATOMIC_RELAXED);
+      }
+
+      if (sum.calls)
+      {
+         sum.cmd = cmd;
+         stats[count++] = sum;
+      }
+   }
+
+   if (flags & LG_STATS_RESET)
+      __atomic_store_n(&xStatsGen, xStatsGen + 1, __ATOMIC_RELAXED);
+
+   pthread_mutex_unlock(&xStatsMutex);
+
+   return count;
+}
+
+static uint64_t xMonotonicNanos(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+static lgCtx_p xExecCtx(void)
 {
+   /* the calling thread's context, ready to execute commands */
+
    static int xPid = 0;
-   int res;
-   uint32_t tmp1;
-   int i;
-   int size;
    lgCtx_p Ctx;
-   lgLineInfo_t lInfo;
-   lgChipInfo_t cInfo;
-   res = LG_OKAY;
-   char *cmdExt=(char*)&cmdP[1];
-   uint32_t *argI=(uint32_t*)&cmdP[1];
-   uint64_t *argQ=(uint64_t*)&cmdP[1];
 
    pthread_once(&xInited, xInit);
 
    Ctx = lgCtxGet();
 
-   if (Ctx == NULL) return LG_NO_MEMORY;
+   if (Ctx == NULL) return NULL;
 
    if (Ctx->owner == 0)
    {
-      Ctx->owner = ++xPid;
+      /* workers and listeners assign owners concurrently */
+      Ctx->owner = __atomic_add_fetch(&xPid, 1, __ATOMIC_RELAXED);
 
       /* set default user if no preset user */
       if (!strlen(Ctx->user))
@@ -593,6 +1048,33 @@ int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
       Ctx->approved = 1;
       xSetUserPermits(Ctx);
    }
+   else if (Ctx->approved &&
+            (Ctx->permits.gen != __atomic_load_n(&CfgGen, __ATOMIC_ACQUIRE)))
+   {
+      /* the permits file has been reloaded */
+      xSetUserPermits(Ctx);
+   }
+
+   return Ctx;
+}
+
+static int xExecCmd(lgCmd_p cmdP, int cmdBufSize, int *fd, off_t *offset)
+{
+   int res;
+   uint32_t tmp1;
+   int i;
+   int size;
+   lgCtx_p Ctx;
+   lgLineInfo_t lInfo;
+   lgChipInfo_t cInfo;
+   res = LG_OKAY;
+   char *cmdExt=(char*)&cmdP[1];
+   uint32_t *argI=(uint32_t*)&cmdP[1];
+   uint64_t *argQ=(uint64_t*)&cmdP[1];
+
+   Ctx = xExecCtx();
+
+   if (Ctx == NULL) return LG_NO_MEMORY;
 
    size = cmdP->size;
 
@@ -615,6 +1097,24 @@ int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
          res = 8;
          break;
 
+      case LG_CMD_BATCH:
+         // flags pad *sub-commands
+         res = xExecBatch(cmdP, size, cmdBufSize);
+         break;
+
+      case LG_CMD_STATS:
+         // flags
+         if (!gPermits || xCheckDebugPermissions(Ctx))
+         {
+            tmp1 = (size >= 4) ? argI[0] : 0;
+            res = xStatsRead(tmp1, (lgCmdStats_p)cmdExt,
+               cmdBufSize / sizeof(lgCmdStats_t)) * sizeof(lgCmdStats_t);
+            cmdP->size = res;
+         }
+         else
+            res = LG_NO_PERMISSIONS;
+         break;
+
       case LG_CMD_CGI:
          if (!gPermits || xCheckDebugPermissions(Ctx))
          {
@@ -664,6 +1164,15 @@ int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
 
       case LG_CMD_FR:
          if (argI[1] > cmdBufSize) argI[1] = cmdBufSize;
+         if ((fd != NULL) && (argI[1] >= LG_SEND_FROM_FD_MIN))
+         {
+            res = lgFileReadFd(argI[0], argI[1], fd, offset);
+            if ((*fd >= 0) || (res < 0))
+            {
+               if (res > 0) cmdP->size = res;
+               break;
+            }
+         }
          res = lgFileRead(argI[0], cmdExt, argI[1]);
          if (res > 0) cmdP->size = res;
          break;
@@ -793,8 +1302,18 @@ int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
          res = lgNotifyOpenInBand(argI[0]);
          break;
 
+      case LG_CMD_NOIBC:
+         res = lgNotifyOpenInBand(argI[0]);
+         if (res >= 0) lgNotifySetFormat(res, LG_NOTIFY_FORMAT_COMPACT);
+         break;
+
       case LG_CMD_NP: res = lgNotifyPause(argI[0]); break;
 
+      case LG_CMD_NF:
+         // gpioMaskQ handle chip edgeMask decimation
+         res = lgNotifyFilter(argI[2], argI[3], argQ[0], argI[4], argI[5]);
+         break;
+
       case LG_CMD_LGV: res = lguVersion(); break;
 
       case LG_CMD_PCD:
@@ -907,6 +1426,19 @@ int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
             res = LG_BAD_SPI_COUNT;
          break;
 
+      case LG_CMD_STRC: res = lgStreamClose(argI[0]); break;
+
+      case LG_CMD_STRO:
+         // nfy period count *steps
+         if (size < LG_STREAM_HDR_BYTES)
+            res = LG_BAD_STREAM;
+         else if (!gPermits || xCheckNotifyPermissions(Ctx))
+            res = lgStreamOpen(argI[0], argI[1], argI[2],
+               cmdExt+LG_STREAM_HDR_BYTES, size-LG_STREAM_HDR_BYTES);
+         else
+            res = LG_NO_PERMISSIONS;
+         break;
+
       case LG_CMD_USER:
          res = xSetUser(Ctx, cmdExt, cmdExt);
          if (res > 0) cmdP->size = res;
@@ -916,8 +1448,8 @@ int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
          res = xPassword(Ctx, cmdExt);
          break;
 
-      case LG_CMD_SHARE: // share
-         res = xShareSetUse(Ctx, argI[0]);
+      case LG_CMD_SHARE: // share [flags]
+         res = xShareSetUse(Ctx, argI[0], (size >= 8) ? argI[1] : 0);
          break;
 
       case LG_CMD_SHRS: // h share
@@ -967,6 +1499,11 @@ int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
          res = lgGpioSetWatchdog(argI[0], argI[1], argI[2]);
          break;
 
+      case LG_CMD_GILA:
+         // handle gpio enable nfyHandle
+         res = lgGpioSetLineInfoAlerts(argI[0], argI[1], argI[2], argI[3]);
+         break;
+
       case LG_CMD_GSI:
          // handle gpio
          res = lgGpioClaimInput(argI[0],       0, argI[1]);
@@ -1167,3 +1704,123 @@ int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
    return res;
 }
 
+/*
+   Commands which scripts may run directly.  Each makes the same call
+   as its case in xExecCmd.  They only take numeric arguments, return
+   no data, and need no permission check beyond the handle's.
+*/
+
+static int xDirGDEB(uint32_t *a) {return lgGpioSetDebounce(a[0], a[1], a[2]);}
+static int xDirGMODE(uint32_t *a) {return lgGpioGetMode(a[0], a[1]);}
+static int xDirGP(uint32_t *a)
+   {return lgTxPulse(a[0], a[1], a[2], a[3], 0, 0);}
+static int xDirGR(uint32_t *a) {return lgGpioRead(a[0], a[1]);}
+static int xDirGW(uint32_t *a) {return lgGpioWrite(a[0], a[1], a[2]);}
+static int xDirGWDOG(uint32_t *a) {return lgGpioSetWatchdog(a[0], a[1], a[2]);}
+
+static int xDirI2CPC(uint32_t *a) {return lgI2cProcessCall(a[0], a[1], a[2]);}
+static int xDirI2CRB(uint32_t *a) {return lgI2cReadByteData(a[0], a[1]);}
+static int xDirI2CRS(uint32_t *a) {return lgI2cReadByte(a[0]);}
+static int xDirI2CRW(uint32_t *a) {return lgI2cReadWordData(a[0], a[1]);}
+static int xDirI2CWB(uint32_t *a)
+   {return lgI2cWriteByteData(a[0], a[1], a[2]);}
+static int xDirI2CWQ(uint32_t *a) {return lgI2cWriteQuick(a[0], a[1]);}
+static int xDirI2CWS(uint32_t *a) {return lgI2cWriteByte(a[0], a[1]);}
+static int xDirI2CWW(uint32_t *a)
+   {return lgI2cWriteWordData(a[0], a[1], a[2]);}
+
+static int xDirMICS(uint32_t *a)
+{
+   if (a[0] > LG_MAX_MICS_DELAY) return LG_BAD_MICS_DELAY;
+   lguSleep((double)a[0]/1E6);
+   return LG_OKAY;
+}
+
+static int xDirMILS(uint32_t *a)
+{
+   if (a[0] > LG_MAX_MILS_DELAY) return LG_BAD_MILS_DELAY;
+   lguSleep((double)a[0]/1E3);
+   return LG_OKAY;
+}
+
+static int xDirSERDA(uint32_t *a) {return lgSerialDataAvailable(a[0]);}
+static int xDirSERRB(uint32_t *a) {return lgSerialReadByte(a[0]);}
+static int xDirSERWB(uint32_t *a) {return lgSerialWriteByte(a[0], a[1]);}
+
+static struct
+{
+   int cmd;
+   lgExecFunc_t func;
+} xDirect[] =
+{
+   {LG_CMD_GDEB,  xDirGDEB},
+   {LG_CMD_GMODE, xDirGMODE},
+   {LG_CMD_GP,    xDirGP},
+   {LG_CMD_GR,    xDirGR},
+   {LG_CMD_GW,    xDirGW},
+   {LG_CMD_GWDOG, xDirGWDOG},
+   {LG_CMD_I2CPC, xDirI2CPC},
+   {LG_CMD_I2CRB, xDirI2CRB},
+   {LG_CMD_I2CRS, xDirI2CRS},
+   {LG_CMD_I2CRW, xDirI2CRW},
+   {LG_CMD_I2CWB, xDirI2CWB},
+   {LG_CMD_I2CWQ, xDirI2CWQ},
+   {LG_CMD_I2CWS, xDirI2CWS},
+   {LG_CMD_I2CWW, xDirI2CWW},
+   {LG_CMD_MICS,  xDirMICS},
+   {LG_CMD_MILS,  xDirMILS},
+   {LG_CMD_SERDA, xDirSERDA},
+   {LG_CMD_SERRB, xDirSERRB},
+   {LG_CMD_SERWB, xDirSERWB},
+};
+
+lgExecFunc_t lgExecDirectFunc(int cmd)
+{
+   int i;
+
+   for (i=0; i<(sizeof(xDirect)/sizeof(xDirect[0])); i++)
+   {
+      if (xDirect[i].cmd == cmd) return xDirect[i].func;
+   }
+
+   return NULL;
+}
+
+int lgExecDirect(lgExecFunc_t func, int cmd, uint32_t *arg)
+{
+   int res;
+   uint64_t start;
+
+   start = xMonotonicNanos();
+
+   if (xExecCtx() == NULL) res = LG_NO_MEMORY;
+   else                    res = func(arg);
+
+   xStatsRecord(cmd, res, xMonotonicNanos() - start);
+
+   return res;
+}
+
+int lgExecCmdFd(lgCmd_p cmdP, int cmdBufSize, int *fd, off_t *offset)
+{
+   int cmd, res;
+   uint64_t start;
+
+   cmd = cmdP->cmd;
+
+   if (fd != NULL) *fd = -1;
+
+   start = xMonotonicNanos();
+
+   res = xExecCmd(cmdP, cmdBufSize, fd, offset);
+
+   xStatsRecord(cmd, res, xMonotonicNanos() - start);
+
+   return res;
+}
+
+int lgExecCmd(lgCmd_p cmdP, int cmdBufSize)
+{
+   return lgExecCmdFd(cmdP, cmdBufSize, NULL, NULL);
+}
+
@@ -236,6 +236,63 @@ int lgFileRead(int handle, char *buf, int count)
    return status;
 }
 
+int lgFileReadFd(int handle, int count, int *fd, off_t *offset)
+{
+   /*
+      As lgFileRead but for a regular file, instead of reading the
+      bytes, returns a duplicate descriptor and the offset of the bytes
+      so that the caller may send them without copying.  The file
+      position moves past them as if they had been read.
+
+      Sets *fd to -1 if the bytes must be read with lgFileRead.
+   */
+
+   int status;
+   lgFileObj_p h;
+   struct stat st;
+   off_t pos;
+
+   LG_DBG(LG_DEBUG_TRACE, "handle=%d count=%d", handle, count);
+
+   *fd = -1;
+
+   if (!count)
+      PARAM_ERROR(LG_BAD_FILE_PARAM, "bad count (%d)", count);
+
+   status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_FILE, (void **)&h);
+
+   if (status == LG_OKAY)
+   {
+      if (!(h->mode & LG_FILE_READ))
+      {
+         LG_DBG(LG_DEBUG_FILE, "file not opened for read");
+         status = LG_FILE_NOT_ROPEN;
+      }
+      else if ((fstat(h->fd, &st) == 0) && S_ISREG(st.st_mode))
+      {
+         pos = lseek(h->fd, 0, SEEK_CUR);
+
+         if ((pos >= 0) && (pos < st.st_size))
+         {
+            if (count > (st.st_size - pos)) count = st.st_size - pos;
+
+            *fd = fcntl(h->fd, F_DUPFD_CLOEXEC, 0);
+
+            if (*fd >= 0)
+            {
+               lseek(h->fd, pos + count, SEEK_SET);
+               *offset = pos;
+               status = count;
+            }
+         }
+      }
+
+      lgHdlUnlock(handle);
+   }
+
+   return status;
+}
+
 
 int lgFileSeek(int handle, int32_t seekOffset, int seekFrom)
 {
@@ -94,13 +94,20 @@ static void _lgGpiochipClose(void *objPtr)
 
    if (chip == NULL) return;
 
-   /* stop any PWM on chip */
+   /* remove any PWM on chip */
    lgPthTxStop(chip);
 
-   /* stop any event reads on chip */
+   /* stop any event and line info reads on chip, wait for alert thread */
    lgPthAlertStop(chip);
 
-   usleep(100000); /* should be long enough for PWM/events to stop */
+   if (chip->infoCache)
+   {
+      LG_DBG(LG_DEBUG_ALLOC, "free infoCache: *%p", (void*)chip->infoCache);
+      free(chip->infoCache);
+      chip->infoCache = NULL;
+   }
+
+   pthread_mutex_destroy(&chip->infoMutex);
 
    for (i=0; i<chip->lines; i++)
    {
@@ -124,21 +131,12 @@ static void _lgGpiochipClose(void *objPtr)
                chip->LineInf[i].fd = -1;
             }
 
-            if (chip->LineInf[i].offsets_p)
+            if (chip->LineCfg[i].offsets_p)
             {
                LG_DBG(LG_DEBUG_ALLOC, "free offsets: *%p",
-                  (void*)chip->LineInf[i].offsets_p);
-               free(chip->LineInf[i].offsets_p);
-               chip->LineInf[i].offsets_p = NULL;
-            }
-
-            if (chip->LineInf[i].values_p)
-            {
-               LG_DBG(LG_DEBUG_ALLOC, "free values: *%p",
-                  (void*)chip->LineInf[i].values_p);
-
-               free(chip->LineInf[i].values_p);
-               chip->LineInf[i].values_p = NULL;
+                  (void*)chip->LineCfg[i].offsets_p);
+               free(chip->LineCfg[i].offsets_p);
+               chip->LineCfg[i].offsets_p = NULL;
             }
          }
       }
@@ -148,18 +146,32 @@ static void _lgGpiochipClose(void *objPtr)
 
    if (chip->LineInf) free(chip->LineInf);
 
+   LG_DBG(LG_DEBUG_ALLOC, "free LineCfg: *%p", (void*)chip->LineCfg);
+
+   if (chip->LineCfg) free(chip->LineCfg);
+
    LG_DBG(LG_DEBUG_ALLOC, "close chip fd: %d", chip->fd);
 
    close(chip->fd);
 }
 
+static void xLineInfoStale(lgChipObj_p chip, int gpio)
+{
+   /* our own change, the watch event may not have been read yet */
+
+   if (chip->infoCache == NULL) return;
+
+   pthread_mutex_lock(&chip->infoMutex);
+   chip->infoCache[gpio].stale = 1;
+   pthread_mutex_unlock(&chip->infoMutex);
+}
+
 static int xGpioHandleRequest(
    lgChipObj_p chip, struct gpio_v2_line_request *req)
 {
    int i, gpio, mode;
    int status;
    uint32_t *offsets_p;
-   uint64_t *values_p;
 
    LG_DBG(LG_DEBUG_USER, "chip=*%p req=*%p", (void*)chip, (void*)req);
 
@@ -173,18 +185,13 @@ static int xGpioHandleRequest(
    {
       offsets_p = calloc(req->num_lines, sizeof(uint32_t));
 
-      values_p = calloc(1, sizeof(uint64_t));
-
-      if ((offsets_p == NULL) || (values_p == NULL))
+      if (offsets_p == NULL)
       {
-         free(offsets_p); // passing NULL is legal
-         free(values_p); // passing NULL is legal
          close(req->fd);
          return LG_NOT_ENOUGH_MEMORY;
       }
 
-      LG_DBG(LG_DEBUG_ALLOC, "alloc offsets: *%p, values: *%p",
-         (void*)offsets_p, (void*)values_p);
+      LG_DBG(LG_DEBUG_ALLOC, "alloc offsets: *%p", (void*)offsets_p);
 
       mode = 0;
 
@@ -206,11 +213,14 @@ static int xGpioHandleRequest(
          chip->LineInf[gpio].fd = req->fd;
 
          chip->LineInf[gpio].offset = i;
+         chip->LineInf[gpio].leader = req->offsets[0];
+         chip->LineInf[gpio].values = 0;
 
-         chip->LineInf[gpio].offsets_p = offsets_p;
-         chip->LineInf[gpio].values_p = values_p;
+         chip->LineCfg[gpio].offsets_p = (i == 0) ? offsets_p : NULL;
 
          offsets_p[i] = gpio;
+
+         xLineInfoStale(chip, gpio);
       }
    }
    else
@@ -273,6 +283,137 @@ uint64_t xMakeStatus(uint64_t f)
    return s;
 }
 
+static int xLineInfoGet(
+   lgChipObj_p chip, int gpio, struct gpio_v2_line_info *linfo)
+{
+   int status = LG_OKAY;
+   lgLineInfoCache_p c;
+
+   if (chip->infoCache == NULL)
+   {
+      memset(linfo, 0, sizeof(*linfo));
+
+      linfo->offset = gpio;
+
+      if (ioctl(chip->fd, GPIO_V2_GET_LINEINFO_IOCTL, linfo))
+         status = LG_BAD_LINEINFO_IOCTL;
+
+      return status;
+   }
+
+   pthread_mutex_lock(&chip->infoMutex);
+
+   c = &chip->infoCache[gpio];
+
+   if (c->stale)
+   {
+      memset(linfo, 0, sizeof(*linfo));
+
+      linfo->offset = gpio;
+
+      if (ioctl(chip->fd, GPIO_V2_GET_LINEINFO_IOCTL, linfo) == 0)
+      {
+         c->info = *linfo;
+         c->stale = 0;
+      }
+      else status = LG_BAD_LINEINFO_IOCTL;
+   }
+   else *linfo = c->info;
+
+   pthread_mutex_unlock(&chip->infoMutex);
+
+   return status;
+}
+
+static int xLineInfoWatch(lgChipObj_p chip)
+{
+   int i;
+   uint32_t offset;
+   lgLineInfoCache_p cache;
+
+   /*
+      Watching a line returns its current info, after which the
+      kernel queues a change event on the chip fd whenever the line
+      is requested, released, or reconfigured.  The alert thread
+      reads those events and keeps the cache current.
+   */
+
+   if (chip->infoCache) return LG_OKAY;
+
+   cache = calloc(chip->lines, sizeof(lgLineInfoCache_t));
+
+   if (cache == NULL)
+      ALLOC_ERROR(LG_NOT_ENOUGH_MEMORY, "can't allocate line info cache");
+
+   for (i=0; i<chip->lines; i++)
+   {
+      cache[i].info.offset = i;
+
+      if (ioctl(chip->fd, GPIO_V2_GET_LINEINFO_WATCH_IOCTL, &cache[i].info))
+      {
+         LG_DBG(LG_DEBUG_ALWAYS, "%s", strerror(errno));
+
+         while (--i >= 0)
+         {
+            offset = i;
+            ioctl(chip->fd, GPIO_GET_LINEINFO_UNWATCH_IOCTL, &offset);
+         }
+
+         free(cache);
+
+         return LG_BAD_LINEINFO_IOCTL;
+      }
+   }
+
+   LG_DBG(LG_DEBUG_ALLOC, "alloc infoCache: *%p", (void*)cache);
+
+   pthread_mutex_lock(&chip->infoMutex);
+   chip->infoCache = cache;
+   pthread_mutex_unlock(&chip->infoMutex);
+
+   lgPthAlertWatchChip(chip);
+
+   return LG_OKAY;
+}
+
+int xLineInfoChanged(
+   lgChipObj_p chip, struct gpio_v2_line_info_changed *change,
+   int *nfyHandle)
+{
+   int report = 0;
+   lgLineInfoCache_p c;
+
+   /* called by the alert thread, returns 1 if the change is reported */
+
+   if (change->info.offset >= chip->lines) return 0;
+
+   pthread_mutex_lock(&chip->infoMutex);
+
+   if (chip->infoCache)
+   {
+      c = &chip->infoCache[change->info.offset];
+
+      c->info = change->info;
+
+      report = c->alerts;
+      *nfyHandle = c->nfyHandle;
+   }
+
+   pthread_mutex_unlock(&chip->infoMutex);
+
+   return report;
+}
+
+static void xLineInfoCopy(
+   lgChipObj_p chip, struct gpio_v2_line_info *linfo, lgLineInfo_p lineInfo)
+{
+   lineInfo->offset = linfo->offset;
+   lineInfo->lFlags = xMakeStatus(linfo->flags) |
+      (chip->LineInf[linfo->offset].mode << 8);
+   strncpy(lineInfo->name, linfo->name, sizeof(lineInfo->name));
+   strncpy(lineInfo->user, linfo->consumer, sizeof(lineInfo->user));
+}
+
 
 static int xClaim(
    lgChipObj_p chip,
@@ -297,7 +438,7 @@ static int xClaim(
       for (i=0; i<size; i++)
       {
          if (((unsigned)gpios[i] > chip->lines) ||
-             (chip->LineInf[gpios[i]].banned)) return LG_NOT_PERMITTED;
+             (chip->LineCfg[gpios[i]].banned)) return LG_NOT_PERMITTED;
 
          req.offsets[i] = gpios[i];
       }
@@ -333,6 +474,7 @@ static int xClaim(
 static int xSetAsFree(lgChipObj_p chip, int gpio)
 {
    lgLineInf_p GPIO;
+   uint32_t *offsets_p;
    int i, g;
    lgTxRec_p pTx;
    lgAlertRec_p pEvt;
@@ -372,19 +514,23 @@ static int xSetAsFree(lgChipObj_p chip, int gpio)
 
       GPIO->mode = LG_CHIP_MODE_UNKNOWN;
 
+      xLineInfoStale(chip, gpio);
+
       return LG_OKAY;
    }
 
    // legal as long as group leader (a singleton is always a leader)
 
-   if (gpio == GPIO->offsets_p[0])
+   if (gpio == GPIO->leader)
    {
       LG_DBG(LG_DEBUG_ALLOC,
          "group free GPIO: %d (mode %d)", gpio, GPIO->mode);
 
+      offsets_p = chip->LineCfg[gpio].offsets_p;
+
       for (i=0; i<GPIO->group_size; i++)
       {
-         g = GPIO->offsets_p[i];
+         g = offsets_p[i];
 
          lgPthTxLock();
 
@@ -411,11 +557,13 @@ static int xSetAsFree(lgChipObj_p chip, int gpio)
 
       close(GPIO->fd);
 
-      LG_DBG(LG_DEBUG_ALLOC, "free offsets: *%p, values: *%p",
-         (void*)GPIO->offsets_p, (void*)GPIO->values_p);
+      for (i=0; i<GPIO->group_size; i++)
+         xLineInfoStale(chip, offsets_p[i]);
+
+      LG_DBG(LG_DEBUG_ALLOC, "free offsets: *%p", (void*)offsets_p);
 
-      free(GPIO->offsets_p);
-      free(GPIO->values_p);
+      free(offsets_p);
+      chip->LineCfg[gpio].offsets_p = NULL;
 
       return LG_OKAY;
    }
@@ -663,19 +811,20 @@ static int xWave(
 
 void xWrite(lgChipObj_p chip, int gpio, int value)
 {
-   lgLineInf_p GPIO;
+   lgLineInf_p GPIO, LEAD;
    struct gpio_v2_line_values lv;
    uint64_t m = 0;
 
    LG_DBG(LG_DEBUG_TRACE, "chip=*%p gpio=%d value=%d", (void*)chip, gpio, value);
 
    GPIO = &chip->LineInf[gpio];
+   LEAD = &chip->LineInf[GPIO->leader];
 
    xSetBit(&m, GPIO->offset);
-   xAssignBit(GPIO->values_p, GPIO->offset, value);
+   xAssignBit(&LEAD->values, GPIO->offset, value);
 
    lv.mask = m;
-   lv.bits = *GPIO->values_p;
+   lv.bits = LEAD->values;
 
    ioctl(GPIO->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &lv);
 }
@@ -693,12 +842,12 @@ void xGroupWrite(
    {
       if (groupMask & ((uint64_t)1<<i))
       {
-         xAssignBit(GPIO->values_p, i, groupBits & (1<<i));
+         xAssignBit(&GPIO->values, i, groupBits & (1<<i));
       }
    }
 
    lv.mask = groupMask;
-   lv.bits = *GPIO->values_p;
+   lv.bits = GPIO->values;
 
    ioctl(GPIO->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &lv);
 }
@@ -713,6 +862,7 @@ int lgGpiochipOpen(int gpioDev)
    struct gpiochip_info info;
    char chipName[128];
    lgLineInf_p lInf; /* used to stop -fanalyzer warning */
+   lgLineCfg_p lCfg;
 
    LG_DBG(LG_DEBUG_TRACE, "gpioDev=%d", gpioDev);
 
@@ -747,6 +897,8 @@ int lgGpiochipOpen(int gpioDev)
 
    chip->handle = handle;
 
+   pthread_mutex_init(&chip->infoMutex, NULL);
+
    /* calloc will zero all members */
    lInf = calloc(info.lines, sizeof(lgLineInf_t));
 
@@ -760,6 +912,18 @@ int lgGpiochipOpen(int gpioDev)
 
    LG_DBG(LG_DEBUG_ALLOC, "alloc LineInf: *%p", (void*)chip->LineInf);
 
+   lCfg = calloc(info.lines, sizeof(lgLineCfg_t));
+
+   if (lCfg == NULL)
+   {
+      lgHdlFree(handle, LG_HDL_TYPE_GPIO);
+      ALLOC_ERROR(LG_NOT_ENOUGH_MEMORY, "can't allocate gpio lines");
+   }
+
+   chip->LineCfg = lCfg;
+
+   LG_DBG(LG_DEBUG_ALLOC, "alloc LineCfg: *%p", (void*)chip->LineCfg);
+
    strncpy(chip->name,  info.name,  sizeof(chip->name));
    strncpy(chip->label, info.label, sizeof(chip->label));
 
@@ -798,7 +962,6 @@ int lgGpiochipClose(int handle)
 int lgGpioSetBannedState(int handle, int gpio, int banned)
 {
    int status;
-   lgLineInf_p GPIO;
    lgChipObj_p chip;
 
    LG_DBG(LG_DEBUG_TRACE,
@@ -810,8 +973,7 @@ int lgGpioSetBannedState(int handle, int gpio, int banned)
    {
       if (gpio < chip->lines)
       {
-         GPIO = &chip->LineInf[gpio];
-         GPIO->banned = banned;
+         chip->LineCfg[gpio].banned = banned;
       }
       else status = LG_BAD_GPIO_NUMBER;
 
@@ -862,27 +1024,15 @@ int lgGpioGetLineInfo(int handle, int gpio, lgLineInfo_p lineInfo)
    LG_DBG(LG_DEBUG_TRACE, "handle=%d gpio=%d lineInfo=*%p",
       handle, gpio, (void*)lineInfo);
 
-   memset(&linfo, 0, sizeof(linfo));
-
    status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_GPIO, (void **)&chip);
 
    if (status == LG_OKAY)
    {
       if (gpio < chip->lines)
       {
-         linfo.offset = gpio;
-
-         status = ioctl(chip->fd, GPIO_V2_GET_LINEINFO_IOCTL, &linfo);
+         status = xLineInfoGet(chip, gpio, &linfo);
 
-         if (status == 0)
-         {
-            lineInfo->offset = linfo.offset;
-            lineInfo->lFlags = xMakeStatus(linfo.flags) |
-               (chip->LineInf[gpio].mode << 8);
-            strncpy(lineInfo->name, linfo.name, sizeof(lineInfo->name));
-            strncpy(lineInfo->user, linfo.consumer, sizeof(lineInfo->user));
-         }
-         else status = LG_BAD_LINEINFO_IOCTL;
+         if (status == LG_OKAY) xLineInfoCopy(chip, &linfo, lineInfo);
       }
       else status = LG_BAD_GPIO_NUMBER;
 
@@ -892,6 +1042,48 @@ int lgGpioGetLineInfo(int handle, int gpio, lgLineInfo_p lineInfo)
    return status;
 }
 
+int lgGpioGetChipLineInfo(int handle, int count, lgLineInfo_p lineInfo)
+{
+   int i;
+   int status;
+   struct gpio_v2_line_info linfo;
+   lgChipObj_p chip;
+
+   LG_DBG(LG_DEBUG_TRACE, "handle=%d count=%d lineInfo=*%p",
+      handle, count, (void*)lineInfo);
+
+   if (count < 0) count = 0;
+
+   if (count && (lineInfo == NULL))
+      PARAM_ERROR(LG_BAD_POINTER, "NULL lineInfo");
+
+   status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_GPIO, (void **)&chip);
+
+   if (status == LG_OKAY)
+   {
+      /* first call on the chip starts the watches, later calls use cache */
+
+      xLineInfoWatch(chip);
+
+      if (count > chip->lines) count = chip->lines;
+
+      for (i=0; i<count; i++)
+      {
+         status = xLineInfoGet(chip, i, &linfo);
+
+         if (status != LG_OKAY) break;
+
+         xLineInfoCopy(chip, &linfo, &lineInfo[i]);
+      }
+
+      if (status == LG_OKAY) status = chip->lines;
+
+      lgHdlUnlock(handle);
+   }
+
+   return status;
+}
+
 int lgGpioGetMode(int handle, int gpio)
 {
    int status;
@@ -900,23 +1092,18 @@ int lgGpioGetMode(int handle, int gpio)
 
    LG_DBG(LG_DEBUG_TRACE, "handle=%d gpio=%d", handle, gpio);
 
-   memset(&linfo, 0, sizeof(linfo));
-
    status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_GPIO, (void **)&chip);
 
    if (status == LG_OKAY)
    {
       if (gpio < chip->lines)
       {
-         linfo.offset = gpio;
+         status = xLineInfoGet(chip, gpio, &linfo);
 
-         status = ioctl(chip->fd, GPIO_V2_GET_LINEINFO_IOCTL, &linfo);
-
-         if (status == 0)
+         if (status == LG_OKAY)
          {
             status = xMakeStatus(linfo.flags) | (chip->LineInf[gpio].mode << 8);
          }
-         else status = LG_BAD_LINEINFO_IOCTL;
       }
       else status = LG_BAD_GPIO_NUMBER;
 
@@ -1080,11 +1267,9 @@ int lgGpioClaimAlert(
    int status;
    int mode;
    uint64_t flags;
-   uint32_t *offsets_p;
    lgChipObj_p chip;
    lgAlertRec_p p;
    struct gpio_v2_line_request req;
-   uint64_t *values_p;
 
    LG_DBG(LG_DEBUG_TRACE, "handle=%d lFlags=%x eFlags=%x gpio=%d nfyHandle=%d",
       handle, lFlags, eFlags, gpio, nfyHandle);
@@ -1118,40 +1303,21 @@ int lgGpioClaimAlert(
 
             if (status == 0)
             {
-               offsets_p = calloc(1, sizeof(uint32_t));
-
-               if (offsets_p == NULL)
-               {
-                  close(req.fd);
-                  return LG_NOT_ENOUGH_MEMORY;
-               }
-
-               chip->LineInf[gpio].offsets_p = offsets_p;
-
-               values_p = calloc(1, sizeof(values_p));
-
-               if (values_p == NULL)
-               {
-                  free(offsets_p);
-                  chip->LineInf[gpio].offsets_p = NULL;
-                  chip->LineInf[gpio].values_p = NULL;
-                  close(req.fd);
-                  return LG_NOT_ENOUGH_MEMORY;
-               }
-
-               chip->LineInf[gpio].values_p = values_p;
-
                chip->LineInf[gpio].mode = LG_CHIP_BIT_ALERT;
-               chip->LineInf[gpio].eFlags = eFlags;
                chip->LineInf[gpio].group_size = 1;
                chip->LineInf[gpio].fd = req.fd;
                chip->LineInf[gpio].offset = 0;
+               chip->LineInf[gpio].leader = gpio;
+               chip->LineInf[gpio].values = 0;
+
+               chip->LineCfg[gpio].eFlags = eFlags;
+
+               xLineInfoStale(chip, gpio);
 
                if ((p = lgGpioGetAlertRec(chip, gpio)) != NULL)
                   p->active= 0;
 
-               lgGpioCreateAlertRec(
-                  chip, gpio, &chip->LineInf[gpio], nfyHandle);
+               lgGpioCreateAlertRec(chip, gpio, nfyHandle);
             }
             else status = LG_BAD_EVENT_REQUEST;
          }
@@ -1402,7 +1568,7 @@ int lgGpioRead(int handle, int gpio)
 int lgGpioWrite(int handle, int gpio, int value)
 {
    int status;
-   lgLineInf_p GPIO;
+   lgLineInf_p GPIO, LEAD;
    lgChipObj_p chip;
    struct gpio_v2_line_values lv;
    uint64_t m = 0;
@@ -1419,11 +1585,13 @@ int lgGpioWrite(int handle, int gpio, int value)
 
          if (GPIO->mode & LG_CHIP_BIT_OUTPUT)
          {
+            LEAD = &chip->LineInf[GPIO->leader];
+
             xSetBit(&m, GPIO->offset);
-            xAssignBit(GPIO->values_p, GPIO->offset, value);
+            xAssignBit(&LEAD->values, GPIO->offset, value);
 
             lv.mask = m;
-            lv.bits = *GPIO->values_p;
+            lv.bits = LEAD->values;
 
             status = ioctl(
                GPIO->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &lv);
@@ -1528,7 +1696,7 @@ int lgGroupWrite(
                {
                   if (groupMask & (1<<i))
                   {
-                     xAssignBit(GPIO->values_p, i, groupBits & (1<<i));
+                     xAssignBit(&GPIO->values, i, groupBits & (1<<i));
                   }
                }
 
@@ -1558,7 +1726,7 @@ int lgGroupWrite(
 int lgGpioSetDebounce(int handle, int gpio, int debounce_us)
 {
    int status;
-   lgLineInf_p GPIO;
+   lgLineCfg_p GPIO;
    lgChipObj_p chip;
    lgAlertRec_p p;
 
@@ -1574,7 +1742,7 @@ int lgGpioSetDebounce(int handle, int gpio, int debounce_us)
    {
       if (gpio < chip->lines)
       {
-         GPIO = &chip->LineInf[gpio];
+         GPIO = &chip->LineCfg[gpio];
 
          GPIO->debounce_us = debounce_us;
 
@@ -1592,7 +1760,7 @@ int lgGpioSetDebounce(int handle, int gpio, int debounce_us)
 int lgGpioSetWatchdog(int handle, int gpio, int watchdog_us)
 {
    int status;
-   lgLineInf_p GPIO;
+   lgLineCfg_p GPIO;
    lgChipObj_p chip;
    lgAlertRec_p p;
 
@@ -1608,7 +1776,7 @@ int lgGpioSetWatchdog(int handle, int gpio, int watchdog_us)
    {
       if (gpio < chip->lines)
       {
-         GPIO = &chip->LineInf[gpio];
+         GPIO = &chip->LineCfg[gpio];
 
          GPIO->watchdog_us = watchdog_us;
 
@@ -1626,7 +1794,7 @@ int lgGpioSetWatchdog(int handle, int gpio, int watchdog_us)
 int lgGpioSetAlertsFunc(
    int handle, int gpio, lgGpioAlertsFunc_t cbf, void *userdata)
 {
-   lgLineInf_p GPIO;
+   lgLineCfg_p GPIO;
    lgChipObj_p chip;
    int status;
 
@@ -1639,7 +1807,7 @@ int lgGpioSetAlertsFunc(
    {
       if (gpio < chip->lines)
       {
-         GPIO = &chip->LineInf[gpio];
+         GPIO = &chip->LineCfg[gpio];
          GPIO->alertFunc = cbf;
          GPIO->userdata = userdata;
       }
@@ -1651,6 +1819,38 @@ int lgGpioSetAlertsFunc(
    return status;
 }
 
+int lgGpioSetLineInfoAlerts(int handle, int gpio, int enable, int nfyHandle)
+{
+   lgChipObj_p chip;
+   int status;
+
+   LG_DBG(LG_DEBUG_TRACE, "handle=%d gpio=%d enable=%d nfyHandle=%d",
+      handle, gpio, enable, nfyHandle);
+
+   status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_GPIO, (void **)&chip);
+
+   if (status == LG_OKAY)
+   {
+      if (gpio < chip->lines)
+      {
+         status = xLineInfoWatch(chip);
+
+         if (status == LG_OKAY)
+         {
+            pthread_mutex_lock(&chip->infoMutex);
+            chip->infoCache[gpio].alerts = (enable != 0);
+            chip->infoCache[gpio].nfyHandle = nfyHandle;
+            pthread_mutex_unlock(&chip->infoMutex);
+         }
+      }
+      else status = LG_BAD_GPIO_NUMBER;
+
+      lgHdlUnlock(handle);
+   }
+
+   return status;
+}
+
 void lgGpioSetSamplesFunc(lgGpioAlertsFunc_t cbf, void *userdata)
 {
    LG_DBG(LG_DEBUG_TRACE, "func=*%p userdata=*%p", cbf, userdata);
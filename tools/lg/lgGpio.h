@@ -30,22 +30,41 @@ For more information, please refer to <http://unlicense.org/>
 
 #include "lgpio.h"
 
+/*
+   Per line state is split in two.  lgLineInf_t holds what every
+   read and write needs and is kept small (32 bytes, two lines per
+   cache line).  lgLineCfg_t holds what is only needed when lines
+   are claimed or freed, or by the alert thread.
+*/
+
 typedef struct lgLineInf_s
 {
-   int      banned;
    int      mode;
-   int      eFlags;
-   int      group_size;
    int      fd;
+   uint32_t offset; /* position in group */
+   uint32_t leader; /* GPIO of group leader (itself if a singleton) */
+   int      group_size;
+   uint64_t values; /* last written group values, valid in the leader */
+} lgLineInf_t, *lgLineInf_p;
+
+typedef struct lgLineCfg_s
+{
+   int      banned;
+   int      eFlags;
    int      debounce_us;
    int      watchdog_us;
    callbk_t alertFunc;
    void     *userdata;
-   uint32_t offset;
-   uint32_t *offsets_p;
-   uint64_t *values_p; /* redundant to store values with gpiochip API2  */
-                       /* kept in case it is needed again in the future */
-} lgLineInf_t, *lgLineInf_p;
+   uint32_t *offsets_p; /* group GPIO, set in the leader */
+} lgLineCfg_t, *lgLineCfg_p;
+
+typedef struct lgLineInfoCache_s
+{
+   struct gpio_v2_line_info info;
+   int stale; /* refetch before use, set after our own line changes */
+   int alerts; /* report changes */
+   int nfyHandle; /* notify handle for reports */
+} lgLineInfoCache_t, *lgLineInfoCache_p;
 
 typedef struct lgChipObj_s
 {
@@ -54,14 +73,21 @@ typedef struct lgChipObj_s
    uint32_t lines;
    int fd;
    lgLineInf_p LineInf;
+   lgLineCfg_p LineCfg;
    char name[LG_GPIO_NAME_LEN];
    char label[LG_GPIO_LABEL_LEN];
    char userLabel[LG_GPIO_USER_LEN];
+   pthread_mutex_t infoMutex; /* protects infoCache */
+   lgLineInfoCache_p infoCache; /* NULL until line info is watched */
+   struct lgChipObj_s *watchNext; /* alert thread watched chip list */
 } lgChipObj_t, *lgChipObj_p;
 
 void xWrite(lgChipObj_p chip, int gpio, int value);
 void xGroupWrite(
    lgChipObj_p chip, int gpio, uint64_t groupBits, uint64_t groupMask);
+int xLineInfoChanged(
+   lgChipObj_p chip, struct gpio_v2_line_info_changed *change,
+   int *nfyHandle);
 
 extern callbk_t lgGpioSamplesFunc;
 extern void *lgGpioSamplesUserdata;
@@ -60,14 +60,36 @@ typedef struct
    callbk_t destructor;    // used to correctly free object resources
    int owner;              // id of owning thread
    int share;              // if object can be used by non-owners
+   int transient;          // freed with its owner even if shared
 } lgHdlHdr_t, *lgHdlHdr_p;
 
 typedef struct
 {
    lgHdlHdr_p header;
    pthread_mutex_t mutex; // access control
+   uint32_t gen;          // bumped whenever the slot is allocated or freed
 } lgHdl_t;
 
+/*
+   Per thread cache of the last handle resolved by its owner.  A hit
+   skips the header/magic checks and the owner check.  The slot
+   generation is bumped under slgHdlMutex (a handle may be freed by a
+   caller already holding the slot mutex) so it is updated and read
+   atomically, a handle which has been freed (and possibly reused) is
+   never matched.  The owner is compared as a thread may act for several
+   owners (rgpiod workers).
+*/
+typedef struct
+{
+   int handle;
+   int type;
+   int owner;
+   uint32_t gen;
+   void *obj;
+} lgHdlCache_t;
+
+static __thread lgHdlCache_t xHdlCache = {-1, -1, 0, 0, NULL};
+
 static pthread_mutex_t slgHdlMutex = PTHREAD_MUTEX_INITIALIZER;
 
 lgHdl_t lgHdl[LG_HDL_SLOTS];
@@ -183,10 +205,12 @@ int lgHdlAlloc(
    h->type = type;
 
    h->share = Ctx->autoSetShare;
+   h->transient = Ctx->autoShareTransient;
    h->owner = Ctx->owner;
    strncpy(h->user, Ctx->user, LG_USER_LEN);
 
    lgHdl[handle].header = h;
+   __atomic_add_fetch(&lgHdl[handle].gen, 1, __ATOMIC_RELEASE);
 
    return handle;
 }
@@ -241,16 +265,29 @@ int lgHdlGetLockedObj(int handle, int type, void **objPtr)
 {
    lgHdlHdr_p h;
    lgCtx_p Ctx;
+   uint32_t gen;
 
    pthread_once(&xInited, xInit);
 
-   Ctx = lgCtxGet();
-
    if ((handle < 0) || (handle >= LG_HDL_SLOTS))
       PARAM_ERROR(LG_BAD_HANDLE, "bad handle (%d)", handle);
 
+   Ctx = lgCtxGet();
+
    pthread_mutex_lock(&lgHdl[handle].mutex);   
 
+   gen = __atomic_load_n(&lgHdl[handle].gen, __ATOMIC_ACQUIRE);
+
+   if ((xHdlCache.handle == handle) &&
+       (xHdlCache.type == type) &&
+       (xHdlCache.owner == Ctx->owner) &&
+       (xHdlCache.gen == gen))
+   {
+      /* fast path, already validated for this owner */
+      *objPtr = xHdlCache.obj;
+      return LG_OKAY;
+   }
+
    h = lgHdl[handle].header;
  
    if ((h == (void *)LG_HDL_FREE) || (h == (void *)LG_HDL_RSVD))
@@ -275,6 +312,15 @@ int lgHdlGetLockedObj(int handle, int type, void **objPtr)
          "not owned or shared by user (%d)", handle);
    }
 
+   if (h->owner == Ctx->owner)
+   {
+      xHdlCache.handle = handle;
+      xHdlCache.type = type;
+      xHdlCache.owner = Ctx->owner;
+      xHdlCache.gen = gen;
+      xHdlCache.obj = h->obj;
+   }
+
    *objPtr = h->obj;
    
    return LG_OKAY;
@@ -336,6 +382,7 @@ int lgHdlSetShare(int handle, int share)
    }
 
    h->share = share;
+   h->transient = 0; /* an explicit share outlives the owner */
 
    pthread_mutex_unlock(&lgHdl[handle].mutex);   
    
@@ -369,7 +416,7 @@ int lgHdlFree(int handle, int type)
 {
    int status;
    void **dummy;
-   lgHdlHdr_p h;
+   lgHdlHdr_p h = NULL;
 
    pthread_once(&xInited, xInit);
 
@@ -405,14 +452,24 @@ int lgHdlFree(int handle, int type)
       }
          
       lgHdl[handle].header = NULL;
+      __atomic_add_fetch(&lgHdl[handle].gen, 1, __ATOMIC_RELEASE);
+   }
+   pthread_mutex_unlock(&slgHdlMutex);
+
+   /*
+      The header is now unreachable so the destructor can run without
+      the global handle mutex, it may need to wait for worker threads
+      which themselves take that mutex.
+   */
 
+   if (h != NULL)
+   {
       if (h->destructor != NULL) (h->destructor)(h->obj);
 
       if (h->obj != NULL) free(h->obj);
-      
+
       free(h);
    }
-   pthread_mutex_unlock(&slgHdlMutex);
    
    return status;
 }
@@ -431,7 +488,7 @@ void lgHdlPurgeByOwner(int owner)
 
       if ((h != (void *)LG_HDL_FREE) && (h != (void *)LG_HDL_RSVD))
       {
-         if ((h->owner == owner) && (!h->share))
+         if ((h->owner == owner) && (!h->share || h->transient))
          {
             lgHdlFree(i, h->type);
          }
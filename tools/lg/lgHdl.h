@@ -40,6 +40,7 @@ For more information, please refer to <http://unlicense.org/>
 #define LG_HDL_TYPE_NOTIFY 5
 #define LG_HDL_TYPE_SCRIPT 6
 #define LG_HDL_TYPE_SPI    7
+#define LG_HDL_TYPE_STREAM 8
 
 int lgHdlAlloc
    (int type, int objSize, void **objPtr, callbk_t destructor);
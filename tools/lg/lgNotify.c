@@ -28,17 +28,36 @@ For more information, please refer to <http://unlicense.org/>
 #define _GNU_SOURCE /* needed for pipes */
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <pthread.h>
 #include <limits.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <errno.h>
+#include <linux/futex.h>
 
 #include "lgpio.h"
 
 #include "lgDbg.h"
 #include "lgHdl.h"
+#include "lgPthAlerts.h"
+
+#define LG_MAX_EMIT_FRAMES 16 /* enough for any batch of compact reports */
+
+/* notifications marked closing since the alert thread last reaped */
+static int xNotifyClosing = 0;
+
+/* the last notification id given out */
+static uint64_t xNotifyIds = 0;
+
+/* called as each notification is closed, e.g. to end its streams */
+static void (*xNotifyCloseHook)(uint64_t id) = NULL;
 
 static void xCreatePipe(const char *name, int perm)
 {
@@ -55,13 +74,75 @@ static void xCreatePipe(const char *name, int perm)
 }
 
 
+static size_t xRingSize(uint32_t slots)
+{
+   return sizeof(lgNotifyRing_t) + (slots * sizeof(lgGpioReport_t));
+}
+
+
+static int xFutex(uint32_t *addr, int op, uint32_t val, struct timespec *ts)
+{
+   return syscall(SYS_futex, addr, op, val, ts, NULL, 0);
+}
+
+
+static int xPutVarint(uint8_t *buf, uint64_t val)
+{
+   int n = 0;
+
+   while (val >= 0x80)
+   {
+      buf[n++] = (val & 0x7f) | 0x80;
+      val >>= 7;
+   }
+
+   buf[n++] = val;
+
+   return n;
+}
+
+
+static int xVarintLen(uint64_t val)
+{
+   int n = 1;
+
+   while (val >= 0x80)
+   {
+      val >>= 7;
+      n++;
+   }
+
+   return n;
+}
+
+
+static uint64_t xZigzag(int64_t val)
+{
+   return ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+}
+
+
+static uint8_t nfyFrames[LG_MAX_EMIT_FRAMES * LG_COMPACT_MAX_FRAME];
+
+
 static void _notifyClose(lgNotify_t *h)
 {
    char fifo[128];
+   void (*hook)(uint64_t id);
 
    LG_DBG(LG_DEBUG_INTERNAL, "fd=%d pipe_no=%d objp=*%p",
       h->fd, h->pipe_number, h);
 
+   hook = __atomic_load_n(&xNotifyCloseHook, __ATOMIC_ACQUIRE);
+
+   if (hook) hook(h->id);
+
+   if (h->ring) munmap(h->ring, xRingSize(h->ringSlots));
+
+   if (h->capture) lgCaptureClose(h->capture);
+
+   free(h->decimCount);
+
    if (h->fd >= 0) close(h->fd);
    
    if (h->pipe_number)
@@ -72,19 +153,38 @@ static void _notifyClose(lgNotify_t *h)
    }
 }
 
+
+static int xNotifyAlloc(lgNotify_t **h)
+{
+   int handle;
+
+   handle = lgHdlAlloc(
+      LG_HDL_TYPE_NOTIFY, sizeof(lgNotify_t), (void**)h, _notifyClose);
+
+   if (handle >= 0)
+      (*h)->id = __atomic_add_fetch(&xNotifyIds, 1, __ATOMIC_RELAXED);
+
+   return handle;
+}
+
 /* ----------------------------------------------------------------------- */
 
 void lgNotifyCloseOrphans(int slot, int fd)
 {
-   static int *handles;
-   static int maxHandles = 20;
-   int i, numHandles;
+   int *handles;
+   int i, numHandles, maxHandles;
    lgNotify_t *h;
    int status;
 
    /* Check for and close any orphaned notifications. */
 
-   if (handles == NULL) handles = malloc(sizeof(int) * maxHandles);
+   maxHandles = lgHdlGetHandlesForType(LG_HDL_TYPE_NOTIFY, NULL, 0);
+
+   if (maxHandles <= 0) return;
+
+   handles = malloc(sizeof(int) * maxHandles);
+
+   if (handles == NULL) return;
 
    numHandles = lgHdlGetHandlesForType(LG_HDL_TYPE_NOTIFY, handles, maxHandles);
    
@@ -109,6 +209,65 @@ void lgNotifyCloseOrphans(int slot, int fd)
 
       lgHdlUnlock(handles[i]);
    }
+
+   free(handles);
+}
+
+static void xNotifySetClosing(lgNotify_t *h)
+{
+   h->state = LG_NOTIFY_CLOSING;
+
+   __atomic_add_fetch(&xNotifyClosing, 1, __ATOMIC_RELEASE);
+
+   /* an idle alert thread would otherwise never reap it */
+   lgPthAlertWake();
+}
+
+void lgNotifyReapClosing(void)
+{
+   int *handles;
+   int i, numHandles, maxHandles;
+   lgNotify_t *h;
+   int status;
+
+   /*
+      Frees notifications which failed outside the alert thread, e.g.
+      while a stream record was written.  They may never have another
+      report so can't be left for emitNotifications to find.
+   */
+
+   if (__atomic_exchange_n(&xNotifyClosing, 0, __ATOMIC_ACQUIRE) == 0)
+      return;
+
+   maxHandles = lgHdlGetHandlesForType(LG_HDL_TYPE_NOTIFY, NULL, 0);
+
+   if (maxHandles <= 0) return;
+
+   handles = malloc(sizeof(int) * maxHandles);
+
+   if (handles == NULL) return;
+
+   numHandles = lgHdlGetHandlesForType(LG_HDL_TYPE_NOTIFY, handles, maxHandles);
+
+   if (numHandles > maxHandles) numHandles = maxHandles;
+
+   for (i=0; i<numHandles; i++)
+   {
+      status = lgHdlGetLockedObjTrusted(
+         handles[i], LG_HDL_TYPE_NOTIFY, (void **)&h);
+
+      if (status < 0) continue;
+
+      if (h->state == LG_NOTIFY_CLOSING)
+      {
+         LG_DBG(LG_DEBUG_USER, "reaped closing handle=%d", handles[i]);
+         lgHdlFree(handles[i], LG_HDL_TYPE_NOTIFY);
+      }
+
+      lgHdlUnlock(handles[i]);
+   }
+
+   free(handles);
 }
 
 /* ----------------------------------------------------------------------- */
@@ -122,8 +281,7 @@ int lgNotifyOpenWithSize(int bufSize)
 
    LG_DBG(LG_DEBUG_INTERNAL, "bufSize=%d", bufSize);
 
-   handle = lgHdlAlloc(
-      LG_HDL_TYPE_NOTIFY, sizeof(lgNotify_t), (void**)&h, _notifyClose);
+   handle = xNotifyAlloc(&h);
 
    if (handle < 0) {return LG_NO_MEMORY;}
 
@@ -154,6 +312,8 @@ int lgNotifyOpenWithSize(int bufSize)
    }
 
    h->max_emits  = MAX_EMITS;
+   h->pipeSize = fcntl(fd, F_GETPIPE_SZ);
+   h->pipeFixed = (bufSize != 0) || (h->pipeSize <= 0);
    h->state = LG_NOTIFY_RUNNING;
 
    lgNotifyCloseOrphans(handle, fd);
@@ -177,8 +337,7 @@ int lgNotifyOpenInBand(int fd)
 
    LG_DBG(LG_DEBUG_TRACE, "fd=%d", fd);
 
-   handle = lgHdlAlloc(
-      LG_HDL_TYPE_NOTIFY, sizeof(lgNotify_t), (void**)&h, _notifyClose);
+   handle = xNotifyAlloc(&h);
 
    if (handle < 0) {return LG_NO_MEMORY;}
 
@@ -249,26 +408,268 @@ int lgNotifyPause (int handle)
 
 /* ----------------------------------------------------------------------- */
 
-int lgNotifyClose(int handle)
+int lgNotifyFilter(
+   int handle, int chip, uint64_t gpioMask, int edgeMask, int decimation)
 {
    int status;
    lgNotify_t *h;
 
-   LG_DBG(LG_DEBUG_TRACE, "handle=%d", handle);
+   LG_DBG(LG_DEBUG_TRACE,
+      "handle=%d chip=%d gpioMask=%"PRIx64" edgeMask=%d decimation=%d",
+      handle, chip, gpioMask, edgeMask, decimation);
+
+   if ((chip < -1) || (chip > 255))
+      PARAM_ERROR(LG_BAD_NOTIFY_FILTER, "bad chip (%d)", chip);
+
+   if ((edgeMask < 0) || (edgeMask > LG_BOTH_EDGES))
+      PARAM_ERROR(LG_BAD_NOTIFY_FILTER, "bad edgeMask (%d)", edgeMask);
+
+   if (decimation < 0)
+      PARAM_ERROR(LG_BAD_NOTIFY_FILTER, "bad decimation (%d)", decimation);
 
    status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_NOTIFY, (void **)&h);
 
    if (status == LG_OKAY)
    {
-      if (h->state > LG_NOTIFY_CLOSING) h->state = LG_NOTIFY_CLOSING;
+      if (h->state > LG_NOTIFY_CLOSING)
+      {
+         h->chip = chip;
+         h->gpioMask = gpioMask;
+         h->edgeMask = edgeMask;
+         h->decimation = decimation;
+
+         free(h->decimCount);
+         h->decimCount = NULL;
+         h->decimChips = 0;
+
+         /* selecting everything, including GPIO above 63, is no filter */
+
+         h->filtered = (chip >= 0) || (gpioMask != ~(uint64_t)0) ||
+            (edgeMask != LG_BOTH_EDGES) || (decimation > 1);
+      }
       else
       {
          LG_DBG(LG_DEBUG_USER, "bad handle (%d)", handle);
          status = LG_BAD_HANDLE;
       }
 
-      /* actual close done in alert thread */
-      status = lgHdlFree(handle, LG_HDL_TYPE_NOTIFY);
+      lgHdlUnlock(handle);
+   }
+
+   return status;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static uint32_t *xNotifyDecimCount(lgNotify_t *h, int chip, int gpio)
+{
+   /* the counts are kept per chip as the filter may be for any chip */
+
+   uint32_t (*counts)[64];
+   int chips;
+
+   if (chip >= h->decimChips)
+   {
+      chips = chip + 1;
+
+      counts = realloc(h->decimCount, chips * sizeof(*counts));
+
+      if (counts == NULL) return NULL;
+
+      memset(counts + h->decimChips, 0,
+         (chips - h->decimChips) * sizeof(*counts));
+
+      h->decimCount = counts;
+      h->decimChips = chips;
+   }
+
+   return &h->decimCount[chip][gpio];
+}
+
+int lgNotifyWanted(lgNotify_t *h, lgGpioReport_t *report)
+{
+   int gpio = report->gpio;
+   uint32_t *count;
+
+   if (!h->filtered) return 1;
+
+   if ((h->chip >= 0) && (h->chip != report->chip)) return 0;
+
+   /* the mask can't select GPIO above 63 */
+
+   if ((gpio >= 64) || !(h->gpioMask & ((uint64_t)1 << gpio))) return 0;
+
+   /* only edges are subject to edgeMask and decimation */
+
+   if (report->flags || (report->level > 1)) return 1;
+
+   if (report->level)
+   {
+      if (!(h->edgeMask & LG_RISING_EDGE)) return 0;
+   }
+   else
+   {
+      if (!(h->edgeMask & LG_FALLING_EDGE)) return 0;
+   }
+
+   if (h->decimation > 1)
+   {
+      count = xNotifyDecimCount(h, report->chip, gpio);
+
+      if (count)
+      {
+         if (++*count < h->decimation) return 0;
+
+         *count = 0;
+      }
+   }
+
+   return 1;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifySetFormat(int handle, int format)
+{
+   int status;
+   lgNotify_t *h;
+
+   LG_DBG(LG_DEBUG_TRACE, "handle=%d format=%d", handle, format);
+
+   if ((format != LG_NOTIFY_FORMAT_REPORT) &&
+       (format != LG_NOTIFY_FORMAT_COMPACT))
+      PARAM_ERROR(LG_BAD_NOTIFY_FILTER, "bad format (%d)", format);
+
+   status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_NOTIFY, (void **)&h);
+
+   if (status == LG_OKAY)
+   {
+      if ((h->state > LG_NOTIFY_CLOSING) && !h->ring && !h->capture)
+         h->format = format;
+      else
+      {
+         LG_DBG(LG_DEBUG_USER, "bad handle (%d)", handle);
+         status = LG_BAD_HANDLE;
+      }
+
+      lgHdlUnlock(handle);
+   }
+
+   return status;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifyEncodeCompact(
+   lgGpioReport_t *reports, int count, uint8_t *frame, int *bytes)
+{
+   /*
+      Encodes as many reports as fit into one frame of at most
+      LG_COMPACT_MAX_FRAME bytes.  Returns the number encoded.
+   */
+
+   uint8_t *body = frame + 2; /* length is always sent as 2 bytes */
+   int room = LG_COMPACT_MAX_FRAME - 2;
+   int pos, size, n, end, i, run, alt, level;
+   uint64_t prev, last;
+
+   prev = reports[0].timestamp;
+
+   pos = xPutVarint(body, prev);
+
+   n = 0;
+
+   while (n < count)
+   {
+      /*
+         A segment holds consecutive reports for the same line.
+         Size it pessimistically, a header plus a run per report.
+      */
+
+      size = pos + 5;
+
+      last = prev;
+
+      for (end=n; end<count; end++)
+      {
+         if ((end > n) &&
+             ((reports[end].chip  != reports[n].chip) ||
+              (reports[end].gpio  != reports[n].gpio) ||
+              (reports[end].flags != reports[n].flags))) break;
+
+         i = 3 + xVarintLen(xZigzag(reports[end].timestamp - last));
+
+         if ((size + i) > room) break;
+
+         size += i;
+
+         last = reports[end].timestamp;
+      }
+
+      if (end == n) break;
+
+      body[pos++] = reports[n].chip;
+      body[pos++] = reports[n].gpio;
+      body[pos++] = reports[n].flags;
+
+      pos += xPutVarint(body+pos, end-n);
+
+      for (i=n; i<end; i=run)
+      {
+         level = reports[i].level;
+
+         alt = ((i+1) < end) && (level < 2) &&
+               (reports[i+1].level == (level ^ 1));
+
+         for (run=i+1; run<end; run++)
+         {
+            if (alt) level ^= 1;
+
+            if (reports[run].level != level) break;
+         }
+
+         body[pos++] = reports[i].level | (alt ? LG_COMPACT_ALTERNATE : 0);
+
+         pos += xPutVarint(body+pos, run-i);
+      }
+
+      for (i=n; i<end; i++)
+      {
+         pos += xPutVarint(body+pos, xZigzag(reports[i].timestamp - prev));
+
+         prev = reports[i].timestamp;
+      }
+
+      n = end;
+   }
+
+   frame[0] = (pos & 0x7f) | 0x80;
+   frame[1] = pos >> 7;
+
+   *bytes = pos + 2;
+
+   return n;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifyGetStats(int handle, lgNotifyStats_p stats)
+{
+   int status;
+   lgNotify_t *h;
+
+   LG_DBG(LG_DEBUG_TRACE, "handle=%d stats=*%p", handle, stats);
+
+   if (stats == NULL) PARAM_ERROR(LG_BAD_POINTER, "stats=NULL");
+
+   status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_NOTIFY, (void **)&h);
+
+   if (status == LG_OKAY)
+   {
+      stats->sent = h->sent;
+      stats->dropped = h->dropped;
+      stats->pipeSize = h->pipeSize;
+      stats->resizes = h->resizes;
 
       lgHdlUnlock(handle);
    }
@@ -276,4 +677,554 @@ int lgNotifyClose(int handle)
    return status;
 }
 
+/* ----------------------------------------------------------------------- */
+
+static void xNotifyDropped(lgNotify_t *h, int count)
+{
+   h->dropped += count;
+
+   LG_DBG(LG_DEBUG_USER, "fd=%d dropped %d reports (%"PRIu64" in total)",
+      h->fd, count, h->dropped);
+}
+
+
+static int xNotifyGrowPipe(lgNotify_t *h, int need)
+{
+   /* returns 1 if the pipe now has room for need more bytes */
+
+   int pending, size;
+
+   if (h->pipeFixed) return 0;
+
+   if (ioctl(h->fd, FIONREAD, &pending) < 0) pending = h->pipeSize;
+
+   size = h->pipeSize * 2;
+
+   while (size < (pending + need)) size *= 2;
+
+   size = fcntl(h->fd, F_SETPIPE_SZ, size);
+
+   if (size <= h->pipeSize)
+   {
+      /* at the system limit, stop trying */
+      LG_DBG(LG_DEBUG_USER, "fd=%d can't grow pipe beyond %d (%m)",
+         h->fd, h->pipeSize);
+      h->pipeFixed = 1;
+      return 0;
+   }
+
+   LG_DBG(LG_DEBUG_USER, "fd=%d pipe grown from %d to %d",
+      h->fd, h->pipeSize, size);
+
+   h->pipeSize = size;
+   h->resizes++;
+
+   return (size - pending) >= need;
+}
+
+
+static int xNotifyWriteBytes(lgNotify_t *h, void *buf, int bytes)
+{
+   /* returns bytes written, or -1 if the notification is unusable */
+
+   int err, more;
+
+   err = write(h->fd, buf, bytes);
+
+   if (err < 0)
+   {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+      {
+         /* serious error, no point continuing */
+
+         LG_DBG(LG_DEBUG_ALWAYS, "fd=%d errno=%d (%m)", h->fd, errno);
+
+         xNotifySetClosing(h);
+
+         return -1;
+      }
+
+      err = 0;
+   }
+
+   if ((err < bytes) && h->pipeSize && xNotifyGrowPipe(h, bytes - err))
+   {
+      more = write(h->fd, (uint8_t *)buf + err, bytes - err);
+
+      if (more > 0) err += more;
+   }
+
+   return err;
+}
+
+
+void lgNotifyWrite(lgNotify_t *h, lgGpioReport_t *reports, int count)
+{
+   /*
+      Delivers a batch of reports with as few system calls as possible.
+      Only called by the alert thread.
+   */
+
+   int sent, bytes, n, frames, err;
+   int frameBytes[LG_MAX_EMIT_FRAMES];
+   int frameReports[LG_MAX_EMIT_FRAMES];
+
+   if (h->ring)
+   {
+      sent = lgNotifyRingWrite(h, reports, count);
+   }
+   else if (h->capture)
+   {
+      sent = lgCaptureWrite(h->capture, reports, count);
+   }
+   else if (h->format == LG_NOTIFY_FORMAT_COMPACT)
+   {
+      /*
+         Frames fit in PIPE_BUF so each is written atomically to a
+         pipe.  A socket takes the whole batch in one write.
+      */
+
+      bytes = 0;
+
+      for (sent=0, frames=0; (sent<count) && (frames<LG_MAX_EMIT_FRAMES);
+           frames++)
+      {
+         n = lgNotifyEncodeCompact(
+            reports+sent, count-sent, nfyFrames+bytes, &frameBytes[frames]);
+
+         frameReports[frames] = n;
+         bytes += frameBytes[frames];
+         sent += n;
+      }
+
+      if (h->pipeSize)
+      {
+         bytes = 0;
+         sent = 0;
+
+         for (n=0; n<frames; n++)
+         {
+            err = xNotifyWriteBytes(h, nfyFrames+bytes, frameBytes[n]);
+
+            if (err < 0) return;
+
+            if (err == frameBytes[n]) sent += frameReports[n];
+
+            bytes += frameBytes[n];
+         }
+      }
+      else
+      {
+         err = xNotifyWriteBytes(h, nfyFrames, bytes);
+
+         if (err < 0) return;
+
+         if (err != bytes) sent = 0;
+      }
+   }
+   else
+   {
+      bytes = count * sizeof(lgGpioReport_t);
+
+      err = xNotifyWriteBytes(h, reports, bytes);
+
+      if (err < 0) return;
+
+      if (err % sizeof(lgGpioReport_t))
+      {
+         /* the reader can no longer find the report boundaries */
+
+         LG_DBG(LG_DEBUG_ALWAYS, "fd=%d wrote part of a report", h->fd);
+
+         xNotifySetClosing(h);
+
+         return;
+      }
+
+      sent = err / sizeof(lgGpioReport_t);
+   }
+
+   h->sent += sent;
+
+   if (sent < count) xNotifyDropped(h, count - sent);
+}
+
+
+int lgNotifyWriteRecord(int handle, uint64_t id, uint8_t *frame, int bytes)
+{
+   /*
+      Delivers a complete record frame (see LG_NOTIFY_FORMAT_COMPACT)
+      to the notification with the id (see lgNotifyGetId), not to a
+      later user of the handle.  The frame is dropped while the
+      notification is paused or if the reader has fallen behind.  A
+      NULL frame just checks that the notification can take records.
+   */
+
+   int status;
+   lgNotify_t *h;
+
+   status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_NOTIFY, (void **)&h);
+
+   if (status == LG_OKAY)
+   {
+      if ((h->id != id) ||
+          (h->state <= LG_NOTIFY_CLOSING) || h->ring || h->capture ||
+          (h->format != LG_NOTIFY_FORMAT_COMPACT))
+      {
+         status = LG_BAD_STREAM;
+      }
+      else if ((frame != NULL) && (h->state == LG_NOTIFY_RUNNING))
+      {
+         if (xNotifyWriteBytes(h, frame, bytes) < 0) status = LG_BAD_STREAM;
+      }
+
+      lgHdlUnlock(handle);
+   }
+
+   return status;
+}
+
+uint64_t lgNotifyGetId(int handle)
+{
+   /* 0 if the caller may not use the notification */
+
+   uint64_t id = 0;
+   lgNotify_t *h;
+
+   if (lgHdlGetLockedObj(handle, LG_HDL_TYPE_NOTIFY, (void **)&h) == LG_OKAY)
+   {
+      if (h->state > LG_NOTIFY_CLOSING) id = h->id;
+
+      lgHdlUnlock(handle);
+   }
+
+   return id;
+}
+
+void lgNotifySetCloseHook(void (*hook)(uint64_t id))
+{
+   __atomic_store_n(&xNotifyCloseHook, hook, __ATOMIC_RELEASE);
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifyClose(int handle)
+{
+   int status;
+   lgNotify_t *h;
+
+   LG_DBG(LG_DEBUG_TRACE, "handle=%d", handle);
+
+   status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_NOTIFY, (void **)&h);
+
+   if (status == LG_OKAY)
+   {
+      if (h->state > LG_NOTIFY_CLOSING) h->state = LG_NOTIFY_CLOSING;
+      else
+      {
+         LG_DBG(LG_DEBUG_USER, "bad handle (%d)", handle);
+         status = LG_BAD_HANDLE;
+      }
+
+      /* actual close done in alert thread */
+      status = lgHdlFree(handle, LG_HDL_TYPE_NOTIFY);
+
+      lgHdlUnlock(handle);
+   }
+
+   return status;
+}
+
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifyOpenRing(int slots)
+{
+   int fd;
+   lgNotify_t *h;
+   lgNotifyRing_p ring;
+   int handle;
+
+   LG_DBG(LG_DEBUG_TRACE, "slots=%d", slots);
+
+   if (slots == 0) slots = LG_NOTIFY_RING_SLOTS;
+
+   if ((slots < LG_MIN_NOTIFY_RING_SLOTS) ||
+       (slots > LG_MAX_NOTIFY_RING_SLOTS) ||
+       (slots & (slots-1)))
+      PARAM_ERROR(LG_BAD_NOTIFY_SLOTS, "bad slots (%d)", slots);
+
+   fd = memfd_create("lg-notify", MFD_CLOEXEC);
+
+   if (fd < 0) PARAM_ERROR(LG_NO_MEMORY, "memfd_create failed (%m)");
+
+   if (ftruncate(fd, xRingSize(slots)) < 0)
+   {
+      close(fd);
+      PARAM_ERROR(LG_NO_MEMORY, "ftruncate failed (%m)");
+   }
+
+   ring = mmap(
+      NULL, xRingSize(slots), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+
+   if (ring == MAP_FAILED)
+   {
+      close(fd);
+      PARAM_ERROR(LG_NO_MEMORY, "mmap failed (%m)");
+   }
+
+   ring->slots = slots;
+   ring->magic = LG_NOTIFY_RING_MAGIC;
+
+   handle = xNotifyAlloc(&h);
+
+   if (handle < 0)
+   {
+      munmap(ring, xRingSize(slots));
+      close(fd);
+      return LG_NO_MEMORY;
+   }
+
+   h->fd = fd;
+   h->ring = ring;
+   h->ringSlots = slots;
+   h->pipe_number = 0;
+   h->max_emits = MAX_EMITS;
+   h->state = LG_NOTIFY_RUNNING;
+
+   return handle;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifyRingFd(int handle)
+{
+   int status;
+   lgNotify_t *h;
+
+   LG_DBG(LG_DEBUG_TRACE, "handle=%d", handle);
+
+   status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_NOTIFY, (void **)&h);
+
+   if (status == LG_OKAY)
+   {
+      if ((h->state > LG_NOTIFY_CLOSING) && h->ring)
+      {
+         status = fcntl(h->fd, F_DUPFD_CLOEXEC, 0);
+
+         if (status < 0)
+         {
+            LG_DBG(LG_DEBUG_USER, "dup failed (%m)");
+            status = LG_NO_MEMORY;
+         }
+      }
+      else
+      {
+         LG_DBG(LG_DEBUG_USER, "bad handle (%d)", handle);
+         status = LG_BAD_HANDLE;
+      }
+
+      lgHdlUnlock(handle);
+   }
+
+   return status;
+}
+
+/* ----------------------------------------------------------------------- */
+
+lgNotifyRing_p lgNotifyRingMap(int fd)
+{
+   struct stat st;
+   lgNotifyRing_p ring;
+
+   LG_DBG(LG_DEBUG_TRACE, "fd=%d", fd);
+
+   if ((fstat(fd, &st) < 0) || (st.st_size < (off_t)sizeof(lgNotifyRing_t)))
+   {
+      LG_DBG(LG_DEBUG_USER, "bad ring fd (%d)", fd);
+      return NULL;
+   }
+
+   ring = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+
+   if (ring == MAP_FAILED)
+   {
+      LG_DBG(LG_DEBUG_USER, "mmap failed (%m)");
+      return NULL;
+   }
+
+   if ((ring->magic != LG_NOTIFY_RING_MAGIC) ||
+       (st.st_size != (off_t)xRingSize(ring->slots)))
+   {
+      LG_DBG(LG_DEBUG_USER, "not a notification ring (%d)", fd);
+      munmap(ring, st.st_size);
+      return NULL;
+   }
+
+   return ring;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifyRingUnmap(lgNotifyRing_p ring)
+{
+   LG_DBG(LG_DEBUG_TRACE, "ring=*%p", ring);
+
+   if ((ring == NULL) || (ring->magic != LG_NOTIFY_RING_MAGIC))
+      PARAM_ERROR(LG_BAD_POINTER, "bad ring (*%p)", ring);
+
+   if (munmap(ring, xRingSize(ring->slots)) < 0)
+      PARAM_ERROR(LG_BAD_POINTER, "munmap failed (%m)");
+
+   return LG_OKAY;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifyRingRead(
+   lgNotifyRing_p ring, int count, lgGpioReport_t *reports, int timeout_ms)
+{
+   uint64_t head, tail;
+   uint32_t wake, mask;
+   struct timespec ts, *tsp;
+   int i, avail;
+
+   LG_DBG(LG_DEBUG_TRACE, "ring=*%p count=%d reports=*%p timeout=%d",
+      ring, count, reports, timeout_ms);
+
+   if ((ring == NULL) || (ring->magic != LG_NOTIFY_RING_MAGIC))
+      PARAM_ERROR(LG_BAD_POINTER, "bad ring (*%p)", ring);
+
+   if (count <= 0) return 0;
+
+   if (reports == NULL)
+      PARAM_ERROR(LG_BAD_POINTER, "reports=NULL");
+
+   tail = ring->tail;
+
+   head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+   if ((head == tail) && timeout_ms)
+   {
+      /*
+         Announce the wait and recheck head so a report written
+         between the checks either is seen here or wakes the futex.
+      */
+
+      wake = __atomic_load_n(&ring->wake, __ATOMIC_ACQUIRE);
+
+      __atomic_store_n(&ring->waiting, 1, __ATOMIC_SEQ_CST);
+
+      head = __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST);
+
+      if (head == tail)
+      {
+         if (timeout_ms > 0)
+         {
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+            tsp = &ts;
+         }
+         else tsp = NULL;
+
+         xFutex(&ring->wake, FUTEX_WAIT, wake, tsp);
+
+         head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+      }
+
+      __atomic_store_n(&ring->waiting, 0, __ATOMIC_RELAXED);
+   }
+
+   avail = head - tail;
+
+   if (avail > count) avail = count;
+
+   mask = ring->slots - 1;
+
+   for (i=0; i<avail; i++) reports[i] = ring->report[(tail+i) & mask];
+
+   __atomic_store_n(&ring->tail, tail+avail, __ATOMIC_RELEASE);
+
+   return avail;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifyOpenCapture(const char *path, int maxReports)
+{
+   lgNotify_t *h;
+   lgCaptureHeader_p capture;
+   int fd;
+   int handle;
+
+   LG_DBG(LG_DEBUG_TRACE, "path=%s maxReports=%d", path, maxReports);
+
+   if ((maxReports < 1) || (maxReports > LG_MAX_CAPTURE_REPORTS))
+      PARAM_ERROR(LG_BAD_CAPTURE, "bad maxReports (%d)", maxReports);
+
+   capture = lgCaptureCreate(path, maxReports, &fd);
+
+   if (capture == NULL) PARAM_ERROR(LG_FILE_OPEN_FAILED, "can't create %s", path);
+
+   handle = xNotifyAlloc(&h);
+
+   if (handle < 0)
+   {
+      lgCaptureClose(capture);
+      close(fd);
+      return LG_NO_MEMORY;
+   }
+
+   h->fd = fd;
+   h->capture = capture;
+   h->pipe_number = 0;
+   h->max_emits = MAX_EMITS;
+   h->state = LG_NOTIFY_RUNNING;
+
+   return handle;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgNotifyRingWrite(lgNotify_t *h, lgGpioReport_t *reports, int count)
+{
+   /*
+      The ring is shared with the reader, which may be another process,
+      so only h->ringSlots is trusted for its size.
+   */
+
+   lgNotifyRing_p ring = h->ring;
+   uint64_t head, tail, space;
+   uint32_t mask;
+   int i;
+
+   head = ring->head;
+
+   tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+   /* a tail beyond head or slots is a misbehaving reader */
+
+   if ((tail > head) || ((head - tail) > h->ringSlots)) space = 0;
+   else space = h->ringSlots - (head - tail);
+
+   if (count > space)
+   {
+      ring->dropped += count - space;
+      count = space;
+   }
+
+   mask = h->ringSlots - 1;
+
+   for (i=0; i<count; i++) ring->report[(head+i) & mask] = reports[i];
+
+   __atomic_store_n(&ring->head, head+count, __ATOMIC_SEQ_CST);
+
+   if (__atomic_load_n(&ring->waiting, __ATOMIC_SEQ_CST))
+   {
+      __atomic_add_fetch(&ring->wake, 1, __ATOMIC_RELEASE);
+      xFutex(&ring->wake, FUTEX_WAKE, INT_MAX, NULL);
+   }
+
+   return count;
+}
 
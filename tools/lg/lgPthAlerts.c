@@ -33,6 +33,7 @@ For more information, please refer to <http://unlicense.org/>
 #include <unistd.h>
 #include <string.h>
 #include <poll.h>
+#include <sys/eventfd.h>
 
 #include "lgDbg.h"
 #include "lgHdl.h"
@@ -41,28 +42,108 @@ For more information, please refer to <http://unlicense.org/>
 
 #define LG_MAX_ALERTS 2000
 #define LG_GPIO_MAX_ALERTS_PER_READ 128
+#define LG_MAX_POLL_FDS 64
+#define LG_MAX_INFO_CHANGES_PER_READ 16
+#define LG_NFY_DISPATCH_MIN 32
+#define LG_ALERTS_QUEUE_BATCH 64
 
 pthread_t pthAlert;
 pthread_mutex_t lgAlertMutex = PTHREAD_MUTEX_INITIALIZER;
 volatile lgAlertRec_p alertRec = NULL;
+static lgChipObj_p watchChip = NULL; /* chips with line info watches */
 pthread_mutex_t lgAlertCondMutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t lgAlertCond = PTHREAD_COND_INITIALIZER;
 int pthAlertRunning = LG_THREAD_NONE;
 
+/*
+   pthAlertEpoch is bumped (under lgAlertMutex) each time the alert
+   thread starts a new pass, i.e. once it has finished with the
+   records it polled on the previous pass.  pthAlertBusy is set while
+   it holds such records.
+*/
+static uint64_t pthAlertEpoch = 0;
+static int pthAlertBusy = 0;
+static pthread_cond_t lgAlertEpochCond = PTHREAD_COND_INITIALIZER;
+
 lgGpioAlert_t aBuf[LG_MAX_ALERTS];
 
+/*
+   Notification dispatch table, indexed by notify handle and grown as
+   larger handles are seen.  Only used by the alert thread.
+*/
+typedef struct
+{
+   int first; /* first aBuf index for the handle, -1 if none */
+   int last;  /* last aBuf index for the handle */
+} lgNfyDispatch_t;
+
+static lgNfyDispatch_t *nfyDispatch = NULL;
+static int nfyDispatchSize = 0;
+static int nfyNext[LG_MAX_ALERTS];   /* next aBuf index, same handle */
+static int nfyActive[LG_MAX_ALERTS]; /* handles with reports pending */
+
+/*
+   Optional queue of callbacks for lgGpioDispatchAlerts.  The alert
+   thread is the only producer.  One thread dispatches at a time, it
+   records the queue it is reading in dispatchQueue (under
+   alertQueueMutex) and calls the callbacks without the mutex.  A
+   queue is not freed while it is being dispatched.
+*/
+typedef struct
+{
+   callbk_t func;
+   void *userdata;
+   lgGpioAlert_t alert;
+} lgAlertQueueEntry_t;
+
+typedef struct
+{
+   uint64_t head;    /* next entry to write, alert thread only */
+   uint8_t  pad1[56];
+   uint64_t tail;    /* next entry to read, dispatcher only */
+   uint8_t  pad2[56];
+   uint32_t slots;
+   int      full;    /* discarding alerts, alert thread only */
+   uint64_t dropped; /* alerts discarded, alert thread only */
+   lgAlertQueueEntry_t entry[];
+} lgAlertQueue_t;
+
+static lgAlertQueue_t *alertQueue = NULL; /* set under both mutexes */
+static lgAlertQueue_t *passQueue = NULL;  /* alertQueue for this pass */
+static int passQueued = 0;                /* alerts queued this pass */
+static int alertQueueFd = -1;             /* eventfd for the dispatcher */
+static pthread_mutex_t alertQueueMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t alertQueueCond = PTHREAD_COND_INITIALIZER;
+static lgAlertQueue_t *dispatchQueue = NULL; /* queue being dispatched */
+static pthread_t dispatchThread;             /* valid if dispatchQueue */
+
+static int pthAlertWake = 0; /* signal pending, protected by cond mutex */
+static int pthAlertWakeFd = -1; /* wakes the thread from ppoll */
+
 static void xWaitForSignal(pthread_cond_t *cond, pthread_mutex_t *mutex)
 {
    pthread_mutex_lock(mutex);
-   pthread_cond_wait(cond, mutex);
+   while (!pthAlertWake) pthread_cond_wait(cond, mutex);
+   pthAlertWake = 0;
    pthread_mutex_unlock(mutex);
 }
 
 void xSendUnwaitSignal(pthread_cond_t *cond, pthread_mutex_t *mutex)
 {
+   uint64_t wake = 1;
+
    pthread_mutex_lock(mutex);
+   pthAlertWake = 1;
    pthread_cond_signal(cond);
    pthread_mutex_unlock(mutex);
+
+   if (pthAlertWakeFd >= 0)
+   {
+      if (write(pthAlertWakeFd, &wake, sizeof(wake)) < 0)
+      {
+         /* counter already pending, nothing to do */
+      }
+   }
 }
 
 int tscomp(const void *p1, const void *p2)
@@ -82,42 +163,145 @@ uint64_t xMonotonicTimestamp(void)
    return ((uint64_t)1E9 * xts.tv_sec) + xts.tv_nsec;
 }
 
+static void xAlertsCall(
+   callbk_t func, int count, lgGpioAlert_p alerts, void *userdata)
+{
+   lgAlertQueue_t *q = passQueue;
+   lgAlertQueueEntry_t *e;
+   uint64_t head, room;
+   int i;
+
+   if (q == NULL)
+   {
+      (func)(count, alerts, userdata);
+      return;
+   }
+
+   head = q->head;
+   room = q->slots - (head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE));
+
+   if (count > room)
+   {
+      if (!q->full)
+         LG_DBG(LG_DEBUG_ALWAYS, "alerts queue full, discarding alerts");
+
+      q->full = 1;
+      q->dropped += count - room;
+      count = room;
+   }
+   else q->full = 0;
+
+   for (i=0; i<count; i++, head++)
+   {
+      e = &q->entry[head & (q->slots-1)];
+
+      e->func = func;
+      e->userdata = userdata;
+      e->alert = alerts[i];
+   }
+
+   __atomic_store_n(&q->head, head, __ATOMIC_RELEASE);
+
+   if (count) passQueued = 1;
+}
+
+static void xAlertsSignal(void)
+{
+   uint64_t wake = 1;
+
+   /* one wakeup per pass however many callbacks were queued */
+
+   if (passQueued)
+   {
+      passQueued = 0;
+
+      if (write(alertQueueFd, &wake, sizeof(wake)) < 0)
+      {
+         /* counter already pending, nothing to do */
+      }
+   }
+}
+
+static int xNfyDispatchGrow(int handle)
+{
+   int i, size;
+   lgNfyDispatch_t *dispatch;
+
+   size = nfyDispatchSize ? nfyDispatchSize : LG_NFY_DISPATCH_MIN;
+
+   while (size <= handle) size *= 2;
+
+   dispatch = realloc(nfyDispatch, size * sizeof(lgNfyDispatch_t));
+
+   if (dispatch == NULL)
+   {
+      LG_DBG(LG_DEBUG_ALWAYS, "can't grow dispatch to %d handles", size);
+      return LG_NO_MEMORY;
+   }
+
+   for (i=nfyDispatchSize; i<size; i++) dispatch[i].first = -1;
+
+   nfyDispatch = dispatch;
+   nfyDispatchSize = size;
+
+   return LG_OKAY;
+}
+
 void emitNotifications(int count)
 {
-   static int maxHandles = 20;
-   static int *handles = NULL;
    lgGpioReport_t report[LG_MAX_ALERTS];
-   int numHandles;
+   int numActive;
+   int handle;
    int i;
    int status;
    lgNotify_t *h;
    int emit;
    int d;
-   int sent;
-   int max_emits;
-   int err;
 
-   if (handles == NULL) handles = malloc(sizeof(int) * maxHandles);
+   /*
+      Chain the reports for each notify handle so that only the
+      handles with something to send are visited.
+   */
 
-   numHandles = lgHdlGetHandlesForType(
-      LG_HDL_TYPE_NOTIFY, handles, maxHandles);
-   
-   if (numHandles > maxHandles)
+   numActive = 0;
+
+   for (d=0; d<count; d++)
    {
-      LG_DBG(LG_DEBUG_ALWAYS, "too many notifications");
-      numHandles = maxHandles;
+      handle = aBuf[d].nfyHandle;
+
+      if (handle < 0) continue;
+
+      if ((handle >= nfyDispatchSize) && (xNfyDispatchGrow(handle) < 0))
+         continue;
+
+      nfyNext[d] = -1;
+
+      if (nfyDispatch[handle].first < 0)
+      {
+         nfyDispatch[handle].first = d;
+         nfyActive[numActive++] = handle;
+      }
+      else nfyNext[nfyDispatch[handle].last] = d;
+
+      nfyDispatch[handle].last = d;
    }
 
-   for (i=0; i<numHandles; i++)
+   for (i=0; i<numActive; i++)
    {
+      handle = nfyActive[i];
+
+      d = nfyDispatch[handle].first;
+
+      nfyDispatch[handle].first = -1;
+
       status = lgHdlGetLockedObjTrusted(
-         handles[i], LG_HDL_TYPE_NOTIFY, (void **)&h);
+         handle, LG_HDL_TYPE_NOTIFY, (void **)&h);
       
       if (status < 0) continue;
 
       if (h->state == LG_NOTIFY_CLOSING)
       {
-         lgHdlFree(handles[i], LG_HDL_TYPE_NOTIFY);
+         lgHdlFree(handle, LG_HDL_TYPE_NOTIFY);
       }
       else if (h->state >= LG_NOTIFY_RUNNING)
       {
@@ -125,108 +309,25 @@ void emitNotifications(int count)
 
          if (h->state == LG_NOTIFY_RUNNING)
          {
-            for (d=0; d<count; d++)
+            for (; d>=0; d=nfyNext[d])
             {
-               /* is this for this notify handle? */
-               if (handles[i] == aBuf[d].nfyHandle)
-               {
-                  report[emit] = aBuf[d].report;
-                  emit++;
-               }
+               if (lgNotifyWanted(h, &aBuf[d].report))
+                  report[emit++] = aBuf[d].report;
             }
          }
 
-         if (emit)
-         {
-            max_emits = h->max_emits;
-
-            sent = 0;
+         if (emit) lgNotifyWrite(h, report, emit);
 
-            while (emit > 0)
-            {
-               if (emit > max_emits)
-               {
-                  err = write(h->fd,
-                           report+sent,
-                           max_emits*sizeof(lgGpioReport_t));
-
-                  if (err != (max_emits*sizeof(lgGpioReport_t)))
-                  {
-                     if (err < 0)
-                     {
-                        if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
-                        {
-                           /* serious error, no point continuing */
-
-                           LG_DBG(LG_DEBUG_ALWAYS, "fd=%d err=%d errno=%d",
-                              h->fd, err, errno);
-
-                           LG_DBG(LG_DEBUG_ALWAYS, "%s", strerror(errno));
-
-                           h->state = LG_NOTIFY_CLOSING;
-                           break;
-                        }
-                        //else gpioStats.wouldBlockPipeWrite++;
-                     }
-                     else
-                     {
-                        //gpioStats.shortPipeWrite++;
-                        LG_DBG(LG_DEBUG_ALWAYS, "sent %zd, asked for %d",
-                           err/sizeof(lgGpioReport_t), max_emits);
-                     }
-                  }
-                  else
-                  {
-                     //gpioStats.goodPipeWrite++;
-                  }
-
-                  sent += max_emits;
-                  emit    -= max_emits;
-               }
-               else
-               {
-                  err = write(h->fd,
-                           report+sent,
-                           emit*sizeof(lgGpioReport_t));
-
-                  if (err != (emit*sizeof(lgGpioReport_t)))
-                  {
-                     if (err < 0)
-                     {
-                        if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
-                        {
-                           LG_DBG(LG_DEBUG_ALWAYS, "fd=%d err=%d errno=%d",
-                              h->fd, err, errno);
-
-                           LG_DBG(LG_DEBUG_ALWAYS, "%s", strerror(errno));
-
-                           /* serious error, no point continuing */
-                           h->state = LG_NOTIFY_CLOSING;
-                           break;
-                        }
-                        //else gpioStats.wouldBlockPipeWrite++;
-                     }
-                     else
-                     {
-                        //gpioStats.shortPipeWrite++;
-                        LG_DBG(LG_DEBUG_ALWAYS, "sent %zd, asked for %d",
-                           err/sizeof(lgGpioReport_t), emit);
-                     }
-                  }
-                  else
-                  {
-                     //gpioStats.goodPipeWrite++;
-                  }
-
-                  sent += emit;
-                  emit = 0;
-               }
-            }
-         }
+         /* a write failed, nothing more will be delivered */
+         if (h->state == LG_NOTIFY_CLOSING)
+            lgHdlFree(handle, LG_HDL_TYPE_NOTIFY);
       }
 
-      lgHdlUnlock(handles[i]);
+      lgHdlUnlock(handle);
    }
+
+   /* handles which failed elsewhere and had no reports this pass */
+   lgNotifyReapClosing();
 }
 
 int emit(int count, uint64_t tmax)
@@ -239,10 +340,12 @@ int emit(int count, uint64_t tmax)
    }
  
    if (lgGpioSamplesFunc)
-      (lgGpioSamplesFunc)(i, aBuf, lgGpioSamplesUserdata);
+      xAlertsCall(lgGpioSamplesFunc, i, aBuf, lgGpioSamplesUserdata);
    
    emitNotifications(i);
 
+   xAlertsSignal();
+
    return i;
 }
 
@@ -423,6 +526,9 @@ void *lgPthAlert(void)
    lgAlertRec_p p, t;
    int i, e;
    int num_gpio;
+   int num_fds;
+   int num_poll;
+   int nfyHandle;
    int gpiobasecount;
    int retval;
    int count=0;
@@ -432,189 +538,270 @@ void *lgPthAlert(void)
    uint64_t lastLT=0;
    uint64_t nowLT;
    uint64_t nowGT;
-   struct pollfd pfd[64];
-   lgAlertRec_p pAlertRec[64];
+   lgChipObj_p c;
+   uint64_t wakes;
+   struct pollfd pfd[LG_MAX_POLL_FDS];
+   lgAlertRec_p pAlertRec[LG_MAX_POLL_FDS];
+   lgChipObj_p pWatchChip[LG_MAX_POLL_FDS];
    struct gpio_v2_line_event eIn[LG_GPIO_MAX_ALERTS_PER_READ];
+   struct gpio_v2_line_info_changed cIn[LG_MAX_INFO_CHANGES_PER_READ];
    struct timespec tspec = {0, 5e5}; /* 0.5 ms timeout */
 
    while (1)
    {
       pthread_mutex_lock(&lgAlertMutex);
 
-      if (alertRec != NULL)
-      {
-         p = alertRec;
-         i = 0;
+      pthAlertEpoch++;
+      pthAlertBusy = 0;
+      pthread_cond_broadcast(&lgAlertEpochCond);
+
+      passQueue = alertQueue;
 
-         /* poll active alerts */
+      p = alertRec;
+      i = 0;
 
-         while (p != NULL)
+      /* poll active alerts */
+
+      while (p != NULL)
+      {
+         t = p->next;
+
+         if (p->active)
          {
-            if (p->active)
+            if (i < LG_MAX_POLL_FDS-1)
             {
                pfd[i].fd= p->state->fd;
                pfd[i].events = POLLIN|POLLPRI;
                pAlertRec[i] = p;
                i++;
             }
-            else
-            {
-               /* delete inactive record */
-
-               if (p->prev) p->prev->next = p->next;
-               else alertRec = p->next;
+         }
+         else
+         {
+            /* delete inactive record */
 
-               if (p->next) p->next->prev = p->prev;
+            if (p->prev) p->prev->next = p->next;
+            else alertRec = p->next;
 
-               t = p; p = p->prev; free(t);
-            }
+            if (p->next) p->next->prev = p->prev;
 
-            if (p) p = p->next;
+            free(p);
          }
 
-         num_gpio = i;
+         p = t;
+      }
 
-         pthread_mutex_unlock(&lgAlertMutex);
+      num_gpio = i;
 
-         if (num_gpio > 0)
-         {
-            retval = ppoll(pfd, num_gpio, &tspec, NULL);
+      /* poll chips for line info changes */
 
-            nowLT = xMonotonicTimestamp();
+      for (c=watchChip; (c!=NULL) && (i<LG_MAX_POLL_FDS-1); c=c->watchNext)
+      {
+         pfd[i].fd = c->fd;
+         pfd[i].events = POLLIN;
+         pWatchChip[i] = c;
+         i++;
+      }
 
-            for (i=0; i<num_gpio; i++)
-            {
-               gpiobasecount = count;
+      num_fds = i;
 
-               p = pAlertRec[i];
+      pthAlertBusy = (num_fds > 0);
 
-               if ((retval > 0) && (pfd[i].revents))
-               {
-                  /* GPIO changed during ppoll */
+      pthread_mutex_unlock(&lgAlertMutex);
 
-                  bytes = read(pfd[i].fd, &eIn, sizeof(eIn));
+      if (num_fds > 0)
+      {
+         num_poll = num_fds;
 
-                  if (bytes > 0)
-                  {
-                     e = 0;
+         if (pthAlertWakeFd >= 0)
+         {
+            pfd[num_poll].fd = pthAlertWakeFd;
+            pfd[num_poll].events = POLLIN;
+            num_poll++;
+         }
 
-                     while (bytes >= sizeof(eIn[0]))
-                     {
-                        /* debounce and watchdog */
-                        xDebWatEvt(p, eIn[e].timestamp_ns, &count, &eIn[e]);
+         /*
+            Only line info changes to wait for, block until one
+            arrives or the thread is signalled.
+         */
 
-                        bytes -= sizeof(eIn[0]);
+         if (num_gpio || count || (pthAlertWakeFd < 0))
+            retval = ppoll(pfd, num_poll, &tspec, NULL);
+         else
+            retval = ppoll(pfd, num_poll, NULL, NULL);
 
-                        e++;
-                     }
+         nowLT = xMonotonicTimestamp();
 
-                     if (e)
-                     {
-                        p->last_rpt_ts = eIn[e-1].timestamp_ns;
+         if ((retval > 0) && (num_poll > num_fds) && pfd[num_fds].revents)
+         {
+            if (read(pthAlertWakeFd, &wakes, sizeof(wakes)) < 0)
+            {
+               /* already drained */
+            }
+         }
 
-                        if (eIn[e-1].timestamp_ns > lastGT)
-                        {
-                           lastGT = eIn[e-1].timestamp_ns;
-                           lastLT = nowLT;
-                        }
-                     }
+         for (i=num_gpio; i<num_fds; i++)
+         {
+            if ((retval > 0) && (pfd[i].revents))
+            {
+               c = pWatchChip[i];
 
-                     if (bytes)
-                     {
-                        if (p->active)
-                           LG_DBG(LG_DEBUG_ALWAYS, "bytes left=%d (%s)",
-                              bytes, strerror(errno));
-                     }
-                  }
-                  else
+               bytes = read(pfd[i].fd, &cIn, sizeof(cIn));
+
+               for (e=0; bytes>=(int)sizeof(cIn[0]); e++)
+               {
+                  bytes -= sizeof(cIn[0]);
+
+                  if (!xLineInfoChanged(c, &cIn[e], &nfyHandle)) continue;
+
+                  if ((count+1) >= LG_MAX_ALERTS)
                   {
-                     if (p->active)
-                        LG_DBG(LG_DEBUG_ALWAYS, "read error %d (%s)",
-                           errno, strerror(errno));
+                     LG_DBG(LG_DEBUG_ALWAYS, "more than %d alerts",
+                        LG_MAX_ALERTS);
+                     continue;
                   }
-               }
 
-               if (gpiobasecount < count)
-               {
-                  if (p->state->alertFunc)
+                  aBuf[count].report.timestamp = cIn[e].timestamp_ns;
+                  aBuf[count].report.chip = c->gpiochip;
+                  aBuf[count].report.gpio = cIn[e].info.offset;
+                  aBuf[count].report.level = cIn[e].event_type;
+                  aBuf[count].report.flags = LG_REPORT_LINE_INFO;
+                  aBuf[count].nfyHandle = nfyHandle;
+
+                  if (c->LineCfg[cIn[e].info.offset].alertFunc)
                   {
-                     (p->state->alertFunc)(count-gpiobasecount,
-                        &aBuf[gpiobasecount], p->state->userdata);
+                     xAlertsCall(c->LineCfg[cIn[e].info.offset].alertFunc,
+                        1, &aBuf[count],
+                        c->LineCfg[cIn[e].info.offset].userdata);
                   }
+
+                  count++;
                }
             }
+         }
 
-            nowGT = lastGT + (nowLT - lastLT);
+         for (i=0; i<num_gpio; i++)
+         {
+            gpiobasecount = count;
 
-            // LG_DBG(LG_DEBUG_ALWAYS, "ts=%"PRIu64"", nowGT/100000);
+            p = pAlertRec[i];
 
-            if (lastGT)
+            if ((retval > 0) && (pfd[i].revents))
             {
-               for (i=0; i<num_gpio; i++)
+               /* GPIO changed during ppoll */
+
+               bytes = read(pfd[i].fd, &eIn, sizeof(eIn));
+
+               if (bytes > 0)
                {
-                  gpiobasecount = count;
+                  e = 0;
 
-                  p = pAlertRec[i];
+                  while (bytes >= sizeof(eIn[0]))
+                  {
+                     /* debounce and watchdog */
+                     xDebWatEvt(p, eIn[e].timestamp_ns, &count, &eIn[e]);
 
-                  // The 50 microsecond leeway is to make sure the
-                  // kernel has supplied current data for all GPIO
-                  // before timing out debounce and watchdogs.
-                  xDebWatEvt(p, nowGT-50000, &count, NULL);
+                     bytes -= sizeof(eIn[0]);
+
+                     e++;
+                  }
 
-                  if (gpiobasecount < count)
+                  if (e)
                   {
-                     if (p->state->alertFunc)
+                     p->last_rpt_ts = eIn[e-1].timestamp_ns;
+
+                     if (eIn[e-1].timestamp_ns > lastGT)
                      {
-                        (p->state->alertFunc)(count-gpiobasecount,
-                           &aBuf[gpiobasecount], p->state->userdata);
+                        lastGT = eIn[e-1].timestamp_ns;
+                        lastLT = nowLT;
                      }
                   }
+
+                  if (bytes)
+                  {
+                     if (p->active)
+                        LG_DBG(LG_DEBUG_ALWAYS, "bytes left=%d (%s)",
+                           bytes, strerror(errno));
+                  }
+               }
+               else
+               {
+                  if (p->active)
+                     LG_DBG(LG_DEBUG_ALWAYS, "read error %d (%s)",
+                        errno, strerror(errno));
                }
             }
 
-            if (count > 1)
+            if (gpiobasecount < count)
             {
-               /*
-               LG_DBG(LG_DEBUG_ALWAYS, "nowGT=%"PRIu64" count=%d",
-                  nowGT/100000, count);
-               */
-               // printbuf(count, "pre qsort");
-               qsort(aBuf, count, sizeof(aBuf[0]), tscomp);
-               //lgcheck(count, "check post qsort");
-               // printbuf(count, "post qsort");
+               if (p->cfg->alertFunc)
+               {
+                  xAlertsCall(p->cfg->alertFunc, count-gpiobasecount,
+                     &aBuf[gpiobasecount], p->cfg->userdata);
+               }
             }
+         }
 
-            /* emit any due alerts */
+         nowGT = lastGT + (nowLT - lastLT);
 
-            // printbuf(count, "pre emit");
-            // delay 500 microseconds before reporting a GPIO
-            // to make sure the events are sorted in time order.
-            sent = emit(count, nowGT-500000);
+         // LG_DBG(LG_DEBUG_ALWAYS, "ts=%"PRIu64"", nowGT/100000);
 
-            if (sent)
+         if (lastGT)
+         {
+            for (i=0; i<num_gpio; i++)
             {
-               if (sent != count)
+               gpiobasecount = count;
+
+               p = pAlertRec[i];
+
+               // The 50 microsecond leeway is to make sure the
+               // kernel has supplied current data for all GPIO
+               // before timing out debounce and watchdogs.
+               xDebWatEvt(p, nowGT-50000, &count, NULL);
+
+               if (gpiobasecount < count)
                {
-                  /* shuffle entries down */
-                  memmove(aBuf, aBuf+sent, sizeof(aBuf[0])*(count-sent));
+                  if (p->cfg->alertFunc)
+                  {
+                     xAlertsCall(p->cfg->alertFunc, count-gpiobasecount,
+                        &aBuf[gpiobasecount], p->cfg->userdata);
+                  }
                }
-               count -= sent;
             }
-            //printbuf(count, "post emit");
          }
-         else /* no active alerts */
+
+         if (count > 1)
          {
-            emit(count, -1); /* empty the buffer */
-            count = 0;
-            lastGT = 0;
+            /*
+            LG_DBG(LG_DEBUG_ALWAYS, "nowGT=%"PRIu64" count=%d",
+               nowGT/100000, count);
+            */
+            // printbuf(count, "pre qsort");
+            qsort(aBuf, count, sizeof(aBuf[0]), tscomp);
+            //lgcheck(count, "check post qsort");
+            // printbuf(count, "post qsort");
+         }
+
+         /* emit any due alerts */
+
+         // printbuf(count, "pre emit");
+         // delay 500 microseconds before reporting a GPIO
+         // to make sure the events are sorted in time order.
+         sent = emit(count, nowGT-500000);
 
-            xWaitForSignal(&lgAlertCond, &lgAlertCondMutex);
+         if (sent)
+         {
+            if (sent != count)
+            {
+               /* shuffle entries down */
+               memmove(aBuf, aBuf+sent, sizeof(aBuf[0])*(count-sent));
+            }
+            count -= sent;
          }
+         //printbuf(count, "post emit");
       }
-      else /* no alerts */
+      else /* nothing to poll */
       {
-         pthread_mutex_unlock(&lgAlertMutex);
-
          emit(count, -1); /* empty the buffer */
          count = 0;
          lastGT = 0;
@@ -628,10 +815,18 @@ void *lgPthAlert(void)
    pthread_exit(NULL);
 }
 
+void lgPthAlertWake(void)
+{
+   xSendUnwaitSignal(&lgAlertCond, &lgAlertCondMutex);
+}
+
 void lgPthAlertStart(void)
 {
    if (!pthAlertRunning)
    {
+      if (pthAlertWakeFd < 0)
+         pthAlertWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
       if (pthread_create(&pthAlert, NULL, (void*)lgPthAlert, NULL) == 0)
       {
          pthread_detach(pthAlert);
@@ -640,18 +835,81 @@ void lgPthAlertStart(void)
    }
 }
 
+void lgPthAlertWatchChip(lgChipObj_p chip)
+{
+   pthread_mutex_lock(&lgAlertMutex);
+
+   chip->watchNext = watchChip;
+   watchChip = chip;
+
+   pthread_mutex_unlock(&lgAlertMutex);
+
+   xSendUnwaitSignal(&lgAlertCond, &lgAlertCondMutex);
+}
+
+static void xAlertQuiesce(uint64_t epoch)
+{
+   /*
+      Waits for the alert thread to start the pass after epoch.  There
+      is no time limit, the caller is about to free something the
+      alert thread may be using (a slow alerts callback makes for a
+      long pass).
+   */
+
+   if (!pthAlertRunning || pthread_equal(pthread_self(), pthAlert))
+      return;
+
+   pthread_mutex_lock(&lgAlertMutex);
+
+   while (pthAlertEpoch == epoch)
+      pthread_cond_wait(&lgAlertEpochCond, &lgAlertMutex);
+
+   pthread_mutex_unlock(&lgAlertMutex);
+}
+
 void lgPthAlertStop(lgChipObj_p chip)
 {
    lgAlertRec_p evt;
+   lgChipObj_p *pp;
+   uint64_t epoch;
+   int busy;
 
    /* stop any alert reads on chip */
-   
+
+   pthread_mutex_lock(&lgAlertMutex);
+
    for (evt=alertRec; evt!=NULL; evt=evt->next)
    {
       if (chip->handle == evt->chip->handle) evt->active =0;
    }
 
+   /* stop any line info reads on chip */
+
+   for (pp=&watchChip; *pp!=NULL; pp=&(*pp)->watchNext)
+   {
+      if (*pp == chip)
+      {
+         *pp = chip->watchNext;
+         chip->watchNext = NULL;
+         break;
+      }
+   }
+
+   epoch = pthAlertEpoch;
+   busy = pthAlertBusy;
+
+   pthread_mutex_unlock(&lgAlertMutex);
+
    xSendUnwaitSignal(&lgAlertCond, &lgAlertCondMutex);
+
+   /*
+      If the alert thread is part way through a pass it may still be
+      using records for this chip.  Wait for it to start its next pass,
+      at which point it will have dropped them.  Don't wait if called
+      from the alert thread itself (e.g. from an alerts callback).
+   */
+
+   if (busy) xAlertQuiesce(epoch);
 }
 
 lgAlertRec_p lgGpioGetAlertRec(lgChipObj_p chip, int gpio)
@@ -663,8 +921,7 @@ lgAlertRec_p lgGpioGetAlertRec(lgChipObj_p chip, int gpio)
    return p;
 }
 
-lgAlertRec_p lgGpioCreateAlertRec(
-   lgChipObj_p chip, int gpio, lgLineInf_p state, int nfyHandle)
+lgAlertRec_p lgGpioCreateAlertRec(lgChipObj_p chip, int gpio, int nfyHandle)
 {
    lgAlertRec_p p;
 
@@ -674,15 +931,16 @@ lgAlertRec_p lgGpioCreateAlertRec(
    {
       p->chip = chip;
       p->gpio = gpio;
-      p->state = state;
+      p->state = &chip->LineInf[gpio];
+      p->cfg = &chip->LineCfg[gpio];
       p->nfyHandle = nfyHandle;
       p->active = 1;
       p->debounced = 1;
       p->watchdogd = 1;
       p->last_rpt_lv = -1; /* impossible level */
-      p->debounce_nanos = state->debounce_us * 1e3;
-      p->watchdog_nanos = state->watchdog_us * 1e3;
-      p->eFlags = state->eFlags;
+      p->debounce_nanos = p->cfg->debounce_us * 1e3;
+      p->watchdog_nanos = p->cfg->watchdog_us * 1e3;
+      p->eFlags = p->cfg->eFlags;
       pthread_mutex_lock(&lgAlertMutex);
 
       p->prev = NULL;
@@ -698,3 +956,171 @@ lgAlertRec_p lgGpioCreateAlertRec(
 }
 
 
+
+int lgGpioSetAlertsQueue(int slots)
+{
+   lgAlertQueue_t *q = NULL;
+   lgAlertQueue_t *old;
+   uint64_t epoch;
+
+   LG_DBG(LG_DEBUG_TRACE, "slots=%d", slots);
+
+   if (slots &&
+       ((slots < LG_MIN_ALERTS_QUEUE_SLOTS) ||
+        (slots > LG_MAX_ALERTS_QUEUE_SLOTS) ||
+        (slots & (slots-1))))
+      PARAM_ERROR(LG_BAD_ALERTS_QUEUE, "bad slots (%d)", slots);
+
+   if (slots)
+   {
+      q = calloc(1, sizeof(lgAlertQueue_t) +
+         (slots * sizeof(lgAlertQueueEntry_t)));
+
+      if (q == NULL) PARAM_ERROR(LG_NO_MEMORY, "can't queue %d alerts", slots);
+
+      q->slots = slots;
+   }
+
+   pthread_mutex_lock(&alertQueueMutex);
+
+   if (q && (alertQueueFd < 0))
+   {
+      alertQueueFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+      if (alertQueueFd < 0)
+      {
+         pthread_mutex_unlock(&alertQueueMutex);
+         free(q);
+         PARAM_ERROR(LG_NO_MEMORY, "eventfd failed (%m)");
+      }
+   }
+
+   pthread_mutex_lock(&lgAlertMutex);
+
+   old = alertQueue;
+   alertQueue = q;
+   epoch = pthAlertEpoch;
+
+   /* no alert thread pass to wait for */
+   if (!pthAlertRunning || pthread_equal(pthread_self(), pthAlert))
+      passQueue = q;
+
+   pthread_mutex_unlock(&lgAlertMutex);
+
+   /* the alert thread may be queueing to the old queue */
+
+   if (old)
+   {
+      xSendUnwaitSignal(&lgAlertCond, &lgAlertCondMutex);
+
+      /*
+         A dispatcher in another thread may be in a callback, it
+         stops using the old queue when it returns.  A callback which
+         replaces its own queue is safe as the dispatcher checks for
+         that before touching the queue again.
+      */
+
+      while ((dispatchQueue == old) &&
+             !pthread_equal(pthread_self(), dispatchThread))
+      {
+         pthread_cond_wait(&alertQueueCond, &alertQueueMutex);
+      }
+
+      xAlertQuiesce(epoch);
+
+      free(old);
+   }
+
+   pthread_mutex_unlock(&alertQueueMutex);
+
+   if (q) return alertQueueFd;
+
+   return LG_OKAY;
+}
+
+int lgGpioDispatchAlerts(void)
+{
+   lgAlertQueue_t *q;
+   lgAlertQueueEntry_t *e;
+   lgGpioAlert_t batch[LG_ALERTS_QUEUE_BATCH];
+   callbk_t func;
+   void *userdata;
+   uint64_t head, tail, wakes;
+   int n, count=0;
+
+   pthread_mutex_lock(&alertQueueMutex);
+
+   q = alertQueue;
+
+   if (q == NULL)
+   {
+      pthread_mutex_unlock(&alertQueueMutex);
+      PARAM_ERROR(LG_BAD_ALERTS_QUEUE, "alerts queue not started");
+   }
+
+   /*
+      Another thread (or a callback calling us) is already dispatching.
+      It rereads the queue head after every callback so it will also
+      dispatch anything queued so far.
+   */
+
+   if (dispatchQueue != NULL)
+   {
+      pthread_mutex_unlock(&alertQueueMutex);
+      return 0;
+   }
+
+   dispatchQueue = q;
+   dispatchThread = pthread_self();
+
+   /* clear the wakeup before looking so that none is lost */
+
+   if (read(alertQueueFd, &wakes, sizeof(wakes)) < 0)
+   {
+      /* nothing pending */
+   }
+
+   /* stop if a callback replaced the queue, it may have been freed */
+
+   while (alertQueue == q)
+   {
+      tail = q->tail;
+      head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+
+      if (tail == head) break;
+
+      /* pass consecutive alerts for the same callback as one batch */
+
+      e = &q->entry[tail & (q->slots-1)];
+
+      func = e->func;
+      userdata = e->userdata;
+
+      for (n=0; (tail != head) && (n < LG_ALERTS_QUEUE_BATCH); n++)
+      {
+         e = &q->entry[tail & (q->slots-1)];
+
+         if ((e->func != func) || (e->userdata != userdata)) break;
+
+         batch[n] = e->alert;
+         tail++;
+      }
+
+      __atomic_store_n(&q->tail, tail, __ATOMIC_RELEASE);
+
+      pthread_mutex_unlock(&alertQueueMutex);
+
+      (func)(n, batch, userdata);
+
+      pthread_mutex_lock(&alertQueueMutex);
+
+      count += n;
+   }
+
+   dispatchQueue = NULL;
+   pthread_cond_broadcast(&alertQueueCond);
+
+   pthread_mutex_unlock(&alertQueueMutex);
+
+   return count;
+}
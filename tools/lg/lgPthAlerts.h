@@ -47,6 +47,7 @@ typedef struct lgAlertRec_s
    int gpio;
    int nfyHandle;
    lgLineInf_p state;
+   lgLineCfg_p cfg;
    int active;
    lgChipObj_p chip;
    struct lgAlertRec_s *prev;
@@ -55,12 +56,13 @@ typedef struct lgAlertRec_s
 
 lgAlertRec_p lgGpioGetAlertRec(lgChipObj_p chip, int gpio);
 
-lgAlertRec_p lgGpioCreateAlertRec(
-   lgChipObj_p chip, int gpio, lgLineInf_p state, int nfyHandle);
+lgAlertRec_p lgGpioCreateAlertRec(lgChipObj_p chip, int gpio, int nfyHandle);
 
 void *lgPthAlert(void);
 void lgPthAlertStart(void);
 void lgPthAlertStop(lgChipObj_p chip);
+void lgPthAlertWake(void);
+void lgPthAlertWatchChip(lgChipObj_p chip);
 
 #endif
 
@@ -25,11 +25,20 @@ OTHER DEALINGS IN THE SOFTWARE.
 For more information, please refer to <http://unlicense.org/>
 */
 
+#define _GNU_SOURCE /* needed for accept4 */
+
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 
@@ -40,97 +49,623 @@ For more information, please refer to <http://unlicense.org/>
 #include "lgDbg.h"
 #include "lgHdl.h"
 
-static void *xSocketThreadHandler(void *fdC)
+/*
+   One thread multiplexes every connection with epoll and runs the
+   commands which return quickly.  Commands which may block (files,
+   shell, I2C, serial, SPI, delays, configuration) are passed with
+   their connection to a small pool of worker threads.
+
+   Connections are accepted by their own threads, one per listening
+   socket (rgpiod -a gives several TCP sockets sharing the port), so a
+   burst of reconnecting clients doesn't hold up established ones.
+
+   Connections are registered EPOLLONESHOT so that only one thread
+   at a time services a connection.  That thread re-arms it when done,
+   which keeps each client's commands and replies in order.
+
+   A client may send many commands without waiting for replies.  After
+   LG_CMD_RIDS each command and its reply carry a request id so that
+   the client can match them up.
+
+   Replies are gathered from the command buffer with sendmsg, and a
+   large file read is sent straight from the file with sendfile.  A
+   file reply the client can't take at once is resumed on EPOLLOUT.  LG_CMD_FRAME lets a client use frames larger than
+   CMD_MAX_EXTENSION for bulk transfers.
+*/
+
+#define LG_SOCK_WORKERS 4
+#define LG_SOCK_MAX_EVENTS 64
+#define LG_SOCK_BUF_MIN 256   /* initial size of a connection buffer */
+#define LG_SOCK_BUF_KEEP 4096 /* larger idle buffers are released */
+
+#define LG_SOCK_WANT_IN  0 /* wait for more commands */
+#define LG_SOCK_WANT_OUT 1 /* wait for the client to accept replies */
+#define LG_SOCK_WORKER   2 /* next command must be run by a worker */
+#define LG_SOCK_CLOSE    3 /* connection finished */
+
+typedef struct lgSockConn_s
 {
-   int sock = *(int*)fdC;
-   int opt;
-   lgCtx_p Ctx;
-   lgCmd_t cmdBuf[CMD_MAX_EXTENSION/sizeof(lgCmd_t)];
-   lgCmd_p cmdP=cmdBuf;
-   uint32_t *arg=(uint32_t*)&cmdP[1];
+   int sock;
+   int closing;
+   int rids;   /* commands carry request ids, see LG_CMD_RIDS */
+   int frame;  /* largest command or reply, see LG_CMD_FRAME */
+   lgCtx_p ctx;
+   char *in;   /* received bytes not yet executed */
+   int inSize;
+   int inLen;
+   char *out;  /* reply bytes not yet sent */
+   int outSize;
+   int outPos; /* start of the unsent bytes in out */
+   int outLen;
+   int fileFd; /* reply data still to be sent from this file, or -1 */
+   off_t fileOffset;
+   int fileLen;
+   struct lgSockConn_s *next; /* worker queue */
+} lgSockConn_t, *lgSockConn_p;
+
+static int sockEpoll = -1;
+
+static int sockListen[LG_MAX_LISTENERS + 1]; /* TCP then Unix domain */
+
+static lgSockConn_p sockJobHead = NULL;
+static lgSockConn_p sockJobTail = NULL;
+static pthread_mutex_t sockJobMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sockJobCond = PTHREAD_COND_INITIALIZER;
+
+static int xCmdMayBlock(int cmd)
+{
+   /* device I/O may wait on the bus or the other end */
+
+   if ((cmd >= LG_CMD_I2CO) && (cmd <= LG_CMD_I2CZ)) return 1;
+   if ((cmd >= LG_CMD_SERO) && (cmd <= LG_CMD_SERDA)) return 1;
+   if ((cmd >= LG_CMD_SPIO) && (cmd <= LG_CMD_SPIX)) return 1;
 
-   free(fdC);
+   switch (cmd)
+   {
+      case LG_CMD_FO:
+      case LG_CMD_FC:
+      case LG_CMD_FR:
+      case LG_CMD_FW:
+      case LG_CMD_FS:
+      case LG_CMD_FL:
+
+      /* may wait for the alert thread to finish a pass */
+      case LG_CMD_GC:
+      case LG_CMD_GSF:
+      case LG_CMD_GSGF:
+
+      /* may wait for a script or stream thread to stop */
+      case LG_CMD_PROCD:
+      case LG_CMD_PROCS:
+      case LG_CMD_STRC:
+      case LG_CMD_STRO:
+
+      case LG_CMD_MICS:
+      case LG_CMD_MILS:
+      case LG_CMD_SHELL:
+
+      /* read the configuration files */
+      case LG_CMD_USER:
+      case LG_CMD_PASSW:
+      case LG_CMD_LCFG:
+
+      /* may hold any of the above */
+      case LG_CMD_BATCH:
+
+         return 1;
+   }
 
-   Ctx = lgCtxGet();
+   return 0;
+}
 
-   if (!Ctx) return 0;
+static int xBufReserve(char **buf, int *size, int need)
+{
+   int newSize;
+   char *newBuf;
 
-   /* Disable the Nagle algorithm. */
-   opt = 1;
+   if (need <= *size) return 0;
 
-   setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char*)&opt, sizeof(int));
+   newSize = *size ? *size : LG_SOCK_BUF_MIN;
 
-   while (1)
+   while (newSize < need) newSize *= 2;
+
+   newBuf = realloc(*buf, newSize);
+
+   if (newBuf == NULL)
    {
-      if (recv(sock, cmdP, sizeof(lgCmd_t), MSG_WAITALL) !=
-         sizeof(lgCmd_t)) break;
+      LG_DBG(LG_DEBUG_ALWAYS, "no memory for %d bytes", newSize);
+      return -1;
+   }
 
-      LG_DBG(LG_DEBUG_INTERNAL, "magic=%d size=%d cmd=%d Q=%d I=%d H=%d",
-         cmdP->magic, cmdP->size, cmdP->cmd,
-         cmdP->doubles, cmdP->longs, cmdP->shorts);
+   *buf = newBuf;
+   *size = newSize;
+
+   return 0;
+}
+
+static void xBufRelease(char **buf, int *size)
+{
+   if (*size > LG_SOCK_BUF_KEEP)
+   {
+      free(*buf);
+      *buf = NULL;
+      *size = 0;
+   }
+}
+
+static int xConnSendFile(lgSockConn_p conn)
+{
+   /*
+      sendfile has no MSG_DONTWAIT so the socket is made non-blocking
+      while it runs.  The socket stays blocking otherwise as an in-band
+      notification shares its file status flags.
+   */
+
+   int flags;
+   ssize_t sent;
+   int status = LG_SOCK_WANT_IN;
+
+   flags = fcntl(conn->sock, F_GETFL);
+
+   fcntl(conn->sock, F_SETFL, flags | O_NONBLOCK);
+
+   while (conn->fileLen > 0)
+   {
+      sent = sendfile(conn->sock, conn->fileFd, &conn->fileOffset,
+         conn->fileLen);
+
+      if (sent > 0)
+      {
+         conn->fileLen -= sent;
+         continue;
+      }
 
-      if (cmdP->size)
+      if ((sent < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
       {
-         if (cmdP->size < (sizeof(cmdBuf)-sizeof(lgCmd_t)))
-         {
-            /* read extension into buf */
-            if (recv(sock, &cmdBuf[1], cmdP->size, MSG_WAITALL) != cmdP->size)
-            {
-               /* Serious error.  No point continuing. */
-
-               LG_DBG(LG_DEBUG_ALWAYS,
-                  "recv failed for %"PRId32" bytes, sock=%d",
-                  cmdP->size, sock);
-
-               break;
-            }
-         }
-         else
-         {
-            /* Serious error.  No point continuing. */
-
-            LG_DBG(LG_DEBUG_ALWAYS,
-               "message too large %"PRId32"(%zd), sock=%d",
-               cmdP->size, sizeof(cmdBuf)-sizeof(lgCmd_t), sock);
-
-            break;
-         }
+         status = LG_SOCK_WANT_OUT;
+         break;
       }
 
-      if (cmdP->cmd == LG_CMD_NOIB)
+      if ((sent < 0) && (errno == EINTR)) continue;
+
+      /* the file may have shrunk, the reply can't be completed */
+      LG_DBG(LG_DEBUG_ALWAYS, "sendfile failed (%m), sock=%d", conn->sock);
+      status = LG_SOCK_CLOSE;
+      break;
+   }
+
+   fcntl(conn->sock, F_SETFL, flags);
+
+   if (status != LG_SOCK_WANT_OUT)
+   {
+      close(conn->fileFd);
+      conn->fileFd = -1;
+   }
+
+   return status;
+}
+
+static int xConnFlush(lgSockConn_p conn)
+{
+   int sent, status;
+
+   while (conn->outLen)
+   {
+      sent = send(conn->sock, conn->out+conn->outPos, conn->outLen,
+         MSG_DONTWAIT | MSG_NOSIGNAL);
+
+      if (sent < 0)
       {
-        /* Enable the Nagle algorithm. */
-         opt = 0;
-         setsockopt(
-            sock, IPPROTO_TCP, TCP_NODELAY, (char*)&opt, sizeof(int));
+         if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            return LG_SOCK_WANT_OUT;
 
-         /* set sock as the argument */
-         arg[0] = sock;
+         if (errno == EINTR) continue;
+
+         return LG_SOCK_CLOSE;
       }
 
-      cmdP->status = lgExecCmd(cmdBuf, sizeof(cmdBuf));
+      conn->outPos += sent;
+      conn->outLen -= sent;
+   }
+
+   conn->outPos = 0;
 
-      LG_DBG(LG_DEBUG_INTERNAL, "status=%d size=%d cmd=%d Q=%d I=%d H=%d",
-         cmdP->status, cmdP->size, cmdP->cmd,
-         cmdP->doubles, cmdP->longs, cmdP->shorts);
+   xBufRelease(&conn->out, &conn->outSize);
 
-      if (write(sock, cmdBuf, sizeof(lgCmd_t)+cmdP->size)) ; /* ignore errors */
+   /* the data of a file reply follows its header */
 
-      LG_DBG(LG_DEBUG_INTERNAL, "ret=%s",
-         lgDbgStr2Hex(sizeof(lgCmd_t)+cmdP->size, (char *)&cmdBuf));
+   if (conn->fileFd >= 0)
+   {
+      status = xConnSendFile(conn);
+
+      if (status != LG_SOCK_WANT_IN) return status;
    }
 
-   //lgNotifyCloseOrphans(-1, sock);
+   return LG_SOCK_WANT_IN;
+}
 
-   lgHdlPurgeByOwner(Ctx->owner);
+static int xConnReply(lgSockConn_p conn, struct iovec *iov, int iovCnt)
+{
+   int i, bytes, len, sent = 0;
+   struct msghdr msg;
 
-   close(sock);
+   for (i=0, bytes=0; i<iovCnt; i++) bytes += iov[i].iov_len;
+
+   if (conn->outLen == 0)
+   {
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov = iov;
+      msg.msg_iovlen = iovCnt;
 
-   LG_DBG(LG_DEBUG_INTERNAL, "Socket %d closed", sock);
+      sent = sendmsg(conn->sock, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+      if (sent < 0)
+      {
+         if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+            return LG_SOCK_CLOSE;
+
+         sent = 0;
+      }
 
-   LG_DBG(LG_DEBUG_INTERNAL, "free context memory %d", Ctx->owner);
+      if (sent == bytes) return LG_SOCK_WANT_IN;
+   }
+
+   /* keep the rest until the client makes room */
+
+   if (xBufReserve(&conn->out, &conn->outSize,
+      conn->outPos+conn->outLen+bytes-sent) < 0) return LG_SOCK_CLOSE;
+
+   for (i=0; i<iovCnt; i++)
+   {
+      len = iov[i].iov_len;
+
+      if (sent >= len)
+      {
+         sent -= len;
+         continue;
+      }
 
-   free(Ctx);
+      memcpy(conn->out+conn->outPos+conn->outLen,
+         (char *)iov[i].iov_base+sent, len-sent);
+
+      conn->outLen += len-sent;
+      sent = 0;
+   }
+
+   return LG_SOCK_WANT_OUT;
+}
+
+static int xConnReplyFd(
+   lgSockConn_p conn, struct iovec *iov, int iovCnt,
+   int fd, off_t offset, int count)
+{
+   /*
+      The header goes first and then count bytes straight from fd.
+      Neither waits for the client, what it can't take now is sent
+      by xConnFlush when the socket is writable.
+   */
+
+   int status;
+
+   status = xConnReply(conn, iov, iovCnt);
+
+   if (status == LG_SOCK_CLOSE)
+   {
+      close(fd);
+      return status;
+   }
+
+   conn->fileFd = fd;
+   conn->fileOffset = offset;
+   conn->fileLen = count;
+
+   if (status == LG_SOCK_WANT_OUT) return status;
+
+   return xConnSendFile(conn);
+}
+
+static int xConnCmdBytes(lgSockConn_p conn)
+{
+   /*
+      Returns the length of the first command, 0 if its header has not
+      all arrived, or -1 if it is too large.
+   */
+
+   lgCmd_p cmdP = (lgCmd_p)conn->in;
+
+   if (conn->inLen < sizeof(lgCmd_t)) return 0;
+
+   if (cmdP->size >= (conn->frame-sizeof(lgCmd_t)))
+   {
+      /* Serious error.  No point continuing. */
+
+      LG_DBG(LG_DEBUG_ALWAYS,
+         "message too large %"PRId32"(%zd), sock=%d",
+         cmdP->size, conn->frame-sizeof(lgCmd_t), conn->sock);
+
+      return -1;
+   }
+
+   if (conn->rids) return sizeof(lgCmd_t) + LG_CMD_ID_BYTES + cmdP->size;
+
+   return sizeof(lgCmd_t) + cmdP->size;
+}
+
+static int xConnRead(lgSockConn_p conn)
+{
+   int need, got;
+
+   need = xConnCmdBytes(conn);
+
+   if (need < 0) return LG_SOCK_CLOSE;
+
+   /* room for the whole of a large command, or a few small ones */
+
+   if (need < (conn->inLen + LG_SOCK_BUF_MIN))
+      need = conn->inLen + LG_SOCK_BUF_MIN;
+
+   if (xBufReserve(&conn->in, &conn->inSize, need) < 0) return LG_SOCK_CLOSE;
+
+   got = recv(conn->sock, conn->in+conn->inLen, conn->inSize-conn->inLen,
+      MSG_DONTWAIT);
+
+   if (got > 0)
+   {
+      conn->inLen += got;
+      return LG_SOCK_WANT_IN;
+   }
+
+   if ((got < 0) &&
+       ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
+      return LG_SOCK_WANT_IN;
+
+   return LG_SOCK_CLOSE; /* closed by client or failed */
+}
+
+static int xConnExec(lgSockConn_p conn, lgCmd_p cmdP, uint32_t id, int inWorker)
+{
+   int opt, rids, iovCnt, fd;
+   off_t offset;
+   struct iovec iov[3];
+   uint32_t *arg=(uint32_t*)&cmdP[1];
+   char *ext=(char*)&cmdP[1];
+
+   LG_DBG(LG_DEBUG_INTERNAL, "magic=%d size=%d cmd=%d Q=%d I=%d H=%d",
+      cmdP->magic, cmdP->size, cmdP->cmd,
+      cmdP->doubles, cmdP->longs, cmdP->shorts);
+
+   if ((cmdP->cmd == LG_CMD_NOIB) || (cmdP->cmd == LG_CMD_NOIBC))
+   {
+     /* Enable the Nagle algorithm. */
+      opt = 0;
+      setsockopt(
+         conn->sock, IPPROTO_TCP, TCP_NODELAY, (char*)&opt, sizeof(int));
+
+      /*
+         Give the notification its own descriptor for the socket.  The
+         notification closes it when it ends, which must not remove the
+         connection from epoll.
+      */
+      arg[0] = fcntl(conn->sock, F_DUPFD_CLOEXEC, 0);
+   }
+
+   rids = conn->rids;
+
+   lgCtxSet(conn->ctx);
+
+   fd = -1;
+
+   if (cmdP->cmd == LG_CMD_RIDS)
+   {
+      /* handled here, the reply to this command has no id */
+      conn->rids = 1;
+      cmdP->size = 0;
+      cmdP->status = LG_OKAY;
+   }
+   else if (cmdP->cmd == LG_CMD_FRAME)
+   {
+      /* handled here, the new limit applies from the next command */
+      conn->frame = (cmdP->size >= 4) ? arg[0] : CMD_MAX_EXTENSION;
+      if (conn->frame < CMD_MAX_EXTENSION) conn->frame = CMD_MAX_EXTENSION;
+      if (conn->frame > CMD_MAX_FRAME) conn->frame = CMD_MAX_FRAME;
+      cmdP->size = 0;
+      cmdP->status = conn->frame;
+   }
+   else if (inWorker)
+      cmdP->status = lgExecCmdFd(cmdP, conn->frame, &fd, &offset);
+   else
+      cmdP->status = lgExecCmd(cmdP, conn->frame);
+
+   if ((cmdP->cmd == LG_CMD_NOIB) || (cmdP->cmd == LG_CMD_NOIBC))
+   {
+      if ((cmdP->status < 0) && ((int)arg[0] >= 0)) close(arg[0]);
+   }
+
+   LG_DBG(LG_DEBUG_INTERNAL, "status=%d size=%d cmd=%d Q=%d I=%d H=%d",
+      cmdP->status, cmdP->size, cmdP->cmd,
+      cmdP->doubles, cmdP->longs, cmdP->shorts);
+
+   LG_DBG(LG_DEBUG_INTERNAL, "ret=%s",
+      lgDbgStr2Hex(sizeof(lgCmd_t)+cmdP->size, (char *)cmdP));
+
+   iov[0].iov_base = cmdP;
+   iov[0].iov_len = sizeof(lgCmd_t);
+   iovCnt = 1;
+
+   if (rids)
+   {
+      iov[iovCnt].iov_base = &id;
+      iov[iovCnt].iov_len = LG_CMD_ID_BYTES;
+      iovCnt++;
+   }
+
+   if (fd >= 0)
+      return xConnReplyFd(conn, iov, iovCnt, fd, offset, cmdP->size);
+
+   if (cmdP->size)
+   {
+      iov[iovCnt].iov_base = ext;
+      iov[iovCnt].iov_len = cmdP->size;
+      iovCnt++;
+   }
+
+   return xConnReply(conn, iov, iovCnt);
+}
+
+static int xConnService(
+   lgSockConn_p conn, char **cmdBuf, int *cmdBufSize, int inWorker)
+{
+   /* executes each complete command received so far */
+
+   int bytes, status;
+   uint32_t id = 0;
+   lgCmd_p cmdP;
+
+   while (1)
+   {
+      /* don't take more commands until the client takes the replies */
+      if (conn->outLen || (conn->fileFd >= 0)) return LG_SOCK_WANT_OUT;
+
+      bytes = xConnCmdBytes(conn);
+
+      if (bytes < 0) return LG_SOCK_CLOSE;
+
+      if ((bytes == 0) || (conn->inLen < bytes)) break;
+
+      cmdP = (lgCmd_p)conn->in;
+
+      if (!inWorker && xCmdMayBlock(cmdP->cmd)) return LG_SOCK_WORKER;
+
+      /* the reply may be as large as the connection's frame */
+      if (xBufReserve(cmdBuf, cmdBufSize, conn->frame) < 0)
+         return LG_SOCK_CLOSE;
+
+      cmdP = (lgCmd_p)*cmdBuf;
+
+      if (conn->rids)
+      {
+         /* take out the id so the command is laid out as usual */
+         memcpy(cmdP, conn->in, sizeof(lgCmd_t));
+         memcpy(&id, conn->in+sizeof(lgCmd_t), LG_CMD_ID_BYTES);
+         memcpy(&cmdP[1], conn->in+sizeof(lgCmd_t)+LG_CMD_ID_BYTES,
+            bytes-sizeof(lgCmd_t)-LG_CMD_ID_BYTES);
+      }
+      else memcpy(cmdP, conn->in, bytes);
+
+      conn->inLen -= bytes;
+      memmove(conn->in, conn->in+bytes, conn->inLen);
+
+      status = xConnExec(conn, cmdP, id, inWorker);
+
+      if (status == LG_SOCK_CLOSE) return status;
+   }
+
+   if (conn->inLen == 0) xBufRelease(&conn->in, &conn->inSize);
+
+   return LG_SOCK_WANT_IN;
+}
+
+static void xConnClose(lgSockConn_p conn)
+{
+   epoll_ctl(sockEpoll, EPOLL_CTL_DEL, conn->sock, NULL);
+
+   lgCtxSet(conn->ctx);
+
+   lgHdlPurgeByOwner(conn->ctx->owner);
+
+   lgCtxSet(NULL);
+
+   close(conn->sock);
+
+   if (conn->fileFd >= 0) close(conn->fileFd);
+
+   LG_DBG(LG_DEBUG_INTERNAL, "Socket %d closed", conn->sock);
+
+   LG_DBG(LG_DEBUG_INTERNAL, "free context memory %d", conn->ctx->owner);
+
+   lgCtxFree(conn->ctx);
+   free(conn->in);
+   free(conn->out);
+   free(conn);
+}
+
+static void xConnQueue(lgSockConn_p conn)
+{
+   pthread_mutex_lock(&sockJobMutex);
+
+   conn->next = NULL;
+
+   if (sockJobTail) sockJobTail->next = conn;
+   else sockJobHead = conn;
+
+   sockJobTail = conn;
+
+   pthread_cond_signal(&sockJobCond);
+
+   pthread_mutex_unlock(&sockJobMutex);
+}
+
+static void xConnRearm(lgSockConn_p conn, int status)
+{
+   struct epoll_event ev;
+
+   if (status == LG_SOCK_WORKER)
+   {
+      xConnQueue(conn);
+      return;
+   }
+
+   if (status == LG_SOCK_CLOSE)
+   {
+      /* releasing the client's handles may block */
+      conn->closing = 1;
+      xConnQueue(conn);
+      return;
+   }
+
+   ev.events = EPOLLONESHOT | EPOLLRDHUP;
+   ev.events |= (status == LG_SOCK_WANT_OUT) ? EPOLLOUT : EPOLLIN;
+   ev.data.ptr = conn;
+
+   if (epoll_ctl(sockEpoll, EPOLL_CTL_MOD, conn->sock, &ev) < 0)
+   {
+      LG_DBG(LG_DEBUG_ALWAYS, "epoll_ctl failed (%m), sock=%d", conn->sock);
+      conn->closing = 1;
+      xConnQueue(conn);
+   }
+}
+
+static void *xSocketWorker(void *x)
+{
+   lgSockConn_p conn;
+   char *cmdBuf = NULL;
+   int cmdBufSize = 0;
+   sigset_t sigs;
+
+   /* sendfile can't be told not to raise SIGPIPE */
+   sigemptyset(&sigs);
+   sigaddset(&sigs, SIGPIPE);
+   pthread_sigmask(SIG_BLOCK, &sigs, NULL);
+
+   if (xBufReserve(&cmdBuf, &cmdBufSize, CMD_MAX_EXTENSION) < 0)
+      PARAM_ERROR((void*)LG_INIT_FAILED, "no memory for worker");
+
+   while (1)
+   {
+      pthread_mutex_lock(&sockJobMutex);
+
+      while (sockJobHead == NULL)
+         pthread_cond_wait(&sockJobCond, &sockJobMutex);
+
+      conn = sockJobHead;
+      sockJobHead = conn->next;
+      if (sockJobHead == NULL) sockJobTail = NULL;
+
+      pthread_mutex_unlock(&sockJobMutex);
+
+      if (conn->closing) xConnClose(conn);
+      else xConnRearm(conn, xConnService(conn, &cmdBuf, &cmdBufSize, 1));
+   }
 
    return 0;
 }
@@ -142,6 +677,9 @@ static int xAddrAllowed(struct sockaddr *saddr)
 
    if (!gNumSockNetAddr) return 1;
 
+   /* local, access is set by the socket file's permissions */
+   if (saddr->sa_family == AF_UNIX) return 1;
+
    // FIXME: add IPv6 whitelisting support
    if (saddr->sa_family != AF_INET) return 0;
 
@@ -154,13 +692,116 @@ static int xAddrAllowed(struct sockaddr *saddr)
    return 0;
 }
 
+static void xSocketAccept(int fdListen)
+{
+   int fdC, opt;
+   struct sockaddr_storage client;
+   socklen_t c;
+   lgSockConn_p conn;
+   struct epoll_event ev;
+
+   c = sizeof(client);
+
+   fdC = accept4(fdListen, (struct sockaddr *)&client, &c, SOCK_CLOEXEC);
+
+   if (fdC < 0)
+   {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+      {
+         LG_DBG(LG_DEBUG_ALWAYS, "accept failed (%m)");
+
+         /* e.g. out of descriptors, give closes a chance */
+         usleep(10000);
+      }
+      return;
+   }
+
+   /*
+      There is no need to look for orphaned notifications.  An in-band
+      notification has its own descriptor, so a new connection can't
+      share it, and is freed with the connection which opened it.
+   */
+
+   if (!xAddrAllowed((struct sockaddr *)&client))
+   {
+      LG_DBG(LG_DEBUG_ALWAYS, "Connection rejected, closing");
+      close(fdC);
+      return;
+   }
+
+   LG_DBG(LG_DEBUG_INTERNAL, "Connection accepted on socket %d", fdC);
+
+   conn = calloc(1, sizeof(lgSockConn_t));
+
+   if (conn != NULL) conn->ctx = calloc(1, sizeof(lgCtx_t));
+
+   if ((conn == NULL) || (conn->ctx == NULL))
+   {
+      LG_DBG(LG_DEBUG_ALWAYS, "no memory, closing");
+      free(conn);
+      close(fdC);
+      return;
+   }
+
+   conn->sock = fdC;
+   conn->frame = CMD_MAX_EXTENSION;
+   conn->fileFd = -1;
+
+   if (client.ss_family != AF_UNIX) /* nothing to tune locally */
+   {
+      /* Enable tcp_keepalive */
+      opt = 1;
+
+      if (setsockopt(fdC, SOL_SOCKET, SO_KEEPALIVE, &opt, sizeof(opt)) < 0)
+      {
+         LG_DBG(LG_DEBUG_ALWAYS,
+            "setsockopt() fail, closing socket %d", fdC);
+         free(conn->ctx);
+         free(conn);
+         close(fdC);
+         return;
+      }
+
+      LG_DBG(LG_DEBUG_INTERNAL, "SO_KEEPALIVE enabled on socket %d\n", fdC);
+
+      /* Disable the Nagle algorithm. */
+      opt = 1;
+
+      setsockopt(fdC, IPPROTO_TCP, TCP_NODELAY, (char*)&opt, sizeof(int));
+   }
+
+   ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+   ev.data.ptr = conn;
+
+   if (epoll_ctl(sockEpoll, EPOLL_CTL_ADD, fdC, &ev) < 0)
+   {
+      LG_DBG(LG_DEBUG_ALWAYS, "epoll_ctl failed (%m), closing");
+      free(conn->ctx);
+      free(conn);
+      close(fdC);
+   }
+}
+
+static void *xSocketListener(void *x)
+{
+   int fdListen = *(int *)x;
+
+   while (1) xSocketAccept(fdListen);
+
+   return 0;
+}
+
 /* ----------------------------------------------------------------------- */
 
 void *pthSocketThread(void *x)
 {
-   int fdC=0, c, *sock;
-   struct sockaddr_storage client;
+   int i, n, status;
+   lgSockConn_p conn;
+   char *cmdBuf = NULL;
+   int cmdBufSize = 0;
+   pthread_t thr;
    pthread_attr_t attr;
+   struct epoll_event events[LG_SOCK_MAX_EVENTS];
 
    if (pthread_attr_init(&attr))
       PARAM_ERROR((void*)LG_INIT_FAILED,
@@ -174,66 +815,68 @@ void *pthSocketThread(void *x)
       PARAM_ERROR((void*)LG_INIT_FAILED,
          "pthread_attr_setdetachstate failed (%m)");
 
-   /* gFdSock opened in initialisation so that we can treat
-      failure to bind as fatal. */
+   if (xBufReserve(&cmdBuf, &cmdBufSize, CMD_MAX_EXTENSION) < 0)
+      PARAM_ERROR((void*)LG_INIT_FAILED, "no memory for commands");
 
-   listen(gFdSock, 100);
+   sockEpoll = epoll_create1(EPOLL_CLOEXEC);
 
-   c = sizeof(client);
+   if (sockEpoll < 0)
+      PARAM_ERROR((void*)LG_INIT_FAILED, "epoll_create1 failed (%m)");
+
+   for (i=0; i<LG_SOCK_WORKERS; i++)
+   {
+      if (pthread_create(&thr, &attr, xSocketWorker, NULL))
+         PARAM_ERROR((void*)LG_INIT_FAILED,
+            "socket pthread_create failed (%m)");
+   }
+
+   /* gFdSock and gFdSockUnix opened in initialisation so that we can
+      treat failure to bind as fatal. */
 
-   while (fdC >= 0)
+   for (i=0; i<gNumFdSock; i++) sockListen[i] = gFdSock[i];
+
+   sockListen[gNumFdSock] = gFdSockUnix;
+
+   for (i=0; i<=gNumFdSock; i++)
    {
-      pthread_t thr;
+      if (sockListen[i] < 0) continue;
 
-      fdC = accept(gFdSock, (struct sockaddr *)&client, (socklen_t*)&c);
+      listen(sockListen[i], SOMAXCONN);
 
-      lgNotifyCloseOrphans(-1, fdC);
+      if (pthread_create(&thr, &attr, xSocketListener, &sockListen[i]))
+         PARAM_ERROR((void*)LG_INIT_FAILED,
+            "listener pthread_create failed (%m)");
+   }
 
-      if (xAddrAllowed((struct sockaddr *)&client))
+   while (1)
+   {
+      n = epoll_wait(sockEpoll, events, LG_SOCK_MAX_EVENTS, -1);
+
+      if (n < 0)
       {
-         LG_DBG(LG_DEBUG_INTERNAL, "Connection accepted on socket %d", fdC);
-
-         sock = malloc(sizeof(int));
-
-         if (sock != NULL)
-         {
-            *sock = fdC;
-
-            /* Enable tcp_keepalive */
-            int optval = 1;
-            socklen_t optlen = sizeof(optval);
-
-            if (setsockopt(fdC, SOL_SOCKET, SO_KEEPALIVE, &optval, optlen) < 0)
-            {
-              LG_DBG(LG_DEBUG_ALWAYS,
-                 "setsockopt() fail, closing socket %d", fdC);
-              close(fdC);
-            }
-
-            LG_DBG(LG_DEBUG_INTERNAL,
-               "SO_KEEPALIVE enabled on socket %d\n", fdC);
-
-            if (pthread_create
-               (&thr, &attr, xSocketThreadHandler, (void*) sock) < 0)
-               PARAM_ERROR((void*)LG_INIT_FAILED,
-                  "socket pthread_create failed (%m)");
-         }
-         else
-         {
-            LG_DBG(LG_DEBUG_ALWAYS, "no memory, closing");
-            close(fdC);
-         }
+         if (errno == EINTR) continue;
+
+         PARAM_ERROR((void*)LG_INIT_FAILED, "epoll_wait failed (%m)");
       }
-      else
+
+      for (i=0; i<n; i++)
       {
-         LG_DBG(LG_DEBUG_ALWAYS, "Connection rejected, closing");
-         close(fdC);
+         conn = events[i].data.ptr;
+
+         status = LG_SOCK_WANT_IN;
+
+         if (events[i].events & EPOLLOUT) status = xConnFlush(conn);
+
+         if ((status == LG_SOCK_WANT_IN) &&
+             (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+            status = xConnRead(conn);
+
+         if (status == LG_SOCK_WANT_IN)
+            status = xConnService(conn, &cmdBuf, &cmdBufSize, 0);
+
+         xConnRearm(conn, status);
       }
    }
 
-   if (fdC < 0)
-      PARAM_ERROR((void*)LG_INIT_FAILED, "accept failed (%m)");
-
    return 0;
 }
-
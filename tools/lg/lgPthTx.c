@@ -40,6 +40,23 @@ static int pthTxRunning = LG_THREAD_NONE;
 static struct timespec pthTxReq;
 static int pthTxDelayMicros = 0;
 
+static void xTxRecFree(lgTxRec_p p)
+{
+   int i;
+
+   if (p->type == LG_TX_WAVE)
+   {
+      /* free the malloc'd pulses */
+      for (i=0; i<p->entries; i++)
+      {
+         free(p->pulses[i]);
+         p->pulses[i] = NULL;
+      }
+   }
+
+   free(p);
+}
+
 void *lgPthTx(void)
 {
    lgTxRec_p p, t;
@@ -152,17 +169,7 @@ void *lgPthTx(void)
 
             if (p->next) p->next->prev = p->prev;
 
-            if (p->type == LG_TX_WAVE)
-            {
-               /* free the malloc'd pulses */
-               for (i=0; i<p->entries; i++)
-               {
-                  free(p->pulses[i]);
-                  p->pulses[i] = NULL;
-               }
-            }
-
-            t = p; p = p->prev; free(t);
+            t = p; p = p->prev; xTxRecFree(t);
          }
 
          if (p) p = p->next;
@@ -211,14 +218,35 @@ void lgPthTxUnlock(void)
 
 void lgPthTxStop(lgChipObj_p chip)
 {
-   lgTxRec_p pwm;
+   lgTxRec_p p, t;
+
+   /*
+      Remove any PWM/waves on chip.  The tx thread only touches its
+      records while holding the tx mutex so once they are unlinked
+      here it can no longer reference the chip.
+   */
+
+   lgPthTxLock();
 
-   /* stop any PWM on chip */
-   
-   for (pwm=txRec; pwm!=NULL; pwm=pwm->next)
+   p = txRec;
+
+   while (p != NULL)
    {
-      if (chip->handle == pwm->chip->handle) pwm->active =0;
+      t = p;
+      p = p->next;
+
+      if (t->chip == chip)
+      {
+         if (t->prev) t->prev->next = t->next;
+         else txRec = t->next;
+
+         if (t->next) t->next->prev = t->prev;
+
+         xTxRecFree(t);
+      }
    }
+
+   lgPthTxUnlock();
 }
 
 lgTxRec_p lgGpioGetTxRec(lgChipObj_p chip, int gpio, int type)
@@ -44,6 +44,16 @@ For more information, please refer to <http://unlicense.org/>
 
 #define LG_SCRIPT_STACK_SIZE 256
 
+/*
+   Resolved when the script is stored so that running an instruction
+   needs no lookups.
+*/
+typedef struct
+{
+   lgExecFunc_t func; /* runs the command directly, NULL for lgExecCmd */
+   int args;          /* arguments up to the last variable or parameter */
+} lgScriptOp_t;
+
 typedef struct
 {
    int id;
@@ -53,6 +63,7 @@ typedef struct
    pthread_mutex_t pthMutex;
    pthread_cond_t pthCond;
    cmdScript_t script;
+   lgScriptOp_t *op; /* one per instruction */
    char user[LG_USER_LEN];
    int share;
 } lgScript_t, *lgScript_p;
@@ -65,6 +76,10 @@ static void _scriptClose(lgScript_p s)
    if (s->script.par) free(s->script.par);
 
    s->script.par = NULL;
+
+   if (s->op) free(s->op);
+
+   s->op = NULL;
 }
 
 
@@ -175,7 +190,8 @@ static void *pthScript(void *x)
 {
    lgScript_p s;
    int i, t;
-   cmdInstr_t instr;
+   cmdInstr_t *instr;
+   lgScriptOp_t *op;
    int32_t p0, p1, p0o, p1o, *t1, *t2;
    int32_t PC, A, F, SP;
    uint32_t tmp;
@@ -212,37 +228,40 @@ static void *pthScript(void *x)
       while (((volatile int)s->request   == LG_SCRIPT_RUN    ) &&
                            (s->run_state == LG_SCRIPT_RUNNING))
       {
-         // get local copy of next instruction
+         instr = &s->script.instr[PC];
+         op = &s->op[PC];
 
-         instr = s->script.instr[PC];
-
-         if (instr.cmd < LG_CMD_SCRIPT)
+         if (instr->cmd < LG_CMD_SCRIPT)
          {
+            for (i=0; i<CMD_MAX_ARG; i++) arg[i] = instr->arg[i];
+
             // parameter and variable substitution
 
-            for (i=0; i<CMD_MAX_OPT; i++)
+            for (i=0; i<op->args; i++)
             {
-               t = instr.arg[i];
-               if      (instr.opt[i] == CMD_VAR) instr.arg[i] = s->script.var[t];
-               else if (instr.opt[i] == CMD_PAR) instr.arg[i] = s->script.par[t];
+               t = instr->arg[i];
+               if      (instr->opt[i] == CMD_VAR) arg[i] = s->script.var[t];
+               else if (instr->opt[i] == CMD_PAR) arg[i] = s->script.par[t];
             }
 
-            fprintf(stderr, "PC=%d cmd=%d p0=%d p1=%d p2=%d p3=%d\n",
-               PC, instr.cmd,
-               instr.arg[0], instr.arg[1], instr.arg[2], instr.arg[3]);
+            LG_DBG(LG_DEBUG_SCRIPT, "PC=%d cmd=%d p0=%d p1=%d p2=%d p3=%d",
+               PC, instr->cmd, arg[0], arg[1], arg[2], arg[3]);
 
-            fflush(stderr);
-
-            cmdP->magic = LG_MAGIC;
-            cmdP->size = 0;
-            cmdP->cmd = instr.cmd;
-            cmdP->doubles = 0;
-            cmdP->longs = 0;
-            cmdP->shorts = 0;
-
-            for (i=0; i<CMD_MAX_ARG; i++) arg[i] = instr.arg[i];
-
-            A = lgExecCmd(cmdBuf, sizeof(cmdBuf));
+            if (op->func)
+            {
+               A = lgExecDirect(op->func, instr->cmd, arg);
+            }
+            else
+            {
+               cmdP->magic = LG_MAGIC;
+               cmdP->size = 0;
+               cmdP->cmd = instr->cmd;
+               cmdP->doubles = 0;
+               cmdP->longs = 0;
+               cmdP->shorts = 0;
+
+               A = lgExecCmd(cmdBuf, sizeof(cmdBuf));
+            }
 
             F = A;
 
@@ -250,28 +269,27 @@ static void *pthScript(void *x)
          }
          else
          {
-            p0o = instr.arg[0];
-            p1o = instr.arg[1];
+            p0 = p0o = instr->arg[0];
+            p1 = p1o = instr->arg[1];
 
-            // parameter and variable substitution
+            // parameter and variable substitution, at most two
 
-            for (i=0; i<2; i++) // maximum of two parameters
+            if (op->args > 0)
             {
-               t = instr.arg[i];
-               if      (instr.opt[i] == CMD_VAR) instr.arg[i] = s->script.var[t];
-               else if (instr.opt[i] == CMD_PAR) instr.arg[i] = s->script.par[t];
+               if      (instr->opt[0] == CMD_VAR) p0 = s->script.var[p0o];
+               else if (instr->opt[0] == CMD_PAR) p0 = s->script.par[p0o];
             }
 
-            p0 = instr.arg[0];
-            p1 = instr.arg[1];
-
-            fprintf(stderr, "PC=%d cmd=%d p0=%d p0o=%d p1=%d p1o=%d\n",
-               PC, instr.cmd,
-               instr.arg[0], p0o, instr.arg[1], p1o);
+            if (op->args > 1)
+            {
+               if      (instr->opt[1] == CMD_VAR) p1 = s->script.var[p1o];
+               else if (instr->opt[1] == CMD_PAR) p1 = s->script.par[p1o];
+            }
 
-            fflush(stderr);
+            LG_DBG(LG_DEBUG_SCRIPT, "PC=%d cmd=%d p0=%d p0o=%d p1=%d p1o=%d",
+               PC, instr->cmd, p0, p0o, p1, p1o);
 
-            switch (instr.cmd)
+            switch (instr->cmd)
             {
                case LG_CMD_ADD:   A+=p0; F=A;                     PC++; break;
 
@@ -282,7 +300,7 @@ static void *pthScript(void *x)
                case LG_CMD_CMP:   F=A-p0;                         PC++; break;
 
                case LG_CMD_DCR:
-                  if (instr.opt[0] == CMD_PAR)
+                  if (instr->opt[0] == CMD_PAR)
                      {--s->script.par[p0o]; F=s->script.par[p0o];}
                   else
                      {--s->script.var[p0o]; F=s->script.var[p0o];}
@@ -296,7 +314,7 @@ static void *pthScript(void *x)
                case LG_CMD_HALT:  s->run_state = LG_SCRIPT_ENDED;       break;
 
                case LG_CMD_INR:
-                  if (instr.opt[0] == CMD_PAR)
+                  if (instr->opt[0] == CMD_PAR)
                      {++s->script.par[p0o]; F=s->script.par[p0o];}
                   else
                      {++s->script.var[p0o]; F=s->script.var[p0o];}
@@ -320,7 +338,7 @@ static void *pthScript(void *x)
                case LG_CMD_JZ:    if (!F)   PC=p0; else PC++;           break;
 
                case LG_CMD_LD:
-                  if (instr.opt[0] == CMD_PAR) s->script.par[p0o]=p1;
+                  if (instr->opt[0] == CMD_PAR) s->script.par[p0o]=p1;
                   else                         s->script.var[p0o]=p1;
                   PC++;
                   break;
@@ -334,7 +352,7 @@ static void *pthScript(void *x)
                case LG_CMD_OR:    A|=p0; F=A;                     PC++; break;
 
                case LG_CMD_POP:
-                  if (instr.opt[0] == CMD_PAR)
+                  if (instr->opt[0] == CMD_PAR)
                      s->script.par[p0o]=scrPop(s, &SP, S);
                   else
                      s->script.var[p0o]=scrPop(s, &SP, S);
@@ -344,7 +362,7 @@ static void *pthScript(void *x)
                case LG_CMD_POPA:  A=scrPop(s, &SP, S);            PC++; break;
 
                case LG_CMD_PUSH:
-                  if (instr.opt[0] == CMD_PAR)
+                  if (instr->opt[0] == CMD_PAR)
                      scrPush(s, &SP, S, s->script.par[p0o]);
                   else
                      scrPush(s, &SP, S, s->script.var[p0o]);
@@ -356,7 +374,7 @@ static void *pthScript(void *x)
                case LG_CMD_RET:   PC=scrPop(s, &SP, S);                 break;
 
                case LG_CMD_RL:
-                  if (instr.opt[0] == CMD_PAR)
+                  if (instr->opt[0] == CMD_PAR)
                   {
                      tmp = xrl(s->script.par[p0o], p1);
                      s->script.par[p0o] = tmp;
@@ -374,7 +392,7 @@ static void *pthScript(void *x)
                case LG_CMD_RLA:   A=xrl(A, p0); F=A;              PC++; break;
 
                case LG_CMD_RR:
-                  if (instr.opt[0] == CMD_PAR)
+                  if (instr->opt[0] == CMD_PAR)
                   {
                      tmp = xrr(s->script.par[p0o], p1);
                      s->script.par[p0o] = tmp;
@@ -392,7 +410,7 @@ static void *pthScript(void *x)
                case LG_CMD_RRA:   A=xrr(A, p0); F=A;              PC++; break;
 
                case LG_CMD_SHL:
-                  if (instr.opt[0] == CMD_PAR)
+                  if (instr->opt[0] == CMD_PAR)
                   {
                      tmp = xsl(s->script.par[p0o], p1);
                      s->script.par[p0o] = tmp;
@@ -410,7 +428,7 @@ static void *pthScript(void *x)
                case LG_CMD_SHLA:   A=xsl(A, p0); F=A;              PC++; break;
 
                case LG_CMD_SHR:
-                  if (instr.opt[0] == CMD_PAR)
+                  if (instr->opt[0] == CMD_PAR)
                   {
                      tmp = xsr(s->script.par[p0o], p1);
                      s->script.par[p0o] = tmp;
@@ -428,7 +446,7 @@ static void *pthScript(void *x)
                case LG_CMD_SHRA:   A=xsr(A, p0); F=A;              PC++; break;
 
                case LG_CMD_STA:
-                  if (instr.opt[0] == CMD_PAR) s->script.par[p0o]=A;
+                  if (instr->opt[0] == CMD_PAR) s->script.par[p0o]=A;
                   else                         s->script.var[p0o]=A;
                   PC++;
                   break;
@@ -442,10 +460,10 @@ static void *pthScript(void *x)
                   break;
 
                case LG_CMD_X:
-                  if (instr.opt[0] == CMD_PAR) t1 = &s->script.par[p0o];
+                  if (instr->opt[0] == CMD_PAR) t1 = &s->script.par[p0o];
                   else                         t1 = &s->script.var[p0o];
 
-                  if (instr.opt[1] == CMD_PAR) t2 = &s->script.par[p1o];
+                  if (instr->opt[1] == CMD_PAR) t2 = &s->script.par[p1o];
                   else                         t2 = &s->script.var[p1o];
 
                   scrSwap(t1, t2);
@@ -453,7 +471,7 @@ static void *pthScript(void *x)
                   break;
 
                case LG_CMD_XA:
-                  if (instr.opt[0] == CMD_PAR)
+                  if (instr->opt[0] == CMD_PAR)
                      scrSwap(&s->script.par[p0o], &A);
                   else
                      scrSwap(&s->script.var[p0o], &A);
@@ -536,8 +554,10 @@ int lgScriptStore(char *script)
 {
    lgScript_p s;
    lgCtx_p Ctx;
+   cmdInstr_t *instr;
    int handle;
    int status;
+   int i, j;
 
    LG_DBG(LG_DEBUG_TRACE, "script=[%s]", script);
 
@@ -550,6 +570,29 @@ int lgScriptStore(char *script)
 
    if (status == 0)
    {
+      s->op = calloc(s->script.instrs + 1, sizeof(lgScriptOp_t));
+
+      if (s->op == NULL) status = LG_NO_MEMORY;
+   }
+
+   if (status == 0)
+   {
+      /* resolve each instruction once rather than each time it runs */
+
+      for (i=0; i<s->script.instrs; i++)
+      {
+         instr = &s->script.instr[i];
+
+         if (instr->cmd < LG_CMD_SCRIPT)
+            s->op[i].func = lgExecDirectFunc(instr->cmd);
+
+         for (j=0; j<CMD_MAX_OPT; j++)
+         {
+            if ((instr->opt[j] == CMD_VAR) || (instr->opt[j] == CMD_PAR))
+               s->op[i].args = j + 1;
+         }
+      }
+
       /* set the owner's user and share */
 
       Ctx = lgCtxGet();
@@ -0,0 +1,430 @@
+/*
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <inttypes.h>
+
+#include "lgpio.h"
+#include "rgpiod.h"
+
+#include "lgCmd.h"
+#include "lgCtx.h"
+#include "lgDbg.h"
+#include "lgHdl.h"
+
+/* the step replies must leave room for the record header */
+#define LG_STREAM_REPLY_ROOM \
+   (LG_COMPACT_MAX_FRAME - LG_COMPACT_RECORD_HDR - sizeof(lgStreamRecord_t))
+
+typedef struct lgStream_s
+{
+   struct lgStream_s *next; /* on the live list */
+   int handle;
+   int nfyHandle;
+   uint64_t nfyId;    /* the notification, not a later user of its handle */
+   uint64_t period;   /* nanoseconds */
+   uint32_t count;    /* records to send, 0 for no limit */
+   int stop;
+   pthread_t *pthIdp;
+   pthread_mutex_t pthMutex;
+   pthread_cond_t pthCond;
+   char user[LG_USER_LEN];
+   int owner;
+   int share;
+   int approved;
+   int len;           /* bytes of steps */
+   char steps[];      /* an LG_CMD_BATCH extension */
+} lgStream_t, *lgStream_p;
+
+/* live streams, so they can be ended as their notification closes */
+static lgStream_p xStreams = NULL;
+static pthread_mutex_t xStreamsMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t xStreamsInited = PTHREAD_ONCE_INIT;
+
+
+static void xStreamStop(lgStream_p s)
+{
+   pthread_mutex_lock(&s->pthMutex);
+
+   s->stop = 1;
+
+   pthread_cond_signal(&s->pthCond);
+
+   pthread_mutex_unlock(&s->pthMutex);
+}
+
+
+static void xStreamsNotifyClosed(uint64_t nfyId)
+{
+   lgStream_p s;
+
+   /* the stream handle stays until closed but sends nothing more */
+
+   pthread_mutex_lock(&xStreamsMutex);
+
+   for (s=xStreams; s; s=s->next)
+   {
+      if (s->nfyId == nfyId)
+      {
+         LG_DBG(LG_DEBUG_USER, "stream %d notify closed", s->handle);
+         xStreamStop(s);
+      }
+   }
+
+   pthread_mutex_unlock(&xStreamsMutex);
+}
+
+
+static void xStreamsInit(void)
+{
+   lgNotifySetCloseHook(xStreamsNotifyClosed);
+}
+
+
+static void _streamClose(lgStream_p s)
+{
+   lgStream_p *sp;
+
+   LG_DBG(LG_DEBUG_ALWAYS, "objp=*%p", s);
+
+   pthread_mutex_lock(&xStreamsMutex);
+
+   for (sp=&xStreams; *sp; sp=&(*sp)->next)
+   {
+      if (*sp == s)
+      {
+         *sp = s->next;
+         break;
+      }
+   }
+
+   pthread_mutex_unlock(&xStreamsMutex);
+
+   /* the thread only waits on the condition or runs the steps */
+
+   xStreamStop(s);
+
+   if (s->pthIdp != NULL)
+   {
+      pthread_join(*s->pthIdp, NULL);
+
+      free(s->pthIdp);
+   }
+
+   pthread_cond_destroy(&s->pthCond);
+   pthread_mutex_destroy(&s->pthMutex);
+}
+
+
+static int xStepAllowed(int cmd)
+{
+   /* commands which read or transfer and leave no resources behind */
+
+   switch (cmd)
+   {
+      case LG_CMD_GR:
+      case LG_CMD_GGR:
+      case LG_CMD_I2CPC:
+      case LG_CMD_I2CPK:
+      case LG_CMD_I2CRB:
+      case LG_CMD_I2CRD:
+      case LG_CMD_I2CRI:
+      case LG_CMD_I2CRK:
+      case LG_CMD_I2CRS:
+      case LG_CMD_I2CRW:
+      case LG_CMD_I2CWS:
+      case LG_CMD_I2CZ:
+      case LG_CMD_SERDA:
+      case LG_CMD_SERR:
+      case LG_CMD_SERRB:
+      case LG_CMD_SPIR:
+      case LG_CMD_SPIW:
+      case LG_CMD_SPIX:
+      case LG_CMD_TICK:
+         return 1;
+   }
+
+   return 0;
+}
+
+
+static int xStepsValid(char *steps, int len)
+{
+   int pos, count;
+   lgCmd_p subP;
+
+   if ((len <= LG_BATCH_HDR_BYTES) || (len > LG_STREAM_REPLY_ROOM)) return 0;
+
+   pos = LG_BATCH_HDR_BYTES;
+   count = 0;
+
+   while (pos < len)
+   {
+      subP = (lgCmd_p)(steps + pos);
+
+      if (((len - pos) < sizeof(lgCmd_t)) ||
+          (subP->size > (len - pos - sizeof(lgCmd_t)))) return 0;
+
+      if (!xStepAllowed(subP->cmd)) return 0;
+
+      if (++count > LG_STREAM_MAX_STEPS) return 0;
+
+      pos += LG_BATCH_PAD(sizeof(lgCmd_t) + subP->size);
+   }
+
+   return 1;
+}
+
+
+static uint64_t xMonotonicNanos(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+
+static void *pthStream(void *x)
+{
+   lgStream_p s;
+   lgCtx_p Ctx;
+   lgCmd_t cmdBuf[2 + (LG_STREAM_REPLY_ROOM / sizeof(lgCmd_t))];
+   lgCmd_p cmdP=cmdBuf;
+   uint8_t frame[LG_COMPACT_MAX_FRAME];
+   lgStreamRecord_t rec;
+   struct timespec ts;
+   uint64_t next, now, missed;
+   uint32_t sent;
+   int bytes;
+
+   s = x;
+
+   Ctx = lgCtxGet();
+
+   if (!Ctx) return 0;
+
+   /* act for the stream's creator, so its handles may be used */
+
+   strncpy(Ctx->user, s->user, LG_USER_LEN);
+   Ctx->owner = s->owner;
+   Ctx->autoUseShare = s->share;
+   Ctx->approved = s->approved;
+   Ctx->permits.gen = -1; /* compiled on the first step */
+
+   memset(&rec, 0, sizeof(rec));
+
+   rec.handle = s->handle;
+
+   sent = 0;
+
+   next = xMonotonicNanos();
+
+   while (1)
+   {
+      rec.timestamp = lguTimestamp();
+
+      cmdP->magic = LG_MAGIC;
+      cmdP->size = s->len;
+      cmdP->cmd = LG_CMD_BATCH;
+      cmdP->doubles = 0;
+      cmdP->longs = 0;
+      cmdP->shorts = 0;
+
+      memcpy(&cmdP[1], s->steps, s->len);
+
+      rec.steps = lgExecCmd(cmdP, sizeof(lgCmd_t) + LG_STREAM_REPLY_ROOM);
+
+      bytes = sizeof(rec) + cmdP->size;
+
+      /* a zero length frame, then the record length, then the record */
+
+      frame[0] = 0x80;
+      frame[1] = 0;
+      frame[2] = (bytes & 0x7f) | 0x80;
+      frame[3] = bytes >> 7;
+
+      memcpy(frame + LG_COMPACT_RECORD_HDR, &rec, sizeof(rec));
+      memcpy(frame + LG_COMPACT_RECORD_HDR + sizeof(rec), &cmdP[1], cmdP->size);
+
+      if (lgNotifyWriteRecord(s->nfyHandle, s->nfyId,
+         frame, LG_COMPACT_RECORD_HDR + bytes) < 0) break;
+
+      if (s->count && (++sent >= s->count)) break;
+
+      /* skip the periods already missed */
+
+      next += s->period;
+      rec.seq++;
+
+      now = xMonotonicNanos();
+
+      if (now >= next)
+      {
+         missed = ((now - next) / s->period) + 1;
+         next += missed * s->period;
+         rec.seq += missed;
+      }
+
+      ts.tv_sec = next / 1000000000;
+      ts.tv_nsec = next % 1000000000;
+
+      pthread_mutex_lock(&s->pthMutex);
+
+      while (!s->stop &&
+         (pthread_cond_timedwait(&s->pthCond, &s->pthMutex, &ts) != ETIMEDOUT));
+
+      pthread_mutex_unlock(&s->pthMutex);
+
+      if (s->stop) break;
+   }
+
+   LG_DBG(LG_DEBUG_USER, "stream %d ended after %"PRIu32" records",
+      s->handle, sent);
+
+   lgCtxSet(NULL);
+
+   lgCtxFree(Ctx);
+
+   return 0;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgStreamOpen(int nfyHandle, int period, int count, char *steps, int len)
+{
+   int handle;
+   lgStream_p s;
+   lgCtx_p Ctx;
+   uint64_t nfyId;
+   pthread_condattr_t attr;
+
+   LG_DBG(LG_DEBUG_TRACE, "nfyHandle=%d period=%d count=%d len=%d",
+      nfyHandle, period, count, len);
+
+   if ((period < LG_STREAM_MIN_PERIOD) || (count < 0) ||
+       !xStepsValid(steps, len))
+      PARAM_ERROR(LG_BAD_STREAM, "bad stream (%d %d %d)", period, count, len);
+
+   /* records go to the caller's in-band or pipe compact notification */
+
+   nfyId = lgNotifyGetId(nfyHandle);
+
+   if (nfyId == 0)
+      PARAM_ERROR(LG_BAD_HANDLE, "bad notify handle (%d)", nfyHandle);
+
+   pthread_once(&xStreamsInited, xStreamsInit);
+
+   Ctx = lgCtxGet();
+
+   if (Ctx == NULL) return LG_NO_MEMORY;
+
+   handle = lgHdlAlloc(LG_HDL_TYPE_STREAM, sizeof(lgStream_t) + len,
+      (void**)&s, _streamClose);
+
+   if (handle < 0) return LG_NO_MEMORY;
+
+   s->handle = handle;
+   s->nfyHandle = nfyHandle;
+   s->nfyId = nfyId;
+   s->period = (uint64_t)period * 1000;
+   s->count = count;
+
+   strncpy(s->user, Ctx->user, LG_USER_LEN);
+   s->owner = Ctx->owner;
+   s->share = Ctx->autoUseShare;
+   s->approved = Ctx->approved;
+
+   s->len = len;
+   memcpy(s->steps, steps, len);
+
+   /* timed waits measure against the clock used for the periods */
+
+   pthread_condattr_init(&attr);
+   pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+   pthread_cond_init(&s->pthCond, &attr);
+   pthread_condattr_destroy(&attr);
+
+   pthread_mutex_init(&s->pthMutex, NULL);
+
+   pthread_mutex_lock(&xStreamsMutex);
+
+   s->next = xStreams;
+   xStreams = s;
+
+   pthread_mutex_unlock(&xStreamsMutex);
+
+   /*
+      Checked once listed, so if the notification closes from now on
+      the stream is stopped.
+   */
+
+   if (lgNotifyWriteRecord(nfyHandle, nfyId, NULL, 0) != LG_OKAY)
+   {
+      lgHdlFree(handle, LG_HDL_TYPE_STREAM);
+      PARAM_ERROR(LG_BAD_STREAM, "notify not compact (%d)", nfyHandle);
+   }
+
+   s->pthIdp = lgThreadStart(pthStream, s);
+
+   if (s->pthIdp == NULL)
+   {
+      lgHdlFree(handle, LG_HDL_TYPE_STREAM);
+      return LG_NO_MEMORY;
+   }
+
+   return handle;
+}
+
+/* ----------------------------------------------------------------------- */
+
+int lgStreamClose(int handle)
+{
+   int status;
+   lgStream_p s;
+
+   LG_DBG(LG_DEBUG_TRACE, "handle=%d", handle);
+
+   status = lgHdlGetLockedObj(handle, LG_HDL_TYPE_STREAM, (void **)&s);
+
+   if (status == LG_OKAY)
+   {
+      /* the destructor waits for the stream thread */
+
+      status = lgHdlFree(handle, LG_HDL_TYPE_STREAM);
+
+      lgHdlUnlock(handle);
+   }
+
+   return status;
+}
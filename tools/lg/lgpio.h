@@ -83,6 +83,7 @@ lgGpiochipClose              Closes a gpiochip device
 
 lgGpioGetChipInfo            Gets gpiochip information
 lgGpioGetLineInfo            Gets gpiochip line information
+lgGpioGetChipLineInfo        Gets line information for all gpiochip lines
 lgGpioGetMode                Gets the mode of a GPIO
 
 lgGpioSetUser                Notifies Linux of the GPIO user
@@ -113,7 +114,10 @@ lgGpioSetDebounce            Sets the debounce time for a GPIO
 lgGpioSetWatchdog            Sets the watchdog time for a GPIO
 
 lgGpioSetAlertsFunc          Starts a GPIO callback
+lgGpioSetLineInfoAlerts      Starts alerts on GPIO ownership changes
 lgGpioSetSamplesFunc         Starts a GPIO callback for all GPIO
+lgGpioSetAlertsQueue         Runs GPIO callbacks off the alert thread
+lgGpioDispatchAlerts         Runs queued GPIO callbacks
 
 I2C
 
@@ -152,6 +156,17 @@ lgNotifyOpen                 Request a notification
 lgNotifyClose                Close a notification
 lgNotifyPause                Pause notifications
 lgNotifyResume               Start notifications
+lgNotifyFilter               Select the reports a notification receives
+lgNotifyGetStats             Get the delivery statistics of a notification
+
+lgNotifyOpenRing             Request a shared memory notification
+lgNotifyRingFd               Get the shared memory of a notification
+lgNotifyRingMap              Map a notification's shared memory
+lgNotifyRingUnmap            Unmap a notification's shared memory
+lgNotifyRingRead             Read reports from shared memory
+
+lgNotifyOpenCapture          Request a notification recorded to a file
+lgCaptureReplay              Replay a recorded file
 
 SERIAL
 
@@ -236,6 +251,51 @@ extern "C" {
 
 #define MAX_EMITS (PIPE_BUF / sizeof(lgGpioReport_t))
 
+/*
+   Notification formats.  LG_NOTIFY_FORMAT_REPORT writes each report
+   as an lgGpioReport_t.  LG_NOTIFY_FORMAT_COMPACT writes frames of at
+   most LG_COMPACT_MAX_FRAME bytes, each an independent batch of
+   reports in the original order.  All varints are unsigned LEB128.
+
+   frame:   varint body length, then the body
+   body:    varint timestamp of the first report, then segments
+   segment: u8 chip, u8 gpio, u8 flags, varint report count, then
+            level runs covering the count, then one zigzag varint
+            per report of its timestamp minus the previous one
+   run:     u8 level (| LG_COMPACT_ALTERNATE if the level toggles
+            between successive reports), varint report count
+
+   A frame with a body length of 0 is followed by a record rather
+   than reports, a varint record length then the record.  rgpiod
+   streams send an lgStreamRecord_t followed by the step replies,
+   laid out as an LG_CMD_BATCH reply.  A whole record frame is at
+   most LG_COMPACT_MAX_FRAME bytes.
+*/
+#define LG_NOTIFY_FORMAT_REPORT  0
+#define LG_NOTIFY_FORMAT_COMPACT 1
+
+#define LG_COMPACT_MAX_FRAME 4096 /* <= PIPE_BUF, so pipe writes are atomic */
+#define LG_COMPACT_ALTERNATE 0x80
+#define LG_COMPACT_RECORD_HDR 4 /* 0 length, record length, both 2 bytes */
+
+#define LG_NOTIFY_RING_MAGIC 0x6c67726e /* "lgrn" */
+#define LG_CAPTURE_MAGIC     0x6c676370 /* "lgcp" */
+#define LG_CAPTURE_VERSION   1
+#define LG_CAPTURE_INDEX_INTERVAL 1024
+#define LG_MAX_CAPTURE_REPORTS (1<<28)
+#define LG_NOTIFY_RING_SLOTS 4096
+#define LG_MIN_NOTIFY_RING_SLOTS 16
+#define LG_MAX_NOTIFY_RING_SLOTS (1<<20)
+#define LG_MIN_ALERTS_QUEUE_SLOTS 64
+#define LG_MAX_ALERTS_QUEUE_SLOTS (1<<20)
+
+#define LG_BATCH_STOP_ON_ERROR 1 /* stop a batch at the first error */
+
+#define LG_SHARE_TRANSIENT 1 /* shared handles are still freed with their owner */
+
+#define LG_STATS_RESET   1  /* zero the command statistics once read */
+#define LG_STATS_BUCKETS 24 /* execution time histogram buckets */
+
 #define STACK_SIZE (256*1024)
 
 #define LG_USER_LEN 16
@@ -287,6 +347,16 @@ extern "C" {
 #define LG_FALLING_EDGE       2
 #define LG_BOTH_EDGES         3
 
+/* report flags */
+
+#define LG_REPORT_LINE_INFO   1
+
+/* line info report levels */
+
+#define LG_LINE_REQUESTED     1
+#define LG_LINE_RELEASED      2
+#define LG_LINE_RECONFIGURED  3
+
 /* use to set line flags */
 
 #define LG_SET_ACTIVE_LOW  4
@@ -366,24 +436,106 @@ typedef struct lgChipInfo_s
    char label[LG_GPIO_LABEL_LEN]; /* functional name */
 } lgChipInfo_t, *lgChipInfo_p;
 
+typedef struct
+{
+   uint64_t timestamp; /* alert time in nanoseconds*/
+   uint8_t chip; /* gpiochip device number */
+   uint8_t gpio; /* offset into gpio device */
+   uint8_t level; /* 0=low, 1=high, 2=watchdog */
+   uint8_t flags; /* 0 or LG_REPORT_LINE_INFO, ignore others */
+} lgGpioReport_t;
+
+typedef struct lgNotifyRing_s
+{
+   uint32_t magic;   /* LG_NOTIFY_RING_MAGIC */
+   uint32_t slots;   /* number of reports, a power of 2 */
+   uint64_t head;    /* reports written, only updated by the library */
+   uint64_t tail;    /* reports read, only updated by the reader */
+   uint64_t dropped; /* reports dropped because the ring was full */
+   uint32_t wake;    /* futex, bumped when a waiting reader is woken */
+   uint32_t waiting; /* set while the reader waits on wake */
+   uint8_t  pad[24]; /* reports start on a cache line */
+   lgGpioReport_t report[];
+} lgNotifyRing_t, *lgNotifyRing_p;
+
+/*
+   A capture file is a header, an index holding the timestamp of every
+   LG_CAPTURE_INDEX_INTERVAL'th report, and then the reports.  The file
+   is preallocated for capacity reports.
+*/
+typedef struct lgCaptureHeader_s
+{
+   uint32_t magic;         /* LG_CAPTURE_MAGIC */
+   uint32_t version;       /* LG_CAPTURE_VERSION */
+   uint64_t capacity;      /* reports the file can hold */
+   uint64_t count;         /* reports recorded */
+   uint64_t dropped;       /* reports not recorded, the file was full */
+   uint64_t indexOffset;   /* file offset of the uint64_t index */
+   uint64_t reportOffset;  /* file offset of the lgGpioReport_t reports */
+   uint32_t indexInterval; /* reports per index entry */
+   uint32_t indexEntries;  /* index entries in use */
+   uint8_t  pad[8];
+} lgCaptureHeader_t, *lgCaptureHeader_p;
+
 typedef struct
 {
    uint16_t state;
    int      fd;
    int      pipe_number;
    int      max_emits;
+   lgNotifyRing_p ring; /* NULL unless opened with lgNotifyOpenRing */
+   uint32_t ringSlots;  /* ring size, the ring's own copy may be changed */
+   uint64_t id;         /* unique, a reused handle has a new id */
+   lgCaptureHeader_p capture; /* NULL unless opened with lgNotifyOpenCapture */
+   int      format;     /* LG_NOTIFY_FORMAT_REPORT or _COMPACT */
+   int      pipeSize;   /* current pipe size, 0 if not a pipe */
+   int      pipeFixed;  /* pipe can not (or may not) grow */
+   uint32_t resizes;    /* times the pipe has been grown */
+   uint64_t sent;       /* reports delivered */
+   uint64_t dropped;    /* reports dropped, e.g. the reader was too slow */
+   int      filtered;   /* non-zero once lgNotifyFilter has been called */
+   int      chip;       /* filter gpiochip, -1 for any */
+   uint64_t gpioMask;   /* filter bit n set to deliver gpio n */
+   int      edgeMask;   /* filter LG_RISING_EDGE and/or LG_FALLING_EDGE */
+   int      decimation; /* filter deliver every nth edge per gpio */
+   int      decimChips; /* chips in decimCount */
+   uint32_t (*decimCount)[64]; /* edges since the last delivered, by chip */
 } lgNotify_t;
 
-typedef void (*callbk_t) ();
+typedef struct lgStreamRecord_s
+{
+   uint64_t timestamp; /* when the period's steps started */
+   uint32_t handle;    /* stream handle */
+   uint32_t seq;       /* period number, a gap means periods were missed */
+   int32_t  steps;     /* steps executed, or a negative error code */
+   uint32_t pad;
+} lgStreamRecord_t, *lgStreamRecord_p;
+
+typedef struct lgNotifyStats_s
+{
+   uint64_t sent;     /* reports delivered */
+   uint64_t dropped;  /* reports dropped because the reader fell behind */
+   uint32_t pipeSize; /* current pipe size in bytes, 0 if not a pipe */
+   uint32_t resizes;  /* times the pipe has been grown */
+} lgNotifyStats_t, *lgNotifyStats_p;
 
-typedef struct
+/*
+   Daemon statistics for one command.  bucket[0] counts executions
+   taking under 1 microsecond, bucket[n] those taking from 2^(n-1)
+   to 2^n microseconds.  The last bucket also counts anything slower.
+*/
+typedef struct lgCmdStats_s
 {
-   uint64_t timestamp; /* alert time in nanoseconds*/
-   uint8_t chip; /* gpiochip device number */
-   uint8_t gpio; /* offset into gpio device */
-   uint8_t level; /* 0=low, 1=high, 2=watchdog */
-   uint8_t flags; /* none defined, ignore report if non-zero */
-} lgGpioReport_t;
+   uint32_t cmd;        /* command number */
+   uint32_t pad;
+   uint64_t calls;      /* times executed */
+   uint64_t errors;     /* times a negative status was returned */
+   uint64_t totalNanos; /* summed execution time in nanoseconds */
+   uint64_t maxNanos;   /* longest execution time in nanoseconds */
+   uint64_t bucket[LG_STATS_BUCKETS];
+} lgCmdStats_t, *lgCmdStats_p;
+
+typedef void (*callbk_t) ();
 
 typedef struct lgGpioAlert_s
 {
@@ -551,6 +703,46 @@ if (status == LG_OKAY)
 D*/
 
 
+/*F*/
+int lgGpioGetChipLineInfo(int handle, int count, lgLineInfo_p lineInfo);
+/*D
+Returns information about every GPIO of a gpiochip.
+
+. .
+  handle: >= 0 (as returned by [*lgGpiochipOpen*])
+   count: the number of lgLineInfo_t objects at lineInfo
+lineInfo: A pointer to space for count lgLineInfo_t objects
+. .
+
+If OK returns the number of lines of the gpiochip and updates
+lineInfo for GPIO 0 to count-1 (or to the number of lines if less).
+
+On failure returns a negative error code.
+
+The information for each GPIO is as given by [*lgGpioGetLineInfo*].
+
+The first call for a gpiochip asks Linux to report any change to
+a line's status.  The information is then held by the library and
+kept up to date as the changes are reported, so later calls (and
+calls to [*lgGpioGetLineInfo*] and [*lgGpioGetMode*]) for the
+gpiochip do not need to query Linux.
+
+A count of 0 may be used to get the number of lines.
+
+...
+lgLineInfo_t lInfo[64];
+
+lines = lgGpioGetChipLineInfo(h, 64, lInfo);
+
+for (i=0; (i<lines) && (i<64); i++)
+{
+   printf("%d lFlags=%d name=%s user=%s\n",
+      lInfo[i].offset, lInfo[i].lFlags, lInfo[i].name, lInfo[i].user);
+}
+...
+D*/
+
+
 /*F*/
 int lgGpioGetMode(int handle, int gpio);
 /*D
@@ -1470,11 +1662,129 @@ u=456 ts=1602090898871503652 c=0 g=23 l=1 f=0 (3 of 3)
 . .
 D*/
 
+
+/*F*/
+int lgGpioSetAlertsQueue(int slots);
+/*D
+This chooses where the callbacks set by [*lgGpioSetAlertsFunc*] and
+[*lgGpioSetSamplesFunc*] are run.
+
+. .
+slots: 0 to run the callbacks on the alert thread (the default),
+       otherwise a power of 2 from 64 to 1048576
+. .
+
+If slots is 0 and OK returns 0.
+
+If slots is not 0 and OK returns a file descriptor (>= 0).
+
+On failure returns a negative error code.
+
+By default the callbacks are run by the thread which timestamps
+the alerts, so a slow callback delays the alerts for every GPIO.
+
+If slots is not 0 the alert thread instead adds the alerts to a
+queue of that many slots and signals the returned file descriptor
+(an eventfd).  The callbacks are run by [*lgGpioDispatchAlerts*]
+on whichever thread calls it, typically when the file descriptor
+becomes readable.
+
+The alert thread never waits for the queue.  Alerts which arrive
+while the queue is full are discarded.
+
+The file descriptor belongs to the library and must not be closed.
+The same descriptor is returned each time the queue is started.
+
+Any alerts queued when the queue is resized or stopped are discarded.
+
+...
+fd = lgGpioSetAlertsQueue(1024);
+
+pfd.fd = fd;
+pfd.events = POLLIN;
+
+while (1)
+{
+   if (poll(&pfd, 1, -1) > 0) lgGpioDispatchAlerts();
+}
+...
+D*/
+
+
+/*F*/
+int lgGpioDispatchAlerts(void);
+/*D
+This runs the callbacks for the alerts queued since the previous call.
+
+If OK returns the number of alerts dispatched.
+
+On failure returns a negative error code.
+
+The callbacks are called in the same order and with the same
+alerts as they would have been on the alert thread, although a
+large batch of alerts may be split over several calls.
+
+The callbacks are not called with any library lock held.  Only one
+thread dispatches at a time, a call made while another is
+dispatching (including from a callback) returns 0 at once.  A
+callback may call [*lgGpioSetAlertsQueue*], dispatching stops when
+it returns.
+D*/
+
+
+/*F*/
+int lgGpioSetLineInfoAlerts(int handle, int gpio, int enable, int nfyHandle);
+/*D
+This starts or stops alerts when a GPIO is claimed, released, or
+reconfigured by any user (including this process).
+
+. .
+   handle: >= 0 (as returned by [*lgGpiochipOpen*])
+     gpio: >= 0, as legal for the gpiochip
+   enable: 1 to start alerts, 0 to stop them
+nfyHandle: >= 0 (as returned by [*lgNotifyOpen*]) or -1
+. .
+
+If OK returns 0.
+
+On failure returns a negative error code.
+
+The GPIO does not need to be claimed.
+
+Each change is reported with flags set to LG_REPORT_LINE_INFO and
+level set to LG_LINE_REQUESTED, LG_LINE_RELEASED, or
+LG_LINE_RECONFIGURED.  The report is sent to the notification
+handle if nfyHandle is >= 0, and to any callbacks set with
+[*lgGpioSetAlertsFunc*] and [*lgGpioSetSamplesFunc*].
+
+Use [*lgGpioGetLineInfo*] to find the new user and flags.
+
+...
+lgGpioSetAlertsFunc(h, 23, afunc, &userdata);
+
+lgGpioSetLineInfoAlerts(h, 23, 1, -1); // callback on changes to GPIO 23
+...
+D*/
+
 /* Notifications API
 */
 
 void lgNotifyCloseOrphans(int slot, int fd);
+void lgNotifyReapClosing(void);
 int lgNotifyOpenWithSize(int pipeSize);
+int lgNotifyRingWrite(lgNotify_t *h, lgGpioReport_t *reports, int count);
+int lgNotifyWanted(lgNotify_t *h, lgGpioReport_t *report);
+int lgNotifySetFormat(int handle, int format);
+int lgNotifyEncodeCompact(
+   lgGpioReport_t *reports, int count, uint8_t *frame, int *bytes);
+void lgNotifyWrite(lgNotify_t *h, lgGpioReport_t *reports, int count);
+int lgNotifyWriteRecord(int handle, uint64_t id, uint8_t *frame, int bytes);
+uint64_t lgNotifyGetId(int handle);
+void lgNotifySetCloseHook(void (*hook)(uint64_t id));
+
+lgCaptureHeader_p lgCaptureCreate(const char *path, int maxReports, int *fd);
+int lgCaptureWrite(lgCaptureHeader_p capture, lgGpioReport_t *reports, int count);
+void lgCaptureClose(lgCaptureHeader_p capture);
 
 int  lgNotifyOpenInBand(int fd);
 
@@ -1552,7 +1862,7 @@ typedef struct
    uint8_t chip;       // gpiochip device number
    uint8_t gpio;       // offset into gpio device
    uint8_t level;      // 0=low, 1=high, 2=timeout
-   uint8_t flags;      // none currently defined
+   uint8_t flags;      // 0 or LG_REPORT_LINE_INFO
 } lgGpioReport_t;
 . .
 
@@ -1565,10 +1875,13 @@ as to the timestamp origin.
 
 level: indicates the level of the GPIO. 
  
-flags: no flags are currently defined.
+flags: 0 for a level or watchdog report.  LG_REPORT_LINE_INFO (1)
+for a line information change (see [*lgGpioSetLineInfoAlerts*]),
+in which case level is LG_LINE_REQUESTED (1), LG_LINE_RELEASED (2),
+or LG_LINE_RECONFIGURED (3).
 
 For future proofing it is probably best to ignore any notification
-with non-zero flags.
+with other flags.
 
 ...
 // Start notifications for associated GPIO.
@@ -1617,6 +1930,255 @@ lgNotifyClose(h);
 D*/
 
 
+/*F*/
+int lgNotifyFilter(
+   int handle, int chip, uint64_t gpioMask, int edgeMask, int decimation);
+/*D
+This function selects the reports delivered to a notification.
+
+. .
+    handle: >= 0 (as returned by [*lgNotifyOpen*])
+      chip: the gpiochip device number, or -1 for any gpiochip
+  gpioMask: bit n set to deliver reports for GPIO n
+  edgeMask: LG_RISING_EDGE, LG_FALLING_EDGE, LG_BOTH_EDGES, or 0
+decimation: 0 or 1 to deliver every edge, n to deliver every nth
+            edge of each GPIO
+. .
+
+If OK returns 0.
+
+On failure returns a negative error code.
+
+Reports which are not selected are discarded before they are
+written to the notification, so they cost the reader nothing.
+
+gpioMask can only select GPIO 0 to 63, so a filtered notification
+receives no reports for GPIO above 63.  A filter which selects
+everything (chip -1, every bit of gpioMask, LG_BOTH_EDGES and
+decimation 0 or 1) removes the filter.  Watchdog reports (level 2)
+and reports with non-zero flags are not affected by edgeMask or
+decimation.
+
+A notification initially receives every report.  Calling this
+function again replaces the filter and restarts decimation.
+
+...
+// only rising edges of GPIO 5 and 6 on gpiochip 0
+
+lgNotifyFilter(h, 0, (1<<5)|(1<<6), LG_RISING_EDGE, 0);
+...
+D*/
+
+
+/*F*/
+int lgNotifyGetStats(int handle, lgNotifyStats_p stats);
+/*D
+This function returns the delivery statistics of a notification.
+
+. .
+handle: >= 0 (as returned by [*lgNotifyOpen*])
+ stats: a pointer to a [*lgNotifyStats_t*] to receive the statistics
+. .
+
+If OK returns 0.
+
+On failure returns a negative error code.
+
+Reports are dropped when the reader does not keep up.  A pipe is
+grown when a write to it would otherwise drop reports, up to the
+limit set by /proc/sys/fs/pipe-max-size.
+D*/
+
+
+/*F*/
+int lgNotifyOpenRing(int slots);
+/*D
+This function requests a notification which is delivered through
+a shared memory ring rather than a pipe.
+
+. .
+slots: the number of reports the ring holds, a power of 2
+       from 16 to 1048576, or 0 for the default of 4096
+. .
+
+If OK returns a handle (>= 0).
+
+On failure returns a negative error code.
+
+The handle is used in the same way as one returned by
+[*lgNotifyOpen*].  Reports are added to the ring without a system
+call and are read with [*lgNotifyRingRead*], which only makes a
+system call when it needs to wait for reports.
+
+If the ring is full new reports are dropped and counted in the
+ring's dropped field.
+
+The ring is kept in an anonymous shared memory file.  Use
+[*lgNotifyRingFd*] to get a descriptor for it, which may be
+passed to another process, and [*lgNotifyRingMap*] to map it.
+
+...
+h = lgNotifyOpenRing(0);
+
+ring = lgNotifyRingMap(lgNotifyRingFd(h));
+
+lgGpioClaimAlert(gpiochip, 0, LG_BOTH_EDGES, 23, h);
+
+while (1)
+{
+   count = lgNotifyRingRead(ring, 64, reports, -1);
+
+   for (i=0; i<count; i++)
+   {
+      // process reports[i]
+   }
+}
+...
+D*/
+
+
+/*F*/
+int lgNotifyRingFd(int handle);
+/*D
+This function returns a file descriptor for the shared memory of
+a notification opened with [*lgNotifyOpenRing*].
+
+. .
+handle: >= 0 (as returned by [*lgNotifyOpenRing*])
+. .
+
+If OK returns a file descriptor (>= 0).
+
+On failure returns a negative error code.
+
+The descriptor is a duplicate owned by the caller, who should close
+it when it is no longer needed.
+D*/
+
+
+/*F*/
+lgNotifyRing_p lgNotifyRingMap(int fd);
+/*D
+This function maps the shared memory of a notification ring.
+
+. .
+fd: a file descriptor (as returned by [*lgNotifyRingFd*])
+. .
+
+If OK returns a pointer to the ring.
+
+On failure returns NULL.
+
+The descriptor may be closed once the ring is mapped.
+D*/
+
+
+/*F*/
+int lgNotifyRingUnmap(lgNotifyRing_p ring);
+/*D
+This function unmaps a notification ring.
+
+. .
+ring: a ring (as returned by [*lgNotifyRingMap*])
+. .
+
+If OK returns 0.
+
+On failure returns a negative error code.
+D*/
+
+
+/*F*/
+int lgNotifyRingRead(
+   lgNotifyRing_p ring, int count, lgGpioReport_t *reports, int timeout_ms);
+/*D
+This function reads reports from a notification ring.
+
+. .
+      ring: a ring (as returned by [*lgNotifyRingMap*])
+     count: the maximum number of reports to read
+   reports: an array to receive the reports
+timeout_ms: 0 to return at once, -1 to wait indefinitely, otherwise
+            the maximum number of milliseconds to wait for a report
+. .
+
+If OK returns the number of reports read (0 if none arrived).
+
+On failure returns a negative error code.
+
+Only one thread or process should read from a ring.
+
+The reports are as described for [*lgNotifyResume*].
+D*/
+
+
+/*F*/
+int lgNotifyOpenCapture(const char *path, int maxReports);
+/*D
+This function requests a notification whose reports are recorded
+to a file.
+
+. .
+      path: the file to create (any existing file is replaced)
+maxReports: the number of reports the file can hold, 1 to 268435456
+. .
+
+If OK returns a handle (>= 0).
+
+On failure returns a negative error code.
+
+The handle is used in the same way as one returned by
+[*lgNotifyOpen*], e.g. it may be passed to [*lgGpioClaimAlert*]
+and filtered with [*lgNotifyFilter*].
+
+The file is allocated in full when it is opened and is written
+through a shared memory mapping, so recording makes no system calls.
+Reports which arrive once the file is full are counted as dropped.
+
+The file starts with a [*lgCaptureHeader_t*] and may be read while
+it is being recorded.  It is complete once the handle is closed.
+
+...
+h = lgNotifyOpenCapture("edges.lgcap", 1000000);
+
+lgGpioClaimAlert(gpiochip, 0, LG_BOTH_EDGES, 23, h);
+
+sleep(10);
+
+lgNotifyClose(h);
+...
+D*/
+
+
+/*F*/
+int lgCaptureReplay(const char *path, uint64_t start, double speed);
+/*D
+This function replays a file recorded by [*lgNotifyOpenCapture*]
+to the function registered with [*lgGpioSetSamplesFunc*].
+
+. .
+ path: the capture file
+start: 0 to replay from the first report, otherwise the timestamp
+       of the first report to replay
+speed: 1.0 for the original timing, 2.0 for twice as fast, etc.,
+       or 0 to replay as fast as possible
+. .
+
+If OK returns the number of reports replayed.
+
+On failure returns a negative error code.
+
+No GPIO or gpiochip is needed.  The reports keep their recorded
+timestamps and are passed with a nfyHandle of -1.
+
+...
+lgGpioSetSamplesFunc(cbf, NULL);
+
+lgCaptureReplay("edges.lgcap", 0, 1.0);
+...
+D*/
+
+
 /* I2C API
 */
 
@@ -2976,6 +3538,12 @@ PARAMS*/
 #define LG_BAD_PWM_DUTY        -103 // bad PWM dutycycle
 #define LG_GPIO_NOT_AN_OUTPUT  -104 // GPIO not set as an output
 #define LG_INVALID_GROUP_ALERT -105 // can not set a group to alert
+#define LG_BAD_NOTIFY_SLOTS    -106 // bad notification ring slots
+#define LG_BAD_NOTIFY_FILTER   -107 // bad notification filter
+#define LG_BAD_CAPTURE         -108 // bad capture file or size
+#define LG_BAD_ALERTS_QUEUE    -109 // bad alerts queue size
+#define LG_BAD_BATCH           -110 // bad batch command or batch too large
+#define LG_BAD_STREAM          -111 // bad stream steps, period, or notification
 
 /*DEF_E*/
 
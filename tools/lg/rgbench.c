@@ -0,0 +1,1193 @@
+/*
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "lgpio.h"
+#include "rgpiod.h"
+
+#include "lgCmd.h"
+
+/*
+This program loads rgpiod with a mix of commands from several
+concurrent clients and reports the throughput and the latency
+percentiles of each command.
+
+Each client is a connection of its own.  It keeps a number of commands
+in flight (request ids are used so each reply is matched to its
+command) and picks each new command at random from the mix.
+
+Every client claims its own lines so that clients don't contend for
+them, line base+4*client as an output for GR and GW and the next three
+as an output group for GGR and GGW.  To run entirely on localhost use
+a simulated gpiochip, e.g.
+
+   sudo modprobe gpio-mockup gpio_mockup_ranges=-1,64
+
+and pass its number with -g.  SPIX transfers need a real spidev
+device whose MOSI is looped back to MISO (any device will do if the
+received data isn't of interest).  There is no simulated SPI
+controller to match gpio-mockup, so spix is not in the default mix.
+Without a spidev device its setup fails and SPI can't be measured.
+
+With -n each client also opens a compact in-band notification and a
+stream reading its line (or the tick if it has no lines) every period.
+The stream records' delivery latency is reported.
+
+rgpiod must be running without access control (no -x).
+*/
+
+#define RGBENCH_VERSION 0x00010000
+
+#define RGBENCH_OPTION_ERR 254
+#define RGBENCH_SETUP_ERR  253
+
+#define MAX_CLIENTS 256
+#define MAX_DEPTH   256
+#define MAX_SPI_BYTES 4096
+
+#define LINES_PER_CLIENT 4
+
+#define OP_TICK 0
+#define OP_GR   1
+#define OP_GW   2
+#define OP_GGR  3
+#define OP_GGW  4
+#define OP_SPIX 5
+#define OPS     6
+
+/*
+   Latencies are kept in histograms with 16 linear buckets per power of
+   two nanoseconds, so percentiles are within about 6%.
+*/
+#define HIST_SUB     16
+#define HIST_BUCKETS (64*HIST_SUB)
+
+typedef struct
+{
+   uint64_t count;
+   uint64_t max;
+   uint64_t bucket[HIST_BUCKETS];
+} hist_t;
+
+typedef struct
+{
+   uint64_t calls;
+   uint64_t errors;
+   int lastError;
+   hist_t hist;
+} opStats_t;
+
+typedef struct
+{
+   int op;
+   uint64_t start;
+} pending_t;
+
+typedef struct
+{
+   int id;
+   pthread_t thread;
+   pthread_t nfyThread;
+   int nfyRunning;
+   int sock;
+   int nfySock;
+   int chip;   /* gpiochip handle, -1 if none */
+   int spi;    /* SPI handle, -1 if none */
+   int nfy;    /* notification handle, -1 if none */
+   int stream; /* stream handle, -1 if none */
+   int line;   /* the single line, the group follows it */
+   uint32_t nextId;
+   unsigned seed;
+   uint64_t spiMismatches;
+   uint64_t records;
+   uint64_t missed;
+   uint32_t lastSeq;
+   hist_t recordHist;
+   opStats_t stats[OPS];
+   char *buf;
+} client_t;
+
+static char *xOpName[OPS] = {"tick", "gr", "gw", "ggr", "ggw", "spix"};
+
+static int optClients  = 4;
+static int optDepth    = 1;
+static double optSeconds = 5.0;
+static int optChip     = 0;
+static int optLine     = 0;
+static int optSpiDev   = 0;
+static int optSpiChan  = 0;
+static int optSpiSpeed = 8000000;
+static int optSpiBytes = 16;
+static int optPeriod   = 0;
+static int optWeight[OPS] = {1, 0, 0, 0, 0, 0};
+
+static int gTotalWeight;
+static volatile int gStop = 0;
+static volatile int gSetupFailed = 0;
+static pthread_barrier_t gBarrier;
+
+static char *xUsage = "\n\
+Usage: rgbench [options]\n\
+\n\
+   -b bytes     SPIX transfer size, default 16\n\
+   -c clients   concurrent client connections, default 4\n\
+   -d depth     commands in flight per client, default 1\n\
+   -f hz        SPI clock, default 8000000\n\
+   -g chip      gpiochip to use, default 0\n\
+   -l line      first line to use, default 0\n\
+   -m mix       command mix, default tick\n\
+   -n us        also stream a record to each client every us\n\
+   -s dev.chan  SPI device and channel, default 0.0\n\
+   -t seconds   test duration, default 5\n\
+   -v           print version and exit\n\
+\n\
+The mix is a comma separated list of commands, each optionally\n\
+followed by a colon and its relative weight (default 1).\n\
+The commands are tick, gr, gw, ggr, ggw, and spix.\n\
+\n\
+Client n uses lines line+4n to line+4n+3.\n\
+\n\
+spix needs a real spidev device with MOSI looped back to MISO,\n\
+there is no simulated one, so it is not in the default mix.\n\
+\n\
+The environment variables LG_ADDR and LG_PORT select the daemon\n\
+as for rgs.\n\
+\n\
+Examples\n\
+\n\
+rgbench -c 8 -d 4 -m gr:60,gw:30,ggr:10 -g 1\n\
+rgbench -c 2 -m spix -s 0.0 -b 64 -n 1000\n\
+\n";
+
+static void xFatal(int err, char *fmt, ...)
+{
+   char buf[128];
+   va_list ap;
+
+   va_start(ap, fmt);
+   vsnprintf(buf, sizeof(buf), fmt, ap);
+   va_end(ap);
+
+   fprintf(stderr, "%s\n", buf);
+
+   exit(err);
+}
+
+static uint64_t xNow(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return ((uint64_t)1E9 * ts.tv_sec) + ts.tv_nsec;
+}
+
+static uint64_t xRealNow(void)
+{
+   /* stream records are stamped with the real time */
+
+   struct timespec ts;
+
+   clock_gettime(CLOCK_REALTIME, &ts);
+
+   return ((uint64_t)1E9 * ts.tv_sec) + ts.tv_nsec;
+}
+
+static int xHistBucket(uint64_t ns)
+{
+   int msb;
+
+   if (ns < HIST_SUB) return ns;
+
+   msb = 63 - __builtin_clzll(ns);
+
+   return ((msb - 3) * HIST_SUB) + ((ns >> (msb - 4)) & (HIST_SUB - 1));
+}
+
+static uint64_t xHistValue(int b)
+{
+   /* the largest value in bucket b */
+
+   int shift;
+
+   if (b < HIST_SUB) return b;
+
+   shift = (b / HIST_SUB) - 1;
+
+   return ((uint64_t)(HIST_SUB + (b % HIST_SUB) + 1) << shift) - 1;
+}
+
+static void xHistAdd(hist_t *h, uint64_t ns)
+{
+   h->count++;
+   h->bucket[xHistBucket(ns)]++;
+   if (ns > h->max) h->max = ns;
+}
+
+static void xHistMerge(hist_t *to, hist_t *from)
+{
+   int b;
+
+   to->count += from->count;
+   if (from->max > to->max) to->max = from->max;
+   for (b=0; b<HIST_BUCKETS; b++) to->bucket[b] += from->bucket[b];
+}
+
+static double xHistPercentile(hist_t *h, double pc)
+{
+   /* microseconds */
+
+   uint64_t want, seen;
+   uint64_t v;
+   int b;
+
+   if (!h->count) return 0.0;
+
+   want = (h->count * pc) / 100.0;
+
+   if (want >= h->count) want = h->count - 1;
+
+   for (b=0, seen=0; b<HIST_BUCKETS; b++)
+   {
+      seen += h->bucket[b];
+      if (seen > want) break;
+   }
+
+   v = xHistValue(b);
+
+   if (v > h->max) v = h->max;
+
+   return v / 1000.0;
+}
+
+static int xOpenSocket(void)
+{
+   int sock, err, opt;
+   struct addrinfo hints, *res, *rp;
+   struct sockaddr_un unixAddr;
+   const char *addrStr, *portStr;
+
+   portStr = getenv(LG_ENVPORT);
+
+   if (!portStr) portStr = LG_DEFAULT_SOCKET_PORT_STR;
+
+   addrStr = getenv(LG_ENVADDR);
+
+   if (!addrStr) addrStr = LG_DEFAULT_SOCKET_ADDR_STR;
+
+   if (!strncmp(addrStr, LG_UNIX_ADDR_PREFIX, strlen(LG_UNIX_ADDR_PREFIX)))
+   {
+      addrStr += strlen(LG_UNIX_ADDR_PREFIX);
+
+      if (strlen(addrStr) >= sizeof(unixAddr.sun_path)) return -1;
+
+      memset(&unixAddr, 0, sizeof(unixAddr));
+      unixAddr.sun_family = AF_UNIX;
+      strcpy(unixAddr.sun_path, addrStr);
+
+      sock = socket(AF_UNIX, SOCK_STREAM, 0);
+
+      if (sock == -1) return -1;
+
+      if (connect(sock, (struct sockaddr *)&unixAddr, sizeof(unixAddr)) == -1)
+      {
+         close(sock);
+         return -1;
+      }
+
+      return sock;
+   }
+
+   memset (&hints, 0, sizeof (hints));
+
+   hints.ai_family   = PF_UNSPEC;
+   hints.ai_socktype = SOCK_STREAM;
+   hints.ai_flags   |= AI_CANONNAME;
+
+   err = getaddrinfo(addrStr, portStr, &hints, &res);
+
+   if (err) return -1;
+
+   for (rp=res; rp!=NULL; rp=rp->ai_next)
+   {
+      sock = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+
+      if (sock == -1) continue;
+
+      /* Disable the Nagle algorithm. */
+      opt = 1;
+      setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char*)&opt, sizeof(int));
+
+      if (connect(sock, rp->ai_addr, rp->ai_addrlen) != -1) break;
+
+      close(sock);
+   }
+
+   freeaddrinfo(res);
+
+   if (rp == NULL) return -1;
+
+   return sock;
+}
+
+static int xBuildCmd(
+   char *buf, int cmd, uint32_t id, int rids, void *ext, int extLen, int longs)
+{
+   /* lays out a command in buf, returns its length */
+
+   lgCmd_p h = (lgCmd_p)buf;
+   int pos = sizeof(lgCmd_t);
+
+   h->magic = LG_MAGIC;
+   h->size = extLen;
+   h->cmd = cmd;
+   h->doubles = 0;
+   h->longs = longs;
+   h->shorts = 0;
+
+   if (rids)
+   {
+      memcpy(buf+pos, &id, LG_CMD_ID_BYTES);
+      pos += LG_CMD_ID_BYTES;
+   }
+
+   if (extLen) memcpy(buf+pos, ext, extLen);
+
+   return pos + extLen;
+}
+
+static int xRecvReply(int sock, char *buf, int rids, uint32_t *id)
+{
+   /* receives a reply into buf, its extension follows the lgCmd_t */
+
+   lgCmd_p h = (lgCmd_p)buf;
+
+   if (recv(sock, h, sizeof(lgCmd_t), MSG_WAITALL) != sizeof(lgCmd_t))
+      return -1;
+
+   if (rids)
+   {
+      if (recv(sock, id, LG_CMD_ID_BYTES, MSG_WAITALL) != LG_CMD_ID_BYTES)
+         return -1;
+   }
+
+   if (h->size > CMD_MAX_EXTENSION) return -1;
+
+   if (h->size)
+   {
+      if (recv(sock, buf+sizeof(lgCmd_t), h->size, MSG_WAITALL) != h->size)
+         return -1;
+   }
+
+   return 0;
+}
+
+static int xCommand(
+   client_t *c, int sock, int cmd, void *ext, int extLen, int longs)
+{
+   /* sends a set up command and waits for its status */
+
+   int len, rids;
+   uint32_t id;
+
+   rids = (sock == c->sock);
+
+   len = xBuildCmd(c->buf, cmd, c->nextId, rids, ext, extLen, longs);
+
+   if (send(sock, c->buf, len, 0) != len) return -1;
+
+   if (xRecvReply(sock, c->buf, rids, &id) < 0) return -1;
+
+   if (rids && (id != c->nextId++)) return -1;
+
+   return ((lgCmd_p)c->buf)->status;
+}
+
+static int xSetup(client_t *c)
+{
+   int i, status, len, needLines;
+   uint32_t pars[8];
+   char stro[LG_STREAM_HDR_BYTES + LG_BATCH_HDR_BYTES + 64];
+   char *ext;
+   lgCmd_t h;
+
+   c->chip = -1;
+   c->spi = -1;
+   c->nfy = -1;
+   c->stream = -1;
+   c->nfySock = -1;
+   c->line = optLine + (c->id * LINES_PER_CLIENT);
+   c->seed = c->id + 1;
+
+   c->sock = xOpenSocket();
+
+   if (c->sock < 0)
+   {
+      fprintf(stderr, "client %d can't connect to rgpiod\n", c->id);
+      return -1;
+   }
+
+   /* request ids, the reply to this command has no id */
+
+   len = xBuildCmd(c->buf, LG_CMD_RIDS, 0, 0, NULL, 0, 0);
+
+   if ((send(c->sock, c->buf, len, 0) != len) ||
+       (xRecvReply(c->sock, c->buf, 0, NULL) < 0) ||
+       (((lgCmd_p)c->buf)->status < 0))
+   {
+      fprintf(stderr, "client %d: rgpiod doesn't support request ids\n",
+         c->id);
+      return -1;
+   }
+
+   needLines = optWeight[OP_GR] || optWeight[OP_GW] ||
+               optWeight[OP_GGR] || optWeight[OP_GGW];
+
+   if (needLines)
+   {
+      pars[0] = optChip;
+
+      status = xCommand(c, c->sock, LG_CMD_GO, pars, 4, 1);
+
+      if (status < 0)
+      {
+         fprintf(stderr, "client %d: gpiochip%d open failed (%s)\n",
+            c->id, optChip, lguErrorText(status));
+         return -1;
+      }
+
+      c->chip = status;
+
+      /* handle lFlags gpio value */
+      pars[0] = c->chip;
+      pars[1] = 0;
+      pars[2] = c->line;
+      pars[3] = 0;
+
+      status = xCommand(c, c->sock, LG_CMD_GSOX, pars, 16, 4);
+
+      if (status < 0)
+      {
+         fprintf(stderr, "client %d: claim of line %d failed (%s)\n",
+            c->id, c->line, lguErrorText(status));
+         return -1;
+      }
+
+      /* handle lFlags *gpios *values */
+      pars[0] = c->chip;
+      pars[1] = 0;
+      for (i=0; i<LINES_PER_CLIENT-1; i++)
+      {
+         pars[2+i] = c->line + 1 + i;
+         pars[2+LINES_PER_CLIENT-1+i] = 0;
+      }
+
+      len = 8 + (8 * (LINES_PER_CLIENT-1));
+
+      status = xCommand(c, c->sock, LG_CMD_GSGOX, pars, len, len/4);
+
+      if (status < 0)
+      {
+         fprintf(stderr, "client %d: claim of group %d failed (%s)\n",
+            c->id, c->line+1, lguErrorText(status));
+         return -1;
+      }
+   }
+
+   if (optWeight[OP_SPIX])
+   {
+      pars[0] = optSpiDev;
+      pars[1] = optSpiChan;
+      pars[2] = optSpiSpeed;
+      pars[3] = 0;
+
+      status = xCommand(c, c->sock, LG_CMD_SPIO, pars, 16, 4);
+
+      if (status < 0)
+      {
+         fprintf(stderr, "client %d: SPI %d.%d open failed (%s)\n",
+            c->id, optSpiDev, optSpiChan, lguErrorText(status));
+         return -1;
+      }
+
+      c->spi = status;
+   }
+
+   if (optPeriod)
+   {
+      c->nfySock = xOpenSocket();
+
+      if (c->nfySock < 0)
+      {
+         fprintf(stderr, "client %d can't connect to rgpiod\n", c->id);
+         return -1;
+      }
+
+      status = xCommand(c, c->nfySock, LG_CMD_NOIBC, NULL, 0, 0);
+
+      if (status < 0)
+      {
+         fprintf(stderr, "client %d: notification open failed (%s)\n",
+            c->id, lguErrorText(status));
+         return -1;
+      }
+
+      c->nfy = status;
+
+      /* nfy period count, then the steps laid out as a batch */
+
+      pars[0] = c->nfy;
+      pars[1] = optPeriod;
+      pars[2] = 0;
+
+      memset(stro, 0, sizeof(stro));
+      memcpy(stro, pars, LG_STREAM_HDR_BYTES);
+
+      ext = stro + LG_STREAM_HDR_BYTES + LG_BATCH_HDR_BYTES;
+
+      h.magic = LG_MAGIC;
+      h.doubles = 0;
+      h.shorts = 0;
+
+      if (c->chip >= 0)
+      {
+         h.cmd = LG_CMD_GR;
+         h.size = 8;
+         h.longs = 2;
+         memcpy(ext, &h, sizeof(h));
+         memcpy(ext+sizeof(h), &c->chip, 4);
+         memcpy(ext+sizeof(h)+4, &c->line, 4);
+      }
+      else
+      {
+         h.cmd = LG_CMD_TICK;
+         h.size = 0;
+         h.longs = 0;
+         memcpy(ext, &h, sizeof(h));
+      }
+
+      len = LG_STREAM_HDR_BYTES + LG_BATCH_HDR_BYTES +
+         LG_BATCH_PAD(sizeof(h) + h.size);
+
+      status = xCommand(c, c->sock, LG_CMD_STRO, stro, len, 3);
+
+      if (status < 0)
+      {
+         fprintf(stderr, "client %d: stream open failed (%s)\n",
+            c->id, lguErrorText(status));
+         return -1;
+      }
+
+      c->stream = status;
+   }
+
+   return 0;
+}
+
+static void xTeardown(client_t *c)
+{
+   uint32_t par;
+
+   if (c->sock >= 0)
+   {
+      if (c->stream >= 0)
+      {
+         par = c->stream;
+         xCommand(c, c->sock, LG_CMD_STRC, &par, 4, 1);
+      }
+
+      if (c->spi >= 0)
+      {
+         par = c->spi;
+         xCommand(c, c->sock, LG_CMD_SPIC, &par, 4, 1);
+      }
+
+      if (c->chip >= 0)
+      {
+         par = c->chip;
+         xCommand(c, c->sock, LG_CMD_GC, &par, 4, 1);
+      }
+
+      close(c->sock);
+   }
+
+   /* ends the notification and the thread reading it */
+   if (c->nfySock >= 0) shutdown(c->nfySock, SHUT_RDWR);
+}
+
+static int xGetVarint(uint8_t *buf, int size, uint64_t *val)
+{
+   /* returns the bytes used, 0 if more are needed, -1 if bad */
+
+   int i;
+   uint64_t v = 0;
+
+   for (i=0; (i<size) && (i<10); i++)
+   {
+      v |= (uint64_t)(buf[i] & 0x7f) << (7*i);
+
+      if (!(buf[i] & 0x80))
+      {
+         *val = v;
+         return i + 1;
+      }
+   }
+
+   return (i < 10) ? 0 : -1;
+}
+
+static void *pthRecords(void *x)
+{
+   /* reads the client's compact notification, timing stream records */
+
+   client_t *c = x;
+   uint8_t buf[2*LG_COMPACT_MAX_FRAME];
+   lgStreamRecord_t rec;
+   uint64_t len, now;
+   int got = 0;
+   int bytes, pos, n, m, record;
+
+   while (1)
+   {
+      bytes = recv(c->nfySock, buf+got, sizeof(buf)-got, 0);
+
+      if (bytes <= 0) break;
+
+      got += bytes;
+
+      now = xRealNow();
+
+      pos = 0;
+
+      while ((n = xGetVarint(buf+pos, got-pos, &len)) > 0)
+      {
+         /* an empty frame is followed by the length of a record */
+
+         record = (len == 0);
+
+         if (record)
+         {
+            m = xGetVarint(buf+pos+n, got-pos-n, &len);
+
+            if (m <= 0)
+            {
+               n = m;
+               break;
+            }
+
+            n += m;
+         }
+
+         if (len > LG_COMPACT_MAX_FRAME) n = -1;
+
+         if ((n < 0) || ((pos + n + len) > got)) break;
+
+         if (record && (len >= sizeof(rec)) && !gStop)
+         {
+            memcpy(&rec, buf+pos+n, sizeof(rec));
+
+            if (c->records && (rec.seq != c->lastSeq + 1))
+               c->missed += rec.seq - c->lastSeq - 1;
+
+            c->lastSeq = rec.seq;
+            c->records++;
+
+            xHistAdd(&c->recordHist,
+               (now > rec.timestamp) ? now - rec.timestamp : 0);
+         }
+
+         pos += n + len;
+      }
+
+      if (n < 0)
+      {
+         fprintf(stderr, "client %d: bad notification frame\n", c->id);
+         break;
+      }
+
+      got -= pos;
+
+      if (got && pos) memmove(buf, buf+pos, got);
+   }
+
+   return NULL;
+}
+
+static int xPickOp(client_t *c)
+{
+   int op, r;
+
+   r = rand_r(&c->seed) % gTotalWeight;
+
+   for (op=0; op<OPS-1; op++)
+   {
+      if (r < optWeight[op]) break;
+      r -= optWeight[op];
+   }
+
+   return op;
+}
+
+static int xSendOp(client_t *c, char *buf, int op, uint32_t id)
+{
+   uint32_t pars[3];
+   uint64_t parq[2];
+   char ext[16 + MAX_SPI_BYTES];
+   int i, len;
+
+   switch (op)
+   {
+      case OP_GR:
+         pars[0] = c->chip;
+         pars[1] = c->line;
+         len = xBuildCmd(buf, LG_CMD_GR, id, 1, pars, 8, 2);
+         break;
+
+      case OP_GW:
+         pars[0] = c->chip;
+         pars[1] = c->line;
+         pars[2] = id & 1;
+         len = xBuildCmd(buf, LG_CMD_GW, id, 1, pars, 12, 3);
+         break;
+
+      case OP_GGR:
+         pars[0] = c->chip;
+         pars[1] = c->line + 1;
+         len = xBuildCmd(buf, LG_CMD_GGR, id, 1, pars, 8, 2);
+         break;
+
+      case OP_GGW:
+         /* bitsQ maskQ handle group */
+         parq[0] = id;
+         parq[1] = (1 << (LINES_PER_CLIENT-1)) - 1;
+         memcpy(ext, parq, 16);
+         pars[0] = c->chip;
+         pars[1] = c->line + 1;
+         memcpy(ext+16, pars, 8);
+         len = xBuildCmd(buf, LG_CMD_GGWX, id, 1, ext, 24, 2);
+         ((lgCmd_p)buf)->doubles = 2;
+         break;
+
+      case OP_SPIX:
+         pars[0] = c->spi;
+         memcpy(ext, pars, 4);
+         for (i=0; i<optSpiBytes; i++) ext[4+i] = id + i;
+         len = xBuildCmd(buf, LG_CMD_SPIX, id, 1, ext, 4+optSpiBytes, 1);
+         break;
+
+      default:
+         len = xBuildCmd(buf, LG_CMD_TICK, id, 1, NULL, 0, 0);
+         break;
+   }
+
+   if (send(c->sock, buf, len, 0) != len) return -1;
+
+   return 0;
+}
+
+static void xCheckSpi(client_t *c, uint32_t id)
+{
+   /* a looped back transfer returns what was sent */
+
+   lgCmd_p h = (lgCmd_p)c->buf;
+   uint8_t *rx = (uint8_t *)&h[1];
+   int i;
+
+   if (h->size != optSpiBytes) {c->spiMismatches++; return;}
+
+   for (i=0; i<optSpiBytes; i++)
+   {
+      if (rx[i] != (uint8_t)(id + i))
+      {
+         c->spiMismatches++;
+         return;
+      }
+   }
+}
+
+static void *pthClient(void *x)
+{
+   client_t *c = x;
+   pending_t pending[MAX_DEPTH];
+   char out[sizeof(lgCmd_t) + LG_CMD_ID_BYTES + 16 + MAX_SPI_BYTES];
+   uint32_t sent, done, id;
+   opStats_t *s;
+   pending_t *p;
+   int status, broken;
+
+   if (xSetup(c) < 0)
+   {
+      gSetupFailed = 1;
+      gStop = 1;
+   }
+
+   /* the clock starts once every client is ready */
+   pthread_barrier_wait(&gBarrier);
+
+   if (gSetupFailed)
+   {
+      xTeardown(c);
+      return NULL;
+   }
+
+   if (c->nfySock >= 0)
+      c->nfyRunning =
+         (pthread_create(&c->nfyThread, NULL, pthRecords, c) == 0);
+
+   sent = c->nextId;
+   done = sent;
+   broken = 0;
+
+   while (!broken)
+   {
+      /* keep depth commands in flight until told to stop */
+
+      while (!gStop && ((sent - done) < optDepth))
+      {
+         p = &pending[sent % optDepth];
+
+         p->op = xPickOp(c);
+         p->start = xNow();
+
+         if (xSendOp(c, out, p->op, sent) < 0)
+         {
+            broken = 1;
+            break;
+         }
+
+         sent++;
+      }
+
+      if (broken || (sent == done)) break;
+
+      if (xRecvReply(c->sock, c->buf, 1, &id) < 0)
+      {
+         broken = 1;
+         break;
+      }
+
+      if (id != done)
+      {
+         fprintf(stderr, "client %d: reply %u, expected %u\n",
+            c->id, id, done);
+         broken = 1;
+         break;
+      }
+
+      p = &pending[done % optDepth];
+
+      done++;
+
+      if (gStop) continue; /* after the end of the measured time */
+
+      s = &c->stats[p->op];
+
+      xHistAdd(&s->hist, xNow() - p->start);
+
+      s->calls++;
+
+      status = ((lgCmd_p)c->buf)->status;
+
+      if (status < 0)
+      {
+         s->errors++;
+         s->lastError = status;
+      }
+      else if (p->op == OP_SPIX) xCheckSpi(c, id);
+   }
+
+   c->nextId = sent;
+
+   if (broken)
+   {
+      fprintf(stderr, "client %d: connection to rgpiod broke\n", c->id);
+      close(c->sock);
+      c->sock = -1;
+   }
+
+   xTeardown(c);
+
+   return NULL;
+}
+
+static void xParseMix(char *mix)
+{
+   char *tok, *colon;
+   int op, weight;
+
+   memset(optWeight, 0, sizeof(optWeight));
+
+   for (tok=strtok(mix, ","); tok; tok=strtok(NULL, ","))
+   {
+      weight = 1;
+
+      colon = strchr(tok, ':');
+
+      if (colon)
+      {
+         *colon = 0;
+         weight = atoi(colon+1);
+      }
+
+      for (op=0; op<OPS; op++) if (!strcasecmp(tok, xOpName[op])) break;
+
+      if ((op == OPS) || (weight < 0))
+         xFatal(RGBENCH_OPTION_ERR, "bad mix entry %s", tok);
+
+      optWeight[op] += weight;
+   }
+}
+
+static void xInitOpts(int argc, char *argv[])
+{
+   int opt;
+
+   opterr = 0;
+
+   while ((opt = getopt(argc, argv, "b:c:d:f:g:hl:m:n:s:t:v")) != -1)
+   {
+      switch (opt)
+      {
+         case 'b':
+            optSpiBytes = atoi(optarg);
+            if ((optSpiBytes < 1) || (optSpiBytes > MAX_SPI_BYTES))
+               xFatal(RGBENCH_OPTION_ERR,
+                  "SPI bytes must be 1-%d", MAX_SPI_BYTES);
+            break;
+
+         case 'c':
+            optClients = atoi(optarg);
+            if ((optClients < 1) || (optClients > MAX_CLIENTS))
+               xFatal(RGBENCH_OPTION_ERR,
+                  "clients must be 1-%d", MAX_CLIENTS);
+            break;
+
+         case 'd':
+            optDepth = atoi(optarg);
+            if ((optDepth < 1) || (optDepth > MAX_DEPTH))
+               xFatal(RGBENCH_OPTION_ERR, "depth must be 1-%d", MAX_DEPTH);
+            break;
+
+         case 'f':
+            optSpiSpeed = atoi(optarg);
+            break;
+
+         case 'g':
+            optChip = atoi(optarg);
+            break;
+
+         case 'h':
+            printf("%s", xUsage);
+            exit(0);
+
+         case 'l':
+            optLine = atoi(optarg);
+            break;
+
+         case 'm':
+            xParseMix(optarg);
+            break;
+
+         case 'n':
+            optPeriod = atoi(optarg);
+            if (optPeriod < LG_STREAM_MIN_PERIOD)
+               xFatal(RGBENCH_OPTION_ERR,
+                  "stream period must be at least %d us",
+                  LG_STREAM_MIN_PERIOD);
+            break;
+
+         case 's':
+            if (sscanf(optarg, "%d.%d", &optSpiDev, &optSpiChan) != 2)
+               xFatal(RGBENCH_OPTION_ERR, "SPI must be given as dev.chan");
+            break;
+
+         case 't':
+            optSeconds = atof(optarg);
+            if (optSeconds <= 0.0)
+               xFatal(RGBENCH_OPTION_ERR, "bad duration %s", optarg);
+            break;
+
+         case 'v':
+            printf("rgbench_%d.%d.%d.%d\n",
+               (RGBENCH_VERSION>>24)&0xff, (RGBENCH_VERSION>>16)&0xff,
+               (RGBENCH_VERSION>>8)&0xff, RGBENCH_VERSION&0xff);
+            exit(0);
+
+         default:
+            xFatal(RGBENCH_OPTION_ERR,
+               "bad option %c, rgbench -h for help", optopt);
+      }
+   }
+
+   for (opt=0, gTotalWeight=0; opt<OPS; opt++) gTotalWeight += optWeight[opt];
+
+   if (!gTotalWeight) xFatal(RGBENCH_OPTION_ERR, "the mix is empty");
+}
+
+static void xPrintHist(char *name, uint64_t calls, uint64_t errors, hist_t *h)
+{
+   printf("%-6s %10"PRIu64" %8"PRIu64" %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+      name, calls, errors,
+      xHistPercentile(h, 50.0), xHistPercentile(h, 90.0),
+      xHistPercentile(h, 99.0), xHistPercentile(h, 99.9),
+      h->max / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+   client_t *client;
+   opStats_t total[OPS];
+   hist_t all, records;
+   uint64_t calls, errors, mismatches, recs, missed;
+   uint64_t start, elapsed;
+   int i, op;
+
+   xInitOpts(argc, argv);
+
+   client = calloc(optClients, sizeof(client_t));
+
+   if (!client) xFatal(RGBENCH_SETUP_ERR, "no memory");
+
+   pthread_barrier_init(&gBarrier, NULL, optClients + 1);
+
+   for (i=0; i<optClients; i++)
+   {
+      client[i].id = i;
+      client[i].buf = malloc(sizeof(lgCmd_t) + CMD_MAX_EXTENSION + 1);
+
+      if (!client[i].buf) xFatal(RGBENCH_SETUP_ERR, "no memory");
+
+      pthread_create(&client[i].thread, NULL, pthClient, &client[i]);
+   }
+
+   pthread_barrier_wait(&gBarrier);
+
+   start = xNow();
+
+   while (!gStop && ((xNow() - start) < (optSeconds * 1E9))) usleep(10000);
+
+   elapsed = xNow() - start;
+
+   gStop = 1;
+
+   for (i=0; i<optClients; i++)
+   {
+      pthread_join(client[i].thread, NULL);
+      if (client[i].nfyRunning) pthread_join(client[i].nfyThread, NULL);
+      if (client[i].nfySock >= 0) close(client[i].nfySock);
+   }
+
+   if (gSetupFailed) return RGBENCH_SETUP_ERR;
+
+   memset(total, 0, sizeof(total));
+   memset(&all, 0, sizeof(all));
+   memset(&records, 0, sizeof(records));
+
+   mismatches = 0;
+   recs = 0;
+   missed = 0;
+
+   for (i=0; i<optClients; i++)
+   {
+      for (op=0; op<OPS; op++)
+      {
+         total[op].calls += client[i].stats[op].calls;
+         total[op].errors += client[i].stats[op].errors;
+         if (client[i].stats[op].errors)
+            total[op].lastError = client[i].stats[op].lastError;
+         xHistMerge(&total[op].hist, &client[i].stats[op].hist);
+      }
+
+      xHistMerge(&records, &client[i].recordHist);
+
+      mismatches += client[i].spiMismatches;
+      recs += client[i].records;
+      missed += client[i].missed;
+   }
+
+   calls = 0;
+   errors = 0;
+
+   for (op=0; op<OPS; op++)
+   {
+      calls += total[op].calls;
+      errors += total[op].errors;
+      xHistMerge(&all, &total[op].hist);
+   }
+
+   printf("%d clients, depth %d, %.1f seconds, %"PRIu64" commands, "
+      "%.0f per second\n",
+      optClients, optDepth, elapsed / 1E9, calls, calls / (elapsed / 1E9));
+
+   printf("%-6s %10s %8s %9s %9s %9s %9s %9s\n",
+      "cmd", "calls", "errors", "p50 us", "p90 us", "p99 us", "p99.9 us",
+      "max us");
+
+   for (op=0; op<OPS; op++)
+   {
+      if (optWeight[op])
+         xPrintHist(xOpName[op], total[op].calls, total[op].errors,
+            &total[op].hist);
+   }
+
+   xPrintHist("all", calls, errors, &all);
+
+   for (op=0; op<OPS; op++)
+   {
+      if (total[op].errors)
+         printf("%s: %s\n", xOpName[op], lguErrorText(total[op].lastError));
+   }
+
+   if (optWeight[OP_SPIX] && mismatches)
+      printf("spix: %"PRIu64" replies differed from the data sent "
+         "(is MOSI looped back to MISO?)\n", mismatches);
+
+   if (optPeriod)
+   {
+      printf("stream records %"PRIu64" (%.0f per second), missed %"PRIu64
+         ", delivery latency\n", recs, recs / (elapsed / 1E9), missed);
+
+      xPrintHist("record", recs, missed, &records);
+   }
+
+   return 0;
+}
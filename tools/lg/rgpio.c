@@ -40,6 +40,8 @@ For more information, please refer to <http://unlicense.org/>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <netinet/tcp.h>
 #include <sys/select.h>
 
@@ -58,6 +60,10 @@ For more information, please refer to <http://unlicense.org/>
 
 #define MAX_SBC 32
 
+#define PIPELINE_WINDOW 1024 /* most commands awaiting replies */
+#define MAX_EXTENTS 3        /* most extents passed to lg_command */
+#define MAX_CHANNELS 8       /* most command connections per sbc */
+
 typedef void (*CBF_t) ();
 
 struct callback_s
@@ -74,6 +80,52 @@ struct callback_s
    callback_t *next;
 };
 
+typedef struct
+{
+   int rids;         /* the daemon echoes request ids */
+   int probed;       /* LG_CMD_RIDS has been tried */
+   uint32_t nextId;
+   int active;       /* between pipeline_start and pipeline_stop */
+   uint32_t firstId; /* id of the first pipelined command */
+   int sent;         /* commands sent since pipeline_start */
+   int done;         /* replies received since pipeline_start */
+   int size;         /* entries in status */
+   int *status;
+} pipeline_t;
+
+typedef struct
+{
+   int active;       /* between lgu_batch_start and lgu_batch_stop */
+   int len;          /* bytes of buf used */
+   uint8_t *buf;     /* LG_CMD_BATCH extension being built */
+   int replyCount;   /* sub-commands executed by the last batch */
+   int replyLen;
+   int replySize;    /* bytes allocated for reply */
+   uint8_t *reply;   /* reply extension of the last batch */
+} batch_t;
+
+typedef struct
+{
+   int sock;
+   pthread_mutex_t mutex;
+   int cancelState;
+   uint8_t *msgBuf;  /* command header */
+   int frame;        /* largest command or reply, see LG_CMD_FRAME */
+   pipeline_t pipe;
+   batch_t batch;
+} channel_t;
+
+typedef struct stream_s stream_t;
+
+struct stream_s
+{
+   int sbc;
+   int handle;
+   StreamFunc_t f;
+   void *userdata;
+   stream_t *next;
+};
+
 typedef struct
 {
    size_t count; // number of elements
@@ -88,22 +140,28 @@ static int             gAbort = 0;
 
 static int             gPiInUse     [MAX_SBC];
 
-static int             gPigCommand  [MAX_SBC];
+static channel_t       gChan        [MAX_SBC][MAX_CHANNELS];
+static int             gChannels    [MAX_SBC];
+static int             gNextChannel [MAX_SBC];
+
+static __thread int    xThreadChan  [MAX_SBC]; /* channel+1 or 0 */
+
 static int             gPigHandle   [MAX_SBC];
 static int             gPigNotify   [MAX_SBC];
+static int             gPigCompact  [MAX_SBC];
+static int             gShare       [MAX_SBC]; /* the connection's own */
 
 static uint32_t        gLastLevel   [MAX_SBC];
 
 static pthread_t       *gPthNotify  [MAX_SBC];
 
-static pthread_mutex_t gCmdMutex    [MAX_SBC];
-static int             gCancelState [MAX_SBC];
-
-static uint8_t         *gMsgBuf     [MAX_SBC];
 
 static callback_t     *gCallBackFirst = 0;
 static callback_t     *gCallBackLast  = 0;
 
+static stream_t       *gStreamFirst = 0;
+static pthread_mutex_t gStreamMutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* PRIVATE ---------------------------------------------------------------- */
 
 static uint64_t xMakeSalt(void)
@@ -134,31 +192,122 @@ static void xSignalHandler(int signum)
    xStopAll();
 }
 
+static channel_t *xChan(int sbc)
+{
+   /*
+      Returns the calling thread's command channel.  Each thread keeps
+      the channel it is first given, threads are spread over the pool.
+   */
+
+   int i;
+
+   if (gChannels[sbc] <= 1) return &gChan[sbc][0];
+
+   i = xThreadChan[sbc] - 1;
+
+   if ((i < 0) || (i >= gChannels[sbc]))
+   {
+      i = __atomic_fetch_add(&gNextChannel[sbc], 1, __ATOMIC_RELAXED) %
+         gChannels[sbc];
+
+      xThreadChan[sbc] = i + 1;
+   }
+
+   return &gChan[sbc][i];
+}
+
+static int xSetThreadChan(int sbc, int chan)
+{
+   /* makes the calling thread use chan, returns the previous setting */
+
+   int old = xThreadChan[sbc];
+
+   xThreadChan[sbc] = chan + 1;
+
+   return old - 1;
+}
+
 static void _pml(int sbc)
 {
    int cancelState;
+   channel_t *chan = xChan(sbc);
 
    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancelState);
-   pthread_mutex_lock(&gCmdMutex[sbc]);
-   gCancelState[sbc] = cancelState;
+   pthread_mutex_lock(&chan->mutex);
+   chan->cancelState = cancelState;
 }
 
 static void _pmu(int sbc)
 {
    int cancelState;
+   channel_t *chan = xChan(sbc);
 
-   cancelState = gCancelState[sbc];
-   pthread_mutex_unlock(&gCmdMutex[sbc]);
+   cancelState = chan->cancelState;
+   pthread_mutex_unlock(&chan->mutex);
    pthread_setcancelstate(cancelState, NULL);
 }
 
+static int xPipeReply(int sbc, lgCmd_p h)
+{
+   /* receives a reply and records its status, the lock is held */
+
+   channel_t *chan = xChan(sbc);
+   pipeline_t *pipe = &chan->pipe;
+   uint32_t id, index;
+
+   if (recv(chan->sock, h, sizeof(lgCmd_t), MSG_WAITALL) !=
+      sizeof(lgCmd_t)) return lgif_bad_recv;
+
+   if (pipe->rids)
+   {
+      if (recv(chan->sock, &id, LG_CMD_ID_BYTES, MSG_WAITALL) !=
+         LG_CMD_ID_BYTES) return lgif_bad_recv;
+   }
+   else id = pipe->firstId + pipe->done; /* older daemons reply in order */
+
+   if (pipe->active)
+   {
+      index = id - pipe->firstId;
+
+      if (index < pipe->sent) pipe->status[index] = h->status;
+
+      pipe->done++;
+   }
+
+   return LG_OKAY;
+}
+
+static int xPipeDrain(int sbc, int outstanding)
+{
+   /* waits until at most outstanding commands await replies */
+
+   pipeline_t *pipe = &xChan(sbc)->pipe;
+   lgCmd_t h;
+   int status;
+
+   while ((pipe->sent - pipe->done) > outstanding)
+   {
+      status = xPipeReply(sbc, &h);
+
+      if (status < 0) return status;
+   }
+
+   return LG_OKAY;
+}
+
 static int lg_command
    (int sbc, int command, int extents, lgExtent_t *ext, int rl)
 {
-   int i;
+   int i, status;
    lgCmd_p h;
    uint8_t *p;
    size_t len;
+   channel_t *chan;
+   pipeline_t *pipe;
+   batch_t *batch;
+   int *newStatus;
+   struct iovec iov[1 + MAX_EXTENTS];
+   struct msghdr msg;
  
    if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
    {
@@ -173,7 +322,13 @@ static int lg_command
 
    _pml(sbc);
 
-   p = gMsgBuf[sbc];
+   chan = xChan(sbc);
+   pipe = &chan->pipe;
+   batch = &chan->batch;
+
+   /* msgBuf only holds the header, the extents are sent from place */
+
+   p = chan->msgBuf;
    
    h = (lgCmd_p) p;
 
@@ -186,11 +341,23 @@ static int lg_command
 
    p += sizeof(lgCmd_t);
 
+   if (pipe->rids && !batch->active)
+   {
+      memcpy(p, &pipe->nextId, LG_CMD_ID_BYTES);
+      p += LG_CMD_ID_BYTES;
+   }
+
+   iov[0].iov_base = chan->msgBuf;
+   iov[0].iov_len = p - chan->msgBuf;
+
+   len = iov[0].iov_len;
+
    for (i=0; i<extents; i++)
    {
       h->size += ext[i].size;
-      memcpy(p, ext[i].ptr, ext[i].size);
-      p += ext[i].size;
+      iov[i+1].iov_base = (void *)ext[i].ptr;
+      iov[i+1].iov_len = ext[i].size;
+      len += ext[i].size;
 
       switch(ext[i].bytes)
       {
@@ -208,18 +375,93 @@ static int lg_command
       }
    }
 
-   len = sizeof(lgCmd_t) + h->size;
-/*
-   printf("tx=%s\n", lgDbgStr2Hex(len, (char *)h));
-*/
-   if (send(gPigCommand[sbc], h, len, 0) != len)
+   if (batch->active)
+   {
+      /* queue the command, it is executed when the batch is sent */
+
+      if ((LG_BATCH_HDR_BYTES + batch->len + LG_BATCH_PAD(len)) <
+         (chan->frame - sizeof(lgCmd_t)))
+      {
+         p = batch->buf + batch->len;
+
+         for (i=0; i<=extents; i++)
+         {
+            memcpy(p, iov[i].iov_base, iov[i].iov_len);
+            p += iov[i].iov_len;
+         }
+
+         memset(p, 0, LG_BATCH_PAD(len) - len);
+         batch->len += LG_BATCH_PAD(len);
+         status = LG_OKAY;
+      }
+      else status = LG_BAD_BATCH;
+
+      if (rl) _pmu(sbc);
+
+      return status;
+   }
+
+   if ((sizeof(lgCmd_t) + h->size) >= chan->frame)
+   {
+      /* the daemon would drop the connection */
+      _pmu(sbc);
+      return lgif_bad_frame;
+   }
+
+   if (pipe->active)
+   {
+      /*
+         A command whose caller reads a reply extension (rl == 0) can't
+         be pipelined.  It waits for the earlier replies and then runs
+         as usual, but its status is still recorded.
+      */
+
+      status = xPipeDrain(sbc, rl ? PIPELINE_WINDOW-1 : 0);
+
+      if (status == LG_OKAY && (pipe->sent == pipe->size))
+      {
+         newStatus = realloc(pipe->status, 2 * pipe->size * sizeof(int));
+
+         if (newStatus != NULL)
+         {
+            pipe->status = newStatus;
+            pipe->size *= 2;
+         }
+         else status = lgif_bad_malloc;
+      }
+
+      if (status < 0)
+      {
+         _pmu(sbc);
+         return status;
+      }
+
+      pipe->status[pipe->sent] = lgif_bad_recv; /* until the reply */
+   }
+   memset(&msg, 0, sizeof(msg));
+   msg.msg_iov = iov;
+   msg.msg_iovlen = extents + 1;
+
+   if (sendmsg(chan->sock, &msg, 0) != len)
    {
       _pmu(sbc);
       return lgif_bad_send;
    }
 
-   if (recv(gPigCommand[sbc], h, sizeof(lgCmd_t), MSG_WAITALL) !=
-      sizeof(lgCmd_t))
+   pipe->nextId++;
+
+   if (pipe->active)
+   {
+      pipe->sent++;
+
+      if (rl)
+      {
+         _pmu(sbc);
+         return LG_OKAY;
+      }
+   }
+
+   if (xPipeReply(sbc, h) < 0)
    {
       _pmu(sbc);
       return lgif_bad_recv;
@@ -233,23 +475,33 @@ static int lg_command
 }
 
 
-static int lg_notify(int sbc)
+static int lg_notify(
+   int sbc, int cmd, const void *ext, int len, void *rxBuf, int rxLen)
 {
+   /*
+      Sends a command on the notification socket, only possible
+      before the notification is opened.  At most rxLen bytes of
+      any reply data are copied to rxBuf.
+   */
+
    lgCmd_t h;
+   uint8_t scratch[64];
+   int fetch, copy;
  
    if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
       return lgif_unconnected_sbc;
 
    h.magic = LG_MAGIC;
-   h.size = 0;
-   h.cmd = LG_CMD_NOIB;
+   h.size = len;
+   h.cmd = cmd;
    h.doubles = 0;
    h.longs = 0;
    h.shorts = 0;
 
    _pml(sbc);
 
-   if (send(gPigNotify[sbc], &h, sizeof(h), 0) != sizeof(h))
+   if ((send(gPigNotify[sbc], &h, sizeof(h), 0) != sizeof(h)) ||
+       (len && (send(gPigNotify[sbc], ext, len, 0) != len)))
    {
       _pmu(sbc);
       return lgif_bad_send;
@@ -261,6 +513,28 @@ static int lg_notify(int sbc)
       return lgif_bad_recv;
    }
 
+   while (h.size)
+   {
+      fetch = (h.size < sizeof(scratch)) ? h.size : sizeof(scratch);
+
+      if (recv(gPigNotify[sbc], scratch, fetch, MSG_WAITALL) != fetch)
+      {
+         _pmu(sbc);
+         return lgif_bad_recv;
+      }
+
+      copy = (fetch < rxLen) ? fetch : rxLen;
+
+      if (rxBuf && (copy > 0))
+      {
+         memcpy(rxBuf, scratch, copy);
+         rxBuf = (uint8_t *)rxBuf + copy;
+         rxLen -= copy;
+      }
+
+      h.size -= fetch;
+   }
+
    _pmu(sbc);
 
    return h.status;
@@ -309,11 +583,39 @@ static int lg_command_3(int sbc, int command, int p1, int p2, int p3, int rl)
 }
 
 
+static int lgOpenUnixSocket(const char *path)
+{
+   int sock;
+   struct sockaddr_un addr;
+
+   if (strlen(path) >= sizeof(addr.sun_path)) return lgif_bad_getaddrinfo;
+
+   memset(&addr, 0, sizeof(addr));
+
+   addr.sun_family = AF_UNIX;
+   strcpy(addr.sun_path, path);
+
+   sock = socket(AF_UNIX, SOCK_STREAM, 0);
+
+   if (sock == -1) return lgif_bad_socket;
+
+   if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+   {
+      close(sock);
+      return lgif_bad_connect;
+   }
+
+   return sock;
+}
+
 static int lgOpenSocket(const char *addrStr, const char *portStr)
 {
    int sock, err, opt;
    struct addrinfo hints, *res, *rp;
 
+   if (!strncmp(addrStr, LG_UNIX_ADDR_PREFIX, strlen(LG_UNIX_ADDR_PREFIX)))
+      return lgOpenUnixSocket(addrStr + strlen(LG_UNIX_ADDR_PREFIX));
+
    memset (&hints, 0, sizeof (hints));
 
    hints.ai_family   = PF_UNSPEC;
@@ -366,161 +668,547 @@ static void dispatch_notification(int sbc, lgGpioReport_t *r)
          p = p->next;
       }
    }
-   else /* no flags currently defined, ignore */
+   else /* e.g. LG_REPORT_LINE_INFO, not for edge callbacks */
    {
    }
 }
 
-static void *pthNotifyThread(void *x)
+static int xGetVarint(uint8_t *buf, int size, uint64_t *val)
 {
-   static int got = 0;
-   int sbc;
-   int bytes, r;
-   lgGpioReport_t report[LG_MAX_REPORTS_PER_READ];
+   /* returns bytes used, 0 if incomplete, -1 if invalid */
 
-   sbc = *((int*)x);
-   free(x); /* memory allocated in rgpiod_start */
+   int n;
 
-   while (1)
+   *val = 0;
+
+   for (n=0; n<size; n++)
    {
-      bytes = read(gPigNotify[sbc], (char*)&report+got, sizeof(report)-got);
+      if (n > 9) return -1;
 
-      if (bytes > 0) got += bytes;
-      else break;
+      *val |= (uint64_t)(buf[n] & 0x7f) << (7*n);
 
-      r = 0;
+      if (!(buf[n] & 0x80)) return n+1;
+   }
 
-      while (got >= sizeof(lgGpioReport_t))
-      {
-         dispatch_notification(sbc, &report[r]);
+   return 0;
+}
 
-         r++;
+static int xDecodeFrame(int sbc, uint8_t *buf, int size)
+{
+   static uint8_t level[LG_COMPACT_MAX_FRAME];
+   lgGpioReport_t r;
+   uint64_t val, count, run;
+   int pos, n, i, lvl;
 
-         got -= sizeof(lgGpioReport_t);
-      }
+   if ((n = xGetVarint(buf, size, &r.timestamp)) <= 0) return -1;
 
-      /* copy any partial report to start of array */
-      
-      if (got && r) report[0] = report[r];
-   }
+   pos = n;
 
-   fprintf(stderr, "notify thread for sbc %d broke with read error %d\n",
-      sbc, bytes);
+   while (pos < size)
+   {
+      if ((pos + 3) > size) return -1;
 
-   while (1) sleep(1);
+      r.chip  = buf[pos++];
+      r.gpio  = buf[pos++];
+      r.flags = buf[pos++];
 
-   return NULL;
-}
+      if ((n = xGetVarint(buf+pos, size-pos, &count)) <= 0) return -1;
+      pos += n;
 
-static int intCallback(
-   int sbc, int chip, int gpio, int edge, void *f, void *user)
-{
-   static int id = 0;
-   callback_t *p;
+      if (count > sizeof(level)) return -1;
 
-   /*
-   printf("sbc=%d chip=%d gpio=%d edge=%d f=%p u=%p\n",
-      sbc, chip, gpio, edge, f, user);
-   */
+      for (i=0; i<count; )
+      {
+         if (pos >= size) return -1;
 
-   if ((chip < 64) && (gpio < 64) && (edge <= 3) && f)
-   {
-      /* prevent duplicates */
+         lvl = buf[pos++];
 
-      p = gCallBackFirst;
+         if ((n = xGetVarint(buf+pos, size-pos, &run)) <= 0) return -1;
+         pos += n;
 
-      while (p)
-      {
-         if ((p->sbc  == sbc)  &&
-             (p->chip == chip) &&
-             (p->gpio == gpio) &&
-             (p->edge == edge) &&
-             (p->f    == f))
+         if ((run == 0) || (run > (count - i))) return -1;
+
+         while (run--)
          {
-            return lgif_duplicate_callback;
+            level[i++] = lvl & ~LG_COMPACT_ALTERNATE;
+            if (lvl & LG_COMPACT_ALTERNATE) lvl ^= 1;
          }
-         p = p->next;
       }
 
-      p = malloc(sizeof(callback_t));
-
-      if (p)
+      for (i=0; i<count; i++)
       {
-         if (!gCallBackFirst) gCallBackFirst = p;
-
-         p->id = id++;
-         p->sbc = sbc;
-         p->chip = chip;
-         p->gpio = gpio;
-         p->edge = edge;
-         p->f = f;
-         p->user = user;
-         p->next = 0;
-         p->prev = gCallBackLast;
+         if ((n = xGetVarint(buf+pos, size-pos, &val)) <= 0) return -1;
+         pos += n;
 
-         if (p->prev) (p->prev)->next = p;
-         gCallBackLast = p;
+         /* undo the zigzag encoding */
+         r.timestamp += (val >> 1) ^ -(val & 1);
+         r.level = level[i];
 
-         return p->id;
+         dispatch_notification(sbc, &r);
       }
-
-      return lgif_bad_malloc;
    }
 
-   return lgif_bad_callback;
+   return 0;
 }
 
-static int recvMax(int sbc, void *buf, int bufsize, int sent)
+static int xDecodeRecord(int sbc, uint8_t *buf, int size)
 {
-   /*
-   Copy at most bufSize bytes from the receieved message to
-   buf (if buf non-null).  Discard the rest of the message.
-   */
-   uint8_t scratch[4096];
-   int remaining, fetch, count;
+   /* a stream record, the step replies are laid out as in a batch */
 
-   remaining = sent;
+   lgStreamRecord_t rec;
+   lgStreamStep_t step[LG_STREAM_MAX_STEPS];
+   lgCmd_t sub;
+   stream_t *p;
+   StreamFunc_t f = NULL;
+   void *userdata = NULL;
+   int pos, i;
 
-   if (sent < bufsize) count = sent; else count = bufsize;
+   if (size < sizeof(rec)) return -1;
 
-   if (count && buf)
+   memcpy(&rec, buf, sizeof(rec));
+
+   pos = sizeof(rec);
+
+   for (i=0; (i<rec.steps) && (i<LG_STREAM_MAX_STEPS); i++)
    {
-      recv(gPigCommand[sbc], buf, count, MSG_WAITALL);
-      remaining -= count;
+      if ((size - pos) < sizeof(lgCmd_t)) return -1;
 
-/*
-      printf("recvMax(bs=%d sent=%d): %s\n",
-         bufsize, sent, lgDbgStr2Hex(count, (unsigned char *)buf));
-*/
+      memcpy(&sub, buf+pos, sizeof(sub));
+
+      if (sub.size > (size - pos - sizeof(lgCmd_t))) return -1;
+
+      step[i].status = sub.status;
+      step[i].size = sub.size;
+      step[i].data = buf + pos + sizeof(lgCmd_t);
+
+      pos += LG_BATCH_PAD(sizeof(lgCmd_t) + sub.size);
    }
 
-   while (remaining)
+   pthread_mutex_lock(&gStreamMutex);
+
+   for (p=gStreamFirst; p; p=p->next)
    {
-      fetch = remaining;
-      if (fetch > sizeof(scratch)) fetch = sizeof(scratch);
-      recv(gPigCommand[sbc], scratch, fetch, MSG_WAITALL);
-      remaining -= fetch;
+      if ((p->sbc == sbc) && (p->handle == rec.handle))
+      {
+         f = p->f;
+         userdata = p->userdata;
+         break;
+      }
    }
 
-   return count;
-}
+   pthread_mutex_unlock(&gStreamMutex);
 
-/* PUBLIC ----------------------------------------------------------------- */
+   if (f) f(sbc, rec.handle, rec.seq, rec.timestamp, rec.steps, step, userdata);
 
-/* START/STOP */
+   return 0;
+}
 
-int rgpiod_start(const char *addrStr, const char *portStr)
+static void xStreamForget(int sbc, int handle)
 {
-   static int xInited = 0;
-   int sbc;
-   int *userdata;
-   struct sigaction new_action, old_action;
+   /* handle -1 forgets all the sbc's streams */
+
+   stream_t *p, **pp;
+
+   pthread_mutex_lock(&gStreamMutex);
+
+   pp = &gStreamFirst;
+
+   while ((p = *pp))
+   {
+      if ((p->sbc == sbc) && ((handle < 0) || (p->handle == handle)))
+      {
+         *pp = p->next;
+         free(p);
+      }
+      else pp = &p->next;
+   }
+
+   pthread_mutex_unlock(&gStreamMutex);
+}
+
+static void xNotifyCompact(int sbc)
+{
+   uint8_t buf[2*LG_COMPACT_MAX_FRAME];
+   uint64_t len;
+   int got = 0;
+   int bytes, pos, n, m, record, err;
+
+   while (1)
+   {
+      bytes = read(gPigNotify[sbc], buf+got, sizeof(buf)-got);
+
+      if (bytes > 0) got += bytes;
+      else
+      {
+         fprintf(stderr, "notify thread for sbc %d broke with read error %d\n",
+            sbc, bytes);
+         break;
+      }
+
+      pos = 0;
+
+      while ((n = xGetVarint(buf+pos, got-pos, &len)) > 0)
+      {
+         /* an empty frame is followed by the length of a record */
+
+         record = (len == 0);
+
+         if (record)
+         {
+            m = xGetVarint(buf+pos+n, got-pos-n, &len);
+
+            if (m <= 0)
+            {
+               n = m;
+               break;
+            }
+
+            n += m;
+         }
+
+         if (len > LG_COMPACT_MAX_FRAME) n = -1;
+
+         if ((n < 0) || ((pos + n + len) > got)) break;
+
+         if (record) err = xDecodeRecord(sbc, buf+pos+n, len);
+         else        err = xDecodeFrame(sbc, buf+pos+n, len);
+
+         if (err < 0)
+         {
+            n = -1;
+            break;
+         }
+
+         pos += n + len;
+      }
+
+      if (n < 0)
+      {
+         fprintf(stderr, "notify thread for sbc %d got a bad frame\n", sbc);
+         break;
+      }
+
+      /* move any partial frame to the start of the buffer */
+
+      got -= pos;
+
+      if (got && pos) memmove(buf, buf+pos, got);
+   }
+}
+
+static void *pthNotifyThread(void *x)
+{
+   static int got = 0;
+   int sbc;
+   int bytes, r;
+   lgGpioReport_t report[LG_MAX_REPORTS_PER_READ];
+
+   sbc = *((int*)x);
+   free(x); /* memory allocated in rgpiod_start */
+
+   if (gPigCompact[sbc])
+   {
+      xNotifyCompact(sbc);
+
+      while (1) sleep(1);
+   }
+
+   while (1)
+   {
+      bytes = read(gPigNotify[sbc], (char*)&report+got, sizeof(report)-got);
+
+      if (bytes > 0) got += bytes;
+      else break;
+
+      r = 0;
+
+      while (got >= sizeof(lgGpioReport_t))
+      {
+         dispatch_notification(sbc, &report[r]);
+
+         r++;
+
+         got -= sizeof(lgGpioReport_t);
+      }
+
+      /* copy any partial report to start of array */
+      
+      if (got && r) report[0] = report[r];
+   }
+
+   fprintf(stderr, "notify thread for sbc %d broke with read error %d\n",
+      sbc, bytes);
+
+   while (1) sleep(1);
+
+   return NULL;
+}
+
+static void xCallbackFilter(int sbc)
+{
+   callback_t *p;
+   int chip = -2;
+   int all = 0;
+   uint64_t gpioMask = 0;
+
+   /*
+      Ask the daemon to only send the reports the callbacks for
+      this sbc can use.
+   */
+
+   if (gPigHandle[sbc] < 0) return;
+
+   p = gCallBackFirst;
+
+   while (p)
+   {
+      if (p->sbc == sbc)
+      {
+         if (chip == -2) chip = p->chip;
+         else if (chip != p->chip) chip = -1;
+
+         /* the mask only covers gpios 0-63, otherwise don't filter */
+
+         if ((p->gpio >= 0) && (p->gpio < 64))
+            gpioMask |= ((uint64_t)1 << p->gpio);
+         else
+            all = 1;
+      }
+      p = p->next;
+   }
+
+   if (chip == -2) chip = -1;
+
+   if (all)
+   {
+      chip = -1;
+      gpioMask = ~(uint64_t)0;
+   }
+
+   notify_filter(sbc, gPigHandle[sbc], chip, gpioMask, BOTH_EDGES, 0);
+}
+
+static int intCallback(
+   int sbc, int chip, int gpio, int edge, void *f, void *user)
+{
+   static int id = 0;
+   callback_t *p;
+
+   /*
+   printf("sbc=%d chip=%d gpio=%d edge=%d f=%p u=%p\n",
+      sbc, chip, gpio, edge, f, user);
+   */
+
+   if ((chip < 64) && (gpio < 64) && (edge <= 3) && f)
+   {
+      /* prevent duplicates */
+
+      p = gCallBackFirst;
+
+      while (p)
+      {
+         if ((p->sbc  == sbc)  &&
+             (p->chip == chip) &&
+             (p->gpio == gpio) &&
+             (p->edge == edge) &&
+             (p->f    == f))
+         {
+            return lgif_duplicate_callback;
+         }
+         p = p->next;
+      }
+
+      p = malloc(sizeof(callback_t));
+
+      if (p)
+      {
+         if (!gCallBackFirst) gCallBackFirst = p;
+
+         p->id = id++;
+         p->sbc = sbc;
+         p->chip = chip;
+         p->gpio = gpio;
+         p->edge = edge;
+         p->f = f;
+         p->user = user;
+         p->next = 0;
+         p->prev = gCallBackLast;
+
+         if (p->prev) (p->prev)->next = p;
+         gCallBackLast = p;
+
+         xCallbackFilter(sbc);
+
+         return p->id;
+      }
+
+      return lgif_bad_malloc;
+   }
+
+   return lgif_bad_callback;
+}
+
+static int recvMax(int sbc, void *buf, int bufsize, int sent)
+{
+   /*
+   Copy at most bufSize bytes from the receieved message to
+   buf (if buf non-null).  Discard the rest of the message,
+   without copying it where the socket allows (MSG_TRUNC).
+   */
+   uint8_t scratch[4096];
+   int remaining, fetch, count;
+
+   remaining = sent;
+
+   if (sent < bufsize) count = sent; else count = bufsize;
+
+   if (count && buf)
+   {
+      recv(xChan(sbc)->sock, buf, count, MSG_WAITALL);
+      remaining -= count;
+
+/*
+      printf("recvMax(bs=%d sent=%d): %s\n",
+         bufsize, sent, lgDbgStr2Hex(count, (unsigned char *)buf));
+*/
+   }
+
+   while (remaining)
+   {
+      fetch = remaining;
+      if (fetch > sizeof(scratch)) fetch = sizeof(scratch);
+      recv(xChan(sbc)->sock, scratch, fetch, MSG_WAITALL | MSG_TRUNC);
+      remaining -= fetch;
+   }
+
+   return count;
+}
+
+static int xSetUser(
+   int sbc, int notify, const char *user, const char *secretFile)
+{
+   /* notify sets the user of the notification socket */
+
+   lgExtent_t ext[1];
+   int len;
+   int bytes;
+   char hash[34];
+   char salt1[LG_SALT_LEN];
+   char salt2[LG_SALT_LEN];
+   char buf[64];
+
+   hash[0] = 0;
+
+   if (!user || strlen(user) == 0) user = LG_DEFAULT_USER;
+
+   snprintf(salt1, LG_SALT_LEN, "%015"PRIx64, xMakeSalt());
+   sprintf(buf, "%s.%s", salt1, user);
+
+   len = strlen(buf);
+
+   ext[0].size = len;
+   ext[0].count = len;
+   ext[0].bytes = 1;
+   ext[0].ptr = buf;
+
+   if (notify)
+   {
+      bytes = lg_notify(sbc, LG_CMD_USER, buf, len, salt2, LG_SALT_LEN);
+
+      if (bytes < 0) return bytes;
+   }
+   else
+   {
+      bytes = lg_command(sbc, LG_CMD_USER, 1, ext, 0);
+
+      if (bytes < 0) return bytes;
+
+      recvMax(sbc, salt2, LG_SALT_LEN, bytes);
+
+      _pmu(sbc);
+   }
+
+   lgMd5UserHash(user, salt1, salt2, secretFile, hash);
+
+   len = strlen(hash);
+
+   ext[0].size = len;
+   ext[0].count = len;
+   ext[0].bytes = 1;
+   ext[0].ptr = hash;
+
+   if (notify) return lg_notify(sbc, LG_CMD_PASSW, hash, len, NULL, 0);
+
+   return lg_command(sbc, LG_CMD_PASSW, 1, ext, 1);
+}
+
+/* PUBLIC ----------------------------------------------------------------- */
+
+static int xChanOpen(int sbc, int i, const char *addrStr, const char *portStr)
+{
+   channel_t *chan = &gChan[sbc][i];
+
+   chan->sock = lgOpenSocket(addrStr, portStr);
+
+   if (chan->sock < 0) return chan->sock;
+
+   chan->msgBuf = malloc(sizeof(lgCmd_t) + LG_CMD_ID_BYTES);
+   chan->frame = CMD_MAX_EXTENSION;
+
+   if (chan->msgBuf == NULL) return lgif_bad_malloc;
+
+   return chan->sock;
+}
+
+static int xConnShare(int sbc)
+{
+   /*
+      Handles opened on one channel, and the notification, must be
+      usable on the others.  The share id is only known to this
+      process and the handles are still freed when the channel which
+      opened them is closed.
+   */
+
+   int i, old, status = LG_OKAY;
+
+   old = xSetThreadChan(sbc, 0);
+
+   for (i=0; (i<gChannels[sbc]) && (status >= 0); i++)
+   {
+      xSetThreadChan(sbc, i);
+      status = lg_command_2(
+         sbc, LG_CMD_SHARE, gShare[sbc], LG_SHARE_TRANSIENT, 1);
+   }
+
+   xSetThreadChan(sbc, old);
+
+   return status;
+}
+
+/* START/STOP */
+
+int rgpiod_start(const char *addrStr, const char *portStr)
+   {return rgpiod_start_pool(addrStr, portStr, 1);}
+
+int rgpiod_start_pool(const char *addrStr, const char *portStr, int channels)
+{
+   static int xInited = 0;
+   int sbc, i, status;
+   int *userdata;
+   struct sigaction new_action, old_action;
    const char *userStr;
+   uint32_t shareArgs[2];
 
    if (!xInited)
    {
       for (sbc=0; sbc<MAX_SBC; sbc++)
-         pthread_mutex_init(&gCmdMutex[sbc], NULL);
+      {
+         for (i=0; i<MAX_CHANNELS; i++)
+         {
+            pthread_mutex_init(&gChan[sbc][i].mutex, NULL);
+            gChan[sbc][i].sock = -1;
+         }
+      }
 
       /* Set up the structure to specify the new action. */
       new_action.sa_handler = xSignalHandler;
@@ -571,15 +1259,46 @@ int rgpiod_start(const char *addrStr, const char *portStr)
       }
    }
 
-   gPigCommand[sbc] = lgOpenSocket(addrStr, portStr);
+   if (channels < 1) channels = 1;
+   if (channels > MAX_CHANNELS) channels = MAX_CHANNELS;
 
-   if (gPigCommand[sbc] >= 0)
+   gChannels[sbc] = 1;
+
+   status = xChanOpen(sbc, 0, addrStr, portStr);
+
+   if (status >= 0)
    {
       gPigNotify[sbc] = lgOpenSocket(addrStr, portStr);
 
       if (gPigNotify[sbc] >= 0)
       {
-         gPigHandle[sbc] = lg_notify(sbc);
+         /*
+            The notification is opened for the connection's user and
+            share id so the channels may use it, e.g. for streams.
+         */
+
+         gShare[sbc] = (xMakeSalt() & 0x7fffffff) | 1;
+
+         shareArgs[0] = gShare[sbc];
+         shareArgs[1] = LG_SHARE_TRANSIENT;
+
+         status = lg_notify(
+            sbc, LG_CMD_SHARE, shareArgs, sizeof(shareArgs), NULL, 0);
+
+         if (status < 0) return status;
+
+         userStr = getenv(LG_ENVUSER);
+
+         if (userStr && strlen(userStr)) xSetUser(sbc, 1, userStr, NULL);
+
+         /* prefer the compact format, older daemons only have NOIB */
+
+         gPigHandle[sbc] = lg_notify(sbc, LG_CMD_NOIBC, NULL, 0, NULL, 0);
+
+         gPigCompact[sbc] = (gPigHandle[sbc] >= 0);
+
+         if (gPigHandle[sbc] == LG_UNKNOWN_COMMAND)
+            gPigHandle[sbc] = lg_notify(sbc, LG_CMD_NOIB, NULL, 0, NULL, 0);
 
          if (gPigHandle[sbc] < 0) return lgif_bad_noib;
          else
@@ -594,31 +1313,47 @@ int rgpiod_start(const char *addrStr, const char *portStr)
 
             if (gPthNotify[sbc])
             {
-               gMsgBuf[sbc] = malloc(CMD_MAX_EXTENSION);
-
-               if (gMsgBuf[sbc] != NULL)
+               for (i=1; i<channels; i++)
                {
-                  userStr = getenv(LG_ENVUSER);
+                  status = xChanOpen(sbc, i, addrStr, portStr);
 
-                  if (userStr && strlen(userStr))
+                  gChannels[sbc] = i + 1;
+
+                  if (status < 0)
                   {
-                     lgu_set_user(sbc, userStr, NULL);
+                     rgpiod_stop(sbc);
+                     return status;
                   }
+               }
 
-                  return sbc;
+               if (userStr && strlen(userStr))
+               {
+                  lgu_set_user(sbc, userStr, NULL);
+               }
+
+               status = xConnShare(sbc);
+
+               if (status < 0)
+               {
+                  rgpiod_stop(sbc);
+                  return status;
                }
-               else return lgif_bad_malloc;
+
+               return sbc;
             }
             else return lgif_notify_failed;
          }
       }
       else return gPigNotify[sbc];
    }
-   else return gPigCommand[sbc];
+   else return status;
 }
 
 void rgpiod_stop(int sbc)
 {
+   int i;
+   channel_t *chan;
+
    if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc]) return;
 
    if (gPthNotify[sbc])
@@ -627,7 +1362,7 @@ void rgpiod_stop(int sbc)
       gPthNotify[sbc] = 0;
    }
 
-   if (gPigCommand[sbc] >= 0)
+   if (gChan[sbc][0].sock >= 0)
    {
       //lg_command_0(sbc, LG_CMD_FREE, 1);
 
@@ -636,9 +1371,6 @@ void rgpiod_stop(int sbc)
          //lg_command_1(sbc, LG_CMD_NC, gPigHandle[sbc], 1);
          gPigHandle[sbc] = -1;
       }
-
-      close(gPigCommand[sbc]);
-      gPigCommand[sbc] = -1;
    }
 
    if (gPigNotify[sbc] >= 0)
@@ -647,11 +1379,38 @@ void rgpiod_stop(int sbc)
       gPigNotify[sbc] = -1;
    }
 
-   _pml(sbc);
-   gPiInUse[sbc] = 0;
-   free(gMsgBuf[sbc]);
-   gMsgBuf[sbc] = NULL;
-   _pmu(sbc);
+   xStreamForget(sbc, -1);
+
+   for (i=gChannels[sbc]-1; i>=0; i--)
+   {
+      /* channel 0 last as its lock also guards gPiInUse */
+
+      chan = &gChan[sbc][i];
+
+      pthread_mutex_lock(&chan->mutex);
+
+      if (chan->sock >= 0)
+      {
+         close(chan->sock);
+         chan->sock = -1;
+      }
+
+      free(chan->msgBuf);
+      chan->msgBuf = NULL;
+      free(chan->pipe.status);
+      memset(&chan->pipe, 0, sizeof(pipeline_t));
+      free(chan->batch.buf);
+      free(chan->batch.reply);
+      memset(&chan->batch, 0, sizeof(batch_t));
+
+      if (i == 0)
+      {
+         gChannels[sbc] = 0;
+         gPiInUse[sbc] = 0;
+      }
+
+      pthread_mutex_unlock(&chan->mutex);
+   }
 }
 
 
@@ -970,6 +1729,20 @@ int gpio_set_watchdog_time(int sbc, int handle, int gpio, int watchdog_us)
       sbc, LG_CMD_GWDOG, handle&0xffff, gpio, watchdog_us, 1);
 }
 
+int gpio_set_line_info_alerts(
+   int sbc, int handle, int gpio, int enable, int nfyHandle)
+{
+   lgExtent_t ext[1];
+   uint32_t pars[] = {handle&0xffff, gpio, enable, nfyHandle};
+
+   ext[0].size = sizeof(pars);
+   ext[0].count = sizeof(pars)/sizeof(pars[0]);
+   ext[0].bytes = sizeof(pars[0]);
+   ext[0].ptr = &pars;
+
+   return lg_command(sbc, LG_CMD_GILA, 1, ext, 1);
+}
+
 int tx_pulse(
    int sbc, int handle, int gpio,
    int micros_on, int micros_off,
@@ -1071,6 +1844,7 @@ int callback(
 int callback_cancel(int id)
 {
    callback_t *p;
+   int sbc;
 
    p = gCallBackFirst;
 
@@ -1084,8 +1858,12 @@ int callback_cancel(int id)
          if (p->next) {p->next->prev = p->prev;}
          else         {gCallBackLast = p->prev;}
 
+         sbc = p->sbc;
+
          free(p);
 
+         xCallbackFilter(sbc);
+
          return 0;
       }
       p = p->next;
@@ -1311,6 +2089,27 @@ int notify_pause(int sbc, int handle)
 int notify_close(int sbc, int handle)
    {return lg_command_1(sbc, LG_CMD_NC, handle, 1);}
 
+int notify_filter(
+   int sbc, int handle, int chip, uint64_t gpioMask, int edgeMask,
+   int decimation)
+{
+   lgExtent_t ext[2];
+   uint64_t parq[] = {gpioMask};
+   uint32_t pars[] = {handle, chip, edgeMask, decimation};
+
+   ext[0].size = sizeof(parq);
+   ext[0].count = sizeof(parq)/sizeof(parq[0]);
+   ext[0].bytes = sizeof(parq[0]);
+   ext[0].ptr = &parq;
+
+   ext[1].size = sizeof(pars);
+   ext[1].count = sizeof(pars)/sizeof(pars[0]);
+   ext[1].bytes = sizeof(pars[0]);
+   ext[1].ptr = &pars;
+
+   return lg_command(sbc, LG_CMD_NF, 2, ext, 1);
+}
+
 
 /* SCRIPTS */
 
@@ -1553,26 +2352,123 @@ int spi_xfer(int sbc, int handle, const char *txBuf, char *rxBuf, int count)
    else if (!rxBuf)           return spi_write(sbc, handle, txBuf, count);
    else if (!txBuf && !rxBuf) return LG_SPI_XFER_FAILED;
 
-   ext[0].size = sizeof(pars);
-   ext[0].count = sizeof(pars)/sizeof(pars[0]);
-   ext[0].bytes = sizeof(pars[0]);
-   ext[0].ptr = &pars;
+   ext[0].size = sizeof(pars);
+   ext[0].count = sizeof(pars)/sizeof(pars[0]);
+   ext[0].bytes = sizeof(pars[0]);
+   ext[0].ptr = &pars;
+
+   ext[1].size = count;
+   ext[1].count = count;
+   ext[1].bytes = 1;
+   ext[1].ptr = txBuf;
+
+   bytes = lg_command(sbc, LG_CMD_SPIX, 2, ext, 0);
+
+   if (bytes > 0)
+   {
+      bytes = recvMax(sbc, rxBuf, count, bytes);
+   }
+
+   _pmu(sbc);
+
+   return bytes;
+}
+
+/* STREAMS */
+
+int stream_start(
+   int sbc, int period_us, int records, StreamFunc_t f, void *userdata)
+{
+   batch_t *batch;
+   lgExtent_t ext[2];
+   uint32_t pars[3];
+   stream_t *p;
+   int handle;
+
+   if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
+   {
+      return lgif_unconnected_sbc;
+   }
+
+   if (f == NULL) return lgif_bad_callback;
+
+   /* records are only sent to a compact notification */
+   if (!gPigCompact[sbc]) return LG_BAD_STREAM;
+
+   batch = &xChan(sbc)->batch;
+
+   /* held until the stream is known, so its first record finds it */
+   pthread_mutex_lock(&gStreamMutex);
+
+   _pml(sbc);
+
+   if (!batch->active)
+   {
+      _pmu(sbc);
+      pthread_mutex_unlock(&gStreamMutex);
+      return lgif_bad_batch;
+   }
+
+   /* the batched commands are the stream's steps */
+
+   batch->active = 0;
+
+   ((uint32_t *)batch->buf)[0] = 0;
+   ((uint32_t *)batch->buf)[1] = 0;
+
+   pars[0] = gPigHandle[sbc];
+   pars[1] = period_us;
+   pars[2] = records;
+
+   ext[0].size = sizeof(pars);
+   ext[0].count = sizeof(pars)/sizeof(pars[0]);
+   ext[0].bytes = sizeof(pars[0]);
+   ext[0].ptr = &pars;
+
+   ext[1].size = batch->len;
+   ext[1].count = batch->len;
+   ext[1].bytes = 1;
+   ext[1].ptr = batch->buf;
+
+   _pmu(sbc);
+
+   handle = lg_command(sbc, LG_CMD_STRO, 2, ext, 1);
+
+   if (handle >= 0)
+   {
+      p = malloc(sizeof(stream_t));
+
+      if (p)
+      {
+         p->sbc = sbc;
+         p->handle = handle;
+         p->f = f;
+         p->userdata = userdata;
+         p->next = gStreamFirst;
+
+         gStreamFirst = p;
+      }
+      else
+      {
+         lg_command_1(sbc, LG_CMD_STRC, handle, 1);
+         handle = lgif_bad_malloc;
+      }
+   }
+
+   pthread_mutex_unlock(&gStreamMutex);
 
-   ext[1].size = count;
-   ext[1].count = count;
-   ext[1].bytes = 1;
-   ext[1].ptr = txBuf;
+   return handle;
+}
 
-   bytes = lg_command(sbc, LG_CMD_SPIX, 2, ext, 0);
+int stream_stop(int sbc, int handle)
+{
+   int status;
 
-   if (bytes > 0)
-   {
-      bytes = recvMax(sbc, rxBuf, count, bytes);
-   }
+   status = lg_command_1(sbc, LG_CMD_STRC, handle, 1);
 
-   _pmu(sbc);
+   xStreamForget(sbc, handle);
 
-   return bytes;
+   return status;
 }
 
 /* THREADS */
@@ -1668,6 +2564,68 @@ int lgu_set_internal(int sbc, int config_id, uint64_t config_value)
    return lg_command(sbc, LG_CMD_CSI, 2, ext, 1);
 }
 
+int lgu_get_cmd_stats(int sbc, int flags, lgCmdStats_p stats, int count)
+{
+   int status;
+   int bytes;
+   lgExtent_t ext[1];
+   uint32_t pars[] = {flags};
+
+   ext[0].size = sizeof(pars);
+   ext[0].count = sizeof(pars)/sizeof(pars[0]);
+   ext[0].bytes = sizeof(pars[0]);
+   ext[0].ptr = &pars;
+
+   bytes = lg_command(sbc, LG_CMD_STATS, 1, ext, 0);
+
+   if (bytes > 0)
+   {
+      if (count < 0) count = 0;
+      recvMax(sbc, stats, count * sizeof(lgCmdStats_t), bytes);
+      status = bytes / sizeof(lgCmdStats_t);
+   }
+   else status = bytes;
+
+   _pmu(sbc);
+
+   return status;
+}
+
+int lgu_set_frame_size(int sbc, int frameSize)
+{
+   int i, old, status;
+   lgExtent_t ext[1];
+   uint32_t pars[] = {frameSize};
+
+   if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
+   {
+      return lgif_unconnected_sbc;
+   }
+
+   ext[0].size = sizeof(pars);
+   ext[0].count = sizeof(pars)/sizeof(pars[0]);
+   ext[0].bytes = sizeof(pars[0]);
+   ext[0].ptr = &pars;
+
+   old = xSetThreadChan(sbc, 0);
+
+   for (i=0, status=LG_OKAY; (i<gChannels[sbc]) && (status >= 0); i++)
+   {
+      xSetThreadChan(sbc, i);
+
+      status = lg_command(sbc, LG_CMD_FRAME, 1, ext, 0);
+
+      /* older daemons don't know the command and keep the default */
+      if (status > 0) xChan(sbc)->frame = status;
+
+      _pmu(sbc);
+   }
+
+   xSetThreadChan(sbc, old);
+
+   return status;
+}
+
 int lgu_get_sbc_name(int sbc, char *name, int count)
 {
    int bytes;
@@ -1687,53 +2645,293 @@ int lgu_get_sbc_name(int sbc, char *name, int count)
 
 int lgu_set_user(int sbc, const char *user, const char *secretFile)
 {
-   lgExtent_t ext[1];
-   int len;
-   int bytes;
-   char hash[34];
-   char salt1[LG_SALT_LEN];
-   char salt2[LG_SALT_LEN];
-   char buf[64];
+   /* every channel of a pool acts for the same user */
 
-   hash[0] = 0;
+   int i, old, status;
 
-   if (!user || strlen(user) == 0) user = LG_DEFAULT_USER;
+   if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
+   {
+      return lgif_unconnected_sbc;
+   }
 
-   snprintf(salt1, LG_SALT_LEN, "%015"PRIx64, xMakeSalt());
-   sprintf(buf, "%s.%s", salt1, user);
+   old = xSetThreadChan(sbc, 0);
 
-   len = strlen(buf);
+   for (i=0, status=LG_OKAY; (i<gChannels[sbc]) && (status >= 0); i++)
+   {
+      xSetThreadChan(sbc, i);
+      status = xSetUser(sbc, 0, user, secretFile);
+   }
 
-   ext[0].size = len;
-   ext[0].count = len;
-   ext[0].bytes = 1;
-   ext[0].ptr = buf;
+   xSetThreadChan(sbc, old);
+
+   return status;
+}
+
+int lgu_set_share_id(int sbc, int handle, int share_id)
+   {return lg_command_2(sbc, LG_CMD_SHRS, handle, share_id, 1);}
+
+int lgu_use_share_id(int sbc, int share_id)
+{
+   if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
+   {
+      return lgif_unconnected_sbc;
+   }
+
+   /* the channels of a pool need the pool's share to use each other's */
+
+   if (gChannels[sbc] > 1) return lgif_pool_share;
+
+   return lg_command_1(sbc, LG_CMD_SHRU, share_id, 1);
+}
+
+int lgu_pipeline_start(int sbc)
+{
+   pipeline_t *pipe;
+   int status;
+
+   if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
+   {
+      return lgif_unconnected_sbc;
+   }
+
+   pipe = &xChan(sbc)->pipe;
+
+   if (pipe->active) return lgif_bad_pipeline;
+
+   if (!pipe->probed)
+   {
+      /* older daemons reply in order but don't echo request ids */
+
+      status = lg_command_0(sbc, LG_CMD_RIDS, 1);
+
+      if ((status < 0) && (status != LG_UNKNOWN_COMMAND)) return status;
+
+      pipe->rids = (status == LG_OKAY);
+      pipe->probed = 1;
+   }
+
+   _pml(sbc);
+
+   if (pipe->status == NULL)
+   {
+      pipe->status = malloc(PIPELINE_WINDOW * sizeof(int));
+
+      if (pipe->status == NULL)
+      {
+         _pmu(sbc);
+         return lgif_bad_malloc;
+      }
+
+      pipe->size = PIPELINE_WINDOW;
+   }
+
+   pipe->firstId = pipe->nextId;
+   pipe->sent = 0;
+   pipe->done = 0;
+   pipe->active = 1;
+
+   _pmu(sbc);
+
+   return LG_OKAY;
+}
+
+int lgu_pipeline_stop(int sbc, int *status, int count)
+{
+   pipeline_t *pipe;
+   int err;
+
+   if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
+   {
+      return lgif_unconnected_sbc;
+   }
+
+   pipe = &xChan(sbc)->pipe;
 
-   bytes = lg_command(sbc, LG_CMD_USER, 1, ext, 0);
+   _pml(sbc);
+
+   if (!pipe->active)
+   {
+      _pmu(sbc);
+      return lgif_bad_pipeline;
+   }
+
+   err = xPipeDrain(sbc, 0);
+
+   pipe->active = 0;
+
+   if (err < 0)
+   {
+      _pmu(sbc);
+      return err;
+   }
 
-   if (bytes < 0) return bytes;
+   if (count > pipe->sent) count = pipe->sent;
 
-   recvMax(sbc, salt2, LG_SALT_LEN, bytes);
+   if ((status != NULL) && (count > 0))
+      memcpy(status, pipe->status, count * sizeof(int));
 
    _pmu(sbc);
 
-   lgMd5UserHash(user, salt1, salt2, secretFile, hash);
+   return pipe->sent;
+}
 
-   len = strlen(hash);
+int lgu_batch_start(int sbc)
+{
+   batch_t *batch;
+   uint8_t *newBuf;
+   int status;
 
-   ext[0].size = len;
-   ext[0].count = len;
+   if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
+   {
+      return lgif_unconnected_sbc;
+   }
+
+   batch = &xChan(sbc)->batch;
+
+   _pml(sbc);
+
+   if (batch->active) status = lgif_bad_batch;
+
+   else
+   {
+      /* the frame size may have changed since the last batch */
+      newBuf = realloc(batch->buf, xChan(sbc)->frame);
+
+      if (newBuf != NULL)
+      {
+         batch->buf = newBuf;
+
+         /* the flags and padding are filled in by lgu_batch_stop */
+         batch->len = LG_BATCH_HDR_BYTES;
+         batch->active = 1;
+         status = LG_OKAY;
+      }
+      else status = lgif_bad_malloc;
+   }
+
+   _pmu(sbc);
+
+   return status;
+}
+
+int lgu_batch_stop(int sbc, int flags, int *status, int count)
+{
+   batch_t *batch;
+   lgExtent_t ext[1];
+   lgCmd_p subP;
+   uint8_t *newBuf;
+   int executed, size, pos, i;
+
+   if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
+   {
+      return lgif_unconnected_sbc;
+   }
+
+   batch = &xChan(sbc)->batch;
+
+   _pml(sbc);
+
+   if (!batch->active)
+   {
+      _pmu(sbc);
+      return lgif_bad_batch;
+   }
+
+   batch->active = 0;
+   batch->replyCount = 0;
+   batch->replyLen = 0;
+
+   newBuf = realloc(batch->reply, xChan(sbc)->frame);
+
+   if (newBuf == NULL)
+   {
+      _pmu(sbc);
+      return lgif_bad_malloc;
+   }
+
+   batch->reply = newBuf;
+   batch->replySize = xChan(sbc)->frame;
+
+   ((uint32_t *)batch->buf)[0] = flags;
+   ((uint32_t *)batch->buf)[1] = 0;
+
+   ext[0].size = batch->len;
+   ext[0].count = batch->len;
    ext[0].bytes = 1;
-   ext[0].ptr = hash;
+   ext[0].ptr = batch->buf;
 
-   return lg_command(sbc, LG_CMD_PASSW, 1, ext, 1);
+   _pmu(sbc);
+
+   executed = lg_command(sbc, LG_CMD_BATCH, 1, ext, 0);
+
+   if (executed >= 0)
+   {
+      size = ((lgCmd_p)xChan(sbc)->msgBuf)->size;
+
+      if ((size > batch->replySize) ||
+         (recv(xChan(sbc)->sock, batch->reply, size, MSG_WAITALL) != size))
+      {
+         _pmu(sbc);
+         return lgif_bad_recv;
+      }
+
+      batch->replyCount = executed;
+      batch->replyLen = size;
+
+      for (i=0, pos=0; (i<executed) && (i<count) && status; i++)
+      {
+         subP = (lgCmd_p)(batch->reply + pos);
+         status[i] = subP->status;
+         pos += LG_BATCH_PAD(sizeof(lgCmd_t) + subP->size);
+      }
+   }
+
+   _pmu(sbc);
+
+   return executed;
 }
 
-int lgu_set_share_id(int sbc, int handle, int share_id)
-   {return lg_command_2(sbc, LG_CMD_SHRS, handle, share_id, 1);}
+int lgu_batch_data(int sbc, int index, char *rxBuf, int count)
+{
+   batch_t *batch;
+   lgCmd_p subP;
+   int pos, i, status;
 
-int lgu_use_share_id(int sbc, int share_id)
-   {return lg_command_1(sbc, LG_CMD_SHRU, share_id, 1);}
+   if ((sbc < 0) || (sbc >= MAX_SBC) || !gPiInUse[sbc])
+   {
+      return lgif_unconnected_sbc;
+   }
+
+   batch = &xChan(sbc)->batch;
+
+   _pml(sbc);
+
+   if ((index < 0) || (index >= batch->replyCount))
+   {
+      _pmu(sbc);
+      return lgif_bad_batch;
+   }
+
+   for (i=0, pos=0; i<index; i++)
+   {
+      subP = (lgCmd_p)(batch->reply + pos);
+      pos += LG_BATCH_PAD(sizeof(lgCmd_t) + subP->size);
+   }
+
+   subP = (lgCmd_p)(batch->reply + pos);
+
+   if (subP->status < 0) status = subP->status;
+   else
+   {
+      status = subP->size;
+      if (status > count) status = count;
+      if (status > 0) memcpy(rxBuf, &subP[1], status);
+   }
+
+   _pmu(sbc);
+
+   return status;
+}
 
 uint32_t lgu_rgpio_version(void)
    {return RGPIO_VERSION;}
@@ -1771,6 +2969,16 @@ const char *lgu_error_text(int errnum)
             return "not connected to sbc";
          case lgif_too_many_pis:
             return "too many connected sbcs";
+         case lgif_bad_pipeline:
+            return "pipeline not started or already started";
+         case lgif_bad_batch:
+            return "batch not started, already started, or no such command";
+
+         case lgif_bad_frame:
+            return "command larger than the frame size";
+
+         case lgif_pool_share:
+            return "can't change the share id of a pool";
 
          default:
             return "unknown error";
@@ -86,6 +86,7 @@ TEXT*/
 ESSENTIAL
 
 rgpiod_start               Connects to a rgpiod daemon
+rgpiod_start_pool          Connects with several command connections
 rgpiod_stop                Disconnects from a rgpiod daemon
 
 FILES
@@ -133,6 +134,7 @@ tx_room                    See if more room for tx on a GPIO or group
 
 gpio_set_debounce_time     Sets the debounce time for a GPIO
 gpio_set_watchdog_time     Sets the watchdog time for a GPIO
+gpio_set_line_info_alerts  Starts alerts on GPIO ownership changes
 
 callback                   Starts a GPIO callback
 callback_cancel            Stops a GPIO callback
@@ -173,6 +175,7 @@ notify_open                Request a notification handle
 notify_close               Close a notification
 notify_pause               Pause notifications
 notify_resume              Start notifications for selected GPIO
+notify_filter              Select the reports a notification receives
 
 SCRIPTS
 
@@ -209,6 +212,11 @@ spi_read                   Reads bytes from a SPI device
 spi_write                  Writes bytes to a SPI device
 spi_xfer                   Transfers bytes with a SPI device
 
+STREAMS
+
+stream_start               Run the batched commands periodically
+stream_stop                Stop a stream
+
 THREADS
 
 thread_start               Start a new thread
@@ -221,6 +229,10 @@ lgu_get_sbc_name           Get the SBC name
 lgu_get_internal           Get a SBC configuration value
 lgu_set_internal           Set a SBC configuration value
 
+lgu_get_cmd_stats          Get the daemon's per-command statistics
+
+lgu_set_frame_size         Allow larger commands and replies
+
 lgu_time                   Returns the number of seconds since the Epoch
 lgu_timestamp              Returns the number of nanoseconds since the Epoch
 
@@ -231,6 +243,13 @@ lgu_set_user               Set the user (and associated permissions)
 lgu_set_share_id           Set the share id for a resource
 lgu_use_share_id           Use this share id when asking for a resource
 
+lgu_pipeline_start         Start sending commands without waiting for replies
+lgu_pipeline_stop          Wait for and return the pipelined command statuses
+
+lgu_batch_start            Start collecting commands into a batch
+lgu_batch_stop             Execute the batch in one round trip
+lgu_batch_data             Get the data returned by a batched command
+
 lgu_rgpio_version          Get the rgpio library version
 lgu_error_text             Get the error text for an error code
 
@@ -251,6 +270,17 @@ typedef void (*CBFunc_t)
 
 typedef struct callback_s callback_t;
 
+typedef struct lgStreamStep_s
+{
+   int status;          // the command's status
+   int size;            // bytes of data returned
+   const uint8_t *data; // the data, not necessarily aligned
+} lgStreamStep_t, *lgStreamStep_p;
+
+typedef void (*StreamFunc_t)
+   (int sbc, int handle, uint32_t seq, uint64_t timestamp,
+   int steps, lgStreamStep_p step, void *userdata);
+
 typedef void *(lgThreadFunc_t) (void *);
 
 /* --------------------------------------------------------- ESSENTIAL API
@@ -266,12 +296,13 @@ notification streams.
 addrStr: specifies the host or IP address of the SBC running the
          rgpiod daemon.  It may be NULL in which case localhost
          is used unless overridden by the LG_ADDR environment
-         variable.
+         variable.  "unix:path" connects to a local daemon
+         started with -u path, which avoids the TCP stack.
 
 portStr: specifies the port address used by the SBC running the
          rgpiod daemon.  It may be NULL in which case "8889"
          is used unless overridden by the LG_PORT environment
-         variable.
+         variable.  It is ignored for a "unix:" address.
 . .
 
 If OK returns a sbc (>= 0).
@@ -286,6 +317,47 @@ If the LG_USER environment variable exists that user will be
 the rgpiod daemon is running with access control enabled.
 D*/
 
+/*F*/
+int rgpiod_start_pool(const char *addrStr, const char *portStr, int channels);
+/*D
+Connect to the rgpiod daemon with up to 8 command connections
+(channels) rather than one.
+
+. .
+ addrStr: as for [*rgpiod_start*].
+ portStr: as for [*rgpiod_start*].
+channels: 1-8, the number of command connections.
+. .
+
+If OK returns a sbc (>= 0).
+
+On failure returns a negative error code.
+
+With one channel every command from every thread is sent on the
+same connection, one at a time, so a slow command (say a long I2C
+transaction) holds up the other threads.  With a pool each thread
+is given a channel when it first sends a command and keeps it.
+Threads on different channels run their commands in parallel.
+
+The channels share handles.  A handle opened by one thread may be
+used by any other.  This is done with a share id private to the
+connection (see [*lgu_use_share_id*]), and the handles are still
+freed when the sbc is stopped.
+
+[*lgu_set_user*] and [*lgu_set_frame_size*] apply to every channel.
+[*lgu_use_share_id*] fails with lgif_pool_share for a pool, as the
+channels need the pool's share id to use each other's handles.  A
+handle given another share id with [*lgu_set_share_id*] can only be
+used by threads on the channel which opened it.
+
+A pipeline or batch belongs to the channel of the thread which
+started it.
+
+...
+sbc = rgpiod_start_pool(NULL, NULL, 4);
+...
+D*/
+
 /*F*/
 void rgpiod_stop(int sbc);
 /*D
@@ -1200,6 +1272,33 @@ edge alert.
 The level is set to LG_TIMEOUT (2) for a watchdog alert.
 D*/
 
+/*F*/
+int gpio_set_line_info_alerts(
+   int sbc, int handle, int gpio, int enable, int nfyHandle);
+/*D
+This starts or stops alerts when a GPIO is claimed, released, or
+reconfigured by any user.
+
+. .
+      sbc: >= 0 (as returned by [*rgpiod_start*]).
+   handle: >= 0 (as returned by [*gpiochip_open*]).
+     gpio: >= 0, as legal for the gpiochip.
+   enable: 1 to start alerts, 0 to stop them.
+nfyHandle: >= 0 (as returned by [*notify_open*]).
+. .
+
+If OK returns 0.
+
+On failure returns a negative error code.
+
+The GPIO does not need to be claimed.
+
+Each change is sent to the notification handle as a report with
+flags set to LG_REPORT_LINE_INFO and level set to LG_LINE_REQUESTED,
+LG_LINE_RELEASED, or LG_LINE_RECONFIGURED.  These reports are not
+passed to callbacks.
+D*/
+
 
 /*F*/
 int gpio_claim_alert(
@@ -1866,6 +1965,41 @@ If OK returns 0.
 On failure returns a negative error code.
 D*/
 
+/*F*/
+int notify_filter(
+   int sbc, int handle, int chip, uint64_t gpioMask, int edgeMask,
+   int decimation);
+/*D
+Selects the reports sent to a notification.
+
+. .
+       sbc: >= 0 (as returned by [*rgpiod_start*]).
+    handle: >= 0 (as returned by [*notify_open*])
+      chip: the gpiochip device number, or -1 for any gpiochip
+  gpioMask: bit n set to send reports for GPIO n
+  edgeMask: RISING_EDGE, FALLING_EDGE, BOTH_EDGES, or 0
+decimation: 0 or 1 to send every edge, n to send every nth
+            edge of each GPIO
+. .
+
+If OK returns 0.
+
+On failure returns a negative error code.
+
+Reports which are not selected are discarded by the daemon.
+
+gpioMask can only select GPIO 0 to 63, so a filtered notification
+receives no reports for GPIO above 63.  A filter which selects
+everything (chip -1, every bit of gpioMask, BOTH_EDGES and
+decimation 0 or 1) removes the filter.  Watchdog reports (level 2)
+and reports with non-zero flags are not affected by edgeMask or
+decimation.
+
+The notification used by [*callback*] is filtered automatically
+so that it only receives reports for GPIO with callbacks.  It is
+not filtered while there is a callback for a GPIO above 63.
+D*/
+
 
 
 /* ----------------------------------------------------------- SCRIPTS API
@@ -2289,6 +2423,83 @@ On failure returns a negative error code.
 D*/
 
 
+/* ----------------------------------------------------------- STREAMS API
+*/
+
+/*F*/
+int stream_start(
+   int sbc, int period_us, int records, StreamFunc_t f, void *userdata);
+/*D
+Has the rgpiod daemon run the commands collected since
+[*lgu_batch_start*] every period_us microseconds and send their
+results to a callback.
+
+. .
+      sbc: >= 0 (as returned by [*rgpiod_start*]).
+period_us: >= 100, the time between runs in microseconds.
+  records: the number of runs, 0 to run until stopped.
+        f: the callback function.
+ userdata: a pointer to arbitrary user data.
+. .
+
+If OK returns a stream handle (>= 0).
+
+On failure returns a negative error code.
+
+The commands are the stream's steps.  Only commands which read or
+transfer may be steps, i.e. [*gpio_read*], [*group_read*],
+[*spi_read*], [*spi_write*], [*spi_xfer*], the I2C reads, process
+calls, [*i2c_write_byte*] and [*i2c_zip*], [*serial_read*],
+[*serial_read_byte*], [*serial_data_available*], and [*lgu_timestamp*].
+At most 64 steps are allowed.
+
+The daemon runs the steps on its own timer thread and sends each
+run's results over the notification socket, so a stream costs no
+network round trips after it starts.  The callback is called from
+the notification thread with the stream handle, the run's sequence
+number, the time (as [*lgu_timestamp*]) the run started, the number
+of steps executed and their results.
+
+The sequence number counts periods.  A gap means the daemon could
+not keep up and skipped runs.  Fewer steps than were batched are
+executed if a run's results would not fit in one notification
+frame (about 4000 bytes).
+
+The stream is stopped by [*stream_stop*], or when the connection
+to the daemon closes.  A stream needs a daemon which sends compact
+notifications.
+
+The records go to the connection's notification, which the daemon
+only lets the connection use with the user (e.g. from LG_USER) and
+share id it was started with.  A stream can't be started once
+[*lgu_set_user*] or [*lgu_use_share_id*] have changed them.
+
+...
+lgu_batch_start(sbc);
+
+spi_xfer(sbc, adc, cmd, NULL, 3);
+
+h = stream_start(sbc, 1000, 0, adc_sample, NULL); // 1 kHz
+...
+D*/
+
+/*F*/
+int stream_stop(int sbc, int handle);
+/*D
+Stops a stream.
+
+. .
+   sbc: >= 0 (as returned by [*rgpiod_start*]).
+handle: >= 0 (as returned by [*stream_start*]).
+. .
+
+If OK returns 0.
+
+On failure returns a negative error code.
+
+Records already sent are not delivered to the callback.
+D*/
+
 /* ----------------------------------------------------------- THREADS API
 */
 
@@ -2366,6 +2577,80 @@ If OK returns 0.
 On failure returns a negative error code.
 D*/
 
+/*F*/
+int lgu_get_cmd_stats(int sbc, int flags, lgCmdStats_p stats, int count);
+/*D
+Gets the number of times each command has been executed by the
+rgpiod daemon, how many of those failed, and how long they took.
+
+This is a privileged command.  See [+permits+].
+
+. .
+  sbc: >= 0 (as returned by [*rgpiod_start*]).
+flags: 0 or LG_STATS_RESET.
+stats: an array to receive the statistics (may be NULL).
+count: the number of entries in stats.
+. .
+
+If OK returns the number of commands with statistics.  The
+statistics of the first count of them are copied to stats in
+command number order.
+
+On failure returns a negative error code.
+
+The statistics cover every client of the daemon.  The time is
+measured inside the daemon, from the start to the end of the
+command's execution.  A batch counts as one LG_CMD_BATCH as well
+as counting each of its commands.
+
+If LG_STATS_RESET is set the statistics are zeroed once read.
+
+...
+lgCmdStats_t stats[256];
+
+n = lgu_get_cmd_stats(sbc, 0, stats, 256);
+
+for (i=0; i<n; i++)
+{
+   printf("cmd=%d calls=%"PRIu64" errors=%"PRIu64" max=%"PRIu64" ns\n",
+      stats[i].cmd, stats[i].calls, stats[i].errors, stats[i].maxNanos);
+}
+...
+D*/
+
+/*F*/
+int lgu_set_frame_size(int sbc, int frameSize);
+/*D
+Asks the rgpiod daemon to accept larger commands and send larger
+replies on this connection.  By default a command or reply, its
+16 byte header included, must be smaller than 65536 bytes.
+
+. .
+      sbc: >= 0 (as returned by [*rgpiod_start*]).
+frameSize: the largest frame wanted, 65536 to 2097152.
+. .
+
+If OK returns the frame size now in force.  A size outside the
+range is clamped to it.
+
+On failure returns a negative error code.  Daemons which predate
+this command return LG_UNKNOWN_COMMAND and the default applies.
+
+A larger frame lets a single [*file_read*], [*file_write*] or
+batch move more data per round trip.  A command
+larger than the frame fails with lgif_bad_frame without being sent.
+
+The daemon sends a large file read straight from the file without
+copying it through its command buffer.
+
+...
+char buf[1<<20];
+
+if (lgu_set_frame_size(sbc, 2*sizeof(buf)) > sizeof(buf))
+   file_read(sbc, handle, buf, sizeof(buf));
+...
+D*/
+
 /*F*/
 int lgu_get_sbc_name(int sbc, char *buf, int count);
 /*D
@@ -2461,11 +2746,156 @@ deleted when the program ends).
 If a non-zero share is set the object is accessible to any
 software which knows the share and the handle.
 
+A connection pool (see [*rgpiod_start_pool*]) can't change its
+share id, this fails with lgif_pool_share.
+
 ...
 lgu_use_share_id(sbc, 23);
 ...
 D*/
 
+/*F*/
+int lgu_pipeline_start(int sbc);
+/*D
+Starts pipelining commands to the rgpiod daemon.
+
+. .
+sbc: >= 0 (as returned by [*rgpiod_start*]).
+. .
+
+If OK returns 0.
+
+On failure returns a negative error code.
+
+Until [*lgu_pipeline_stop*] is called commands which only return
+a status (e.g. [*gpio_write*]) are sent without waiting for the
+reply and return 0 immediately.  Their statuses are collected
+as the replies arrive.  Up to 1024 commands may await replies.
+
+This hides the network round trip when the daemon is on another
+machine.  Commands which return data (e.g. [*i2c_read_device*])
+wait for all earlier replies and then behave as usual.
+
+...
+lgu_pipeline_start(sbc);
+
+for (i=0; i<1000; i++) gpio_write(sbc, h, 4, i & 1);
+
+if (lgu_pipeline_stop(sbc, status, 1000) == 1000)
+{
+   // status[i] holds the result of the i'th command
+}
+...
+D*/
+
+/*F*/
+int lgu_pipeline_stop(int sbc, int *status, int count);
+/*D
+Waits for the replies to the commands sent since
+[*lgu_pipeline_start*] and stops pipelining.
+
+. .
+   sbc: >= 0 (as returned by [*rgpiod_start*]).
+status: an array to receive the command statuses (may be NULL).
+ count: the number of entries in status.
+. .
+
+If OK returns the number of commands sent while pipelining.
+The statuses of the first count of them are copied to status
+in the order the commands were sent.
+
+On failure returns a negative error code.
+D*/
+
+/*F*/
+int lgu_batch_start(int sbc);
+/*D
+Starts collecting commands into a batch.
+
+. .
+sbc: >= 0 (as returned by [*rgpiod_start*]).
+. .
+
+If OK returns 0.
+
+On failure returns a negative error code.
+
+Until [*lgu_batch_stop*] is called commands are not sent to the
+rgpiod daemon.  Each returns 0 and is added to the batch.
+[*lgu_batch_stop*] sends the batch as a single command, which
+costs one network round trip however many commands it holds.
+
+Commands which return data (e.g. [*spi_xfer*]) return no data
+while batching.  Use [*lgu_batch_data*] to fetch the bytes the
+command would have returned once the batch has been executed.
+
+The daemon checks the permissions of each batched command as
+if it had been sent separately.
+
+...
+lgu_batch_start(sbc);
+
+for (i=0; i<8; i++) spi_xfer(sbc, adc, cmd[i], NULL, 3);
+
+for (i=0; i<4; i++) gpio_write(sbc, h, led[i], 1);
+
+if (lgu_batch_stop(sbc, 0, status, 12) == 12)
+{
+   for (i=0; i<8; i++) lgu_batch_data(sbc, i, rx[i], 3);
+}
+...
+D*/
+
+/*F*/
+int lgu_batch_stop(int sbc, int flags, int *status, int count);
+/*D
+Sends the commands collected since [*lgu_batch_start*] to the
+rgpiod daemon, which executes them in order.
+
+. .
+   sbc: >= 0 (as returned by [*rgpiod_start*]).
+ flags: 0 or LG_BATCH_STOP_ON_ERROR.
+status: an array to receive the command statuses (may be NULL).
+ count: the number of entries in status.
+. .
+
+If OK returns the number of commands executed.  The statuses
+of the first count of them are copied to status.
+
+On failure returns a negative error code.
+
+If LG_BATCH_STOP_ON_ERROR is set the daemon stops after the
+first command which fails.  The daemon also stops if the replies
+so far leave too little room for the next command's reply.  In
+either case fewer commands are executed than were batched.
+
+A command which would make the batch too large to send returns
+LG_BAD_BATCH when added.
+D*/
+
+/*F*/
+int lgu_batch_data(int sbc, int index, char *rxBuf, int count);
+/*D
+Gets the data returned by a command in the last batch executed
+by [*lgu_batch_stop*].
+
+. .
+  sbc: >= 0 (as returned by [*rgpiod_start*]).
+index: the command's position in the batch, 0 for the first.
+rxBuf: a buffer to receive the data.
+count: the maximum number of bytes to copy.
+. .
+
+If OK returns the number of bytes copied to rxBuf.
+
+If the command failed returns its (negative) status.
+
+On failure returns a negative error code.
+
+The data is as sent by the rgpiod daemon, e.g. a [*group_read*]
+returns the 64-bit group bits followed by the 32-bit group size.
+D*/
+
 /*F*/
 uint32_t lgu_rgpio_version(void);
 /*D
@@ -2542,6 +2972,9 @@ since the Epoch (start of 1970).  Later kernels use the number of
 nanoseconds since boot.  It's probably best not to make any assumption
 as to the timestamp origin.
 
+channels:: 1-8
+The number of command connections to open to the rgpiod daemon.
+
 char::
 A single character, an 8 bit quantity able to store 0-255.
 
@@ -2599,6 +3032,13 @@ of the error.
 f::
 A function.
 
+flags::
+Flags which modify a batch.  LG_BATCH_STOP_ON_ERROR stops the
+batch at the first command which fails.
+
+Flags which modify a statistics request.  LG_STATS_RESET zeroes
+the statistics once they have been read.
+
 *file::
 A full file path.  To be accessible the path must match an entry in
 the [files] section of the permits file.
@@ -2610,6 +3050,10 @@ A floating point number.
 A file path which may contain wildcards.  To be accessible the path
 must match an entry in the [files] section of the permits file.
 
+frameSize:: 65536-2097152
+The largest command or reply, its header included, to allow
+on a connection.
+
 gpio::
 A 0 based offset of a GPIO within a gpiochip.
 
@@ -2650,6 +3094,7 @@ A number referencing an object opened by one of
 [*serial_open*]
 [*script_store*] 
 [*spi_open*]
+[*stream_start*]
 
 i2c_addr::0-0x7F
 The address of a device on the I2C bus.
@@ -2669,6 +3114,9 @@ A buffer used to pass data to a function.
 inCount::
 The size of an input buffer.
 
+index::
+The position of a command in a batch, 0 for the first.
+
 int::
 A whole number, negative or positive.
 
@@ -2704,6 +3152,26 @@ typedef struct lgChipInfo_s
 } lgChipInfo_t, *lgChipInfo_p;
 . .
 
+lgCmdStats_p::
+A pointer to a lgCmdStats_t object.
+
+. .
+typedef struct lgCmdStats_s
+{
+   uint32_t cmd;        // command number
+   uint32_t pad;
+   uint64_t calls;      // times executed
+   uint64_t errors;     // times a negative status was returned
+   uint64_t totalNanos; // summed execution time in nanoseconds
+   uint64_t maxNanos;   // longest execution time in nanoseconds
+   uint64_t bucket[LG_STATS_BUCKETS];
+} lgCmdStats_t, *lgCmdStats_p;
+. .
+
+bucket[0] counts executions taking under 1 microsecond, bucket[n]
+those taking from 2^(n-1) to 2^n microseconds.  The last bucket
+also counts anything slower.
+
 lgLineInfo_p::
 A pointer to a lgLineInfo_t object.
 
@@ -2730,6 +3198,20 @@ typedef struct lgPulse_s
 } lgPulse_t, *lgPulse_p;
 . .
 
+lgStreamStep_p::
+A pointer to a lgStreamStep_t object, the result of one stream step.
+
+. .
+typedef struct lgStreamStep_s
+{
+   int status;          // the command's status
+   int size;            // bytes of data returned
+   const uint8_t *data; // the data, not necessarily aligned
+} lgStreamStep_t, *lgStreamStep_p;
+. .
+
+The data is as sent by the rgpiod daemon, see [*lgu_batch_data*].
+
 lgThreadFunc_t::
 . .
 typedef void *(lgThreadFunc_t) (void *);
@@ -2767,6 +3249,9 @@ The size of an output buffer.
 *param::
 An array of script parameters.
 
+period_us:: >= 100
+The time in microseconds between runs of a stream's steps.
+
 *portStr::
 A string specifying the port address used by the SBC running
 the rgpiod daemon.  It may be NULL in which case "8889"
@@ -2809,6 +3294,9 @@ PWM frequency
 pwmOffset:: >= 0
 The offset in microseconds from the nominal PWM pulse start.
 
+records:: >= 0
+The number of runs of a stream's steps.  A value of 0 means infinite.
+
 *rxBuf::
 A pointer to a buffer to receive data.
 
@@ -2868,6 +3356,12 @@ used by other software which knows the share_id.
 sleepSecs::
 The number of seconds to delay.
 
+stats::
+An array of lgCmdStats_t to receive command statistics.
+
+status::
+An array of command statuses.
+
 spi_baud::
 The speed of SPI communication in bits per second.
 
@@ -2880,6 +3374,17 @@ A SPI device.
 spi_flags::
 See [*spi_open*] and [*bb_spi_open*].
 
+StreamFunc_t::
+. .
+typedef void (*StreamFunc_t)
+   (int sbc, int handle, uint32_t seq, uint64_t timestamp,
+   int steps, lgStreamStep_p step, void *userdata);
+. .
+
+The function called with the results of each run of a stream, see
+[*stream_start*].  steps is the number of entries in step, or a
+negative error code if the run failed.
+
 thread_func::
 A function of type gpioThreadFunc_t used as the main function of a
 thread.
@@ -2957,6 +3462,10 @@ typedef enum
    lgif_callback_not_found = -2010,
    lgif_unconnected_sbc    = -2011,
    lgif_too_many_pis       = -2012,
+   lgif_bad_pipeline       = -2013,
+   lgif_bad_batch          = -2014,
+   lgif_bad_frame          = -2015,
+   lgif_pool_share         = -2016,
 } lgifError_t;
 
 /*DEF_E*/
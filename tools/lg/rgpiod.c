@@ -39,6 +39,7 @@ For more information, please refer to <http://unlicense.org/>
 #include <signal.h>
 #include <ctype.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netdb.h>
 
 #include "lgpio.h"
@@ -51,12 +52,16 @@ For more information, please refer to <http://unlicense.org/>
 int      gPermits = 0;
 int      gNumSockNetAddr = 0;
 uint32_t gSockNetAddr[MAX_CONNECT_ADDRESSES];
-int      gFdSock = -1;
+int      gFdSock[LG_MAX_LISTENERS];
+int      gNumFdSock = 0;
+int      gFdSockUnix = -1;
 
 /* locals */
 
 static int      CfgIfFlags = LG_DEFAULT_IF_FLAGS;
 static int      CfgSocketPort = LG_DEFAULT_SOCKET_PORT;
+static int      CfgListeners = 1;
+static char    *CfgUnixPath = NULL;
 static pthread_t pthSocket;
 
 /* prototypes */
@@ -65,35 +70,19 @@ void *pthSocketThread(void *x);
 
 /* ----------------------------------------------------------------------- */
 
-static int xOpenSocket(void)
+static int xOpenTcpSocket(int port)
 {
-   int i;
+   int fd = -1;
    int opt=1;
    struct sockaddr_in server;
    struct sockaddr_in6 server6;
-   char *portStr;
-   int port;
-   pthread_attr_t pthAttr;
-
-   LG_DBG(LG_DEBUG_STARTUP, "");
-
-   gFdSock = -1;
-
-   if (pthread_attr_init(&pthAttr))
-      PARAM_ERROR(LG_INIT_FAILED, "pthread_attr_init failed (%m)");
-
-   if (pthread_attr_setstacksize(&pthAttr, STACK_SIZE))
-      PARAM_ERROR(LG_INIT_FAILED, "pthread_attr_setstacksize failed (%m)");
-
-   portStr = getenv(LG_ENVPORT);
-   if (portStr) port = atoi(portStr); else port = CfgSocketPort;
 
    // Accept connections on IPv6, unless we have an IPv4-only whitelist
    if (!gNumSockNetAddr)
    {
-      gFdSock = socket(AF_INET6, SOCK_STREAM , 0);
+      fd = socket(AF_INET6, SOCK_STREAM , 0);
 
-      if (gFdSock != -1)
+      if (fd != -1)
       {
          bzero((char *)&server6, sizeof(server6));
          server6.sin6_family = AF_INET6;
@@ -107,21 +96,27 @@ static int xOpenSocket(void)
          }
          server6.sin6_port = htons(port);
 
-         setsockopt(gFdSock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-         if (bind(gFdSock,(struct sockaddr *)&server6, sizeof(server6)) < 0)
+         setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+         if ((CfgListeners > 1) &&
+             (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0))
+            PARAM_ERROR(LG_INIT_FAILED, "SO_REUSEPORT failed (%m)");
+         if (bind(fd,(struct sockaddr *)&server6, sizeof(server6)) < 0)
             PARAM_ERROR(LG_INIT_FAILED, "bind to port %d failed (%m)", port);
       }
    }
 
-   if (gNumSockNetAddr || gFdSock == -1)
+   if (gNumSockNetAddr || fd == -1)
    {
-      gFdSock = socket(AF_INET , SOCK_STREAM , 0);
+      fd = socket(AF_INET , SOCK_STREAM , 0);
 
-      if (gFdSock == -1)
+      if (fd == -1)
          PARAM_ERROR(LG_INIT_FAILED, "socket failed (%m)");
       else
       {
-        setsockopt(gFdSock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        if ((CfgListeners > 1) &&
+            (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0))
+           PARAM_ERROR(LG_INIT_FAILED, "SO_REUSEPORT failed (%m)");
       }
       server.sin_family = AF_INET;
       if (CfgIfFlags & LG_LOCALHOST_SOCK_IF)
@@ -134,10 +129,68 @@ static int xOpenSocket(void)
       }
       server.sin_port = htons(port);
 
-      if (bind(gFdSock,(struct sockaddr *)&server , sizeof(server)) < 0)
+      if (bind(fd,(struct sockaddr *)&server , sizeof(server)) < 0)
          PARAM_ERROR(LG_INIT_FAILED, "bind to port %d failed (%m)", port);
    }
 
+   return fd;
+}
+
+static int xOpenSocket(void)
+{
+   int i;
+   struct sockaddr_un serverUnix;
+   struct stat st;
+   char *portStr;
+   int port;
+   pthread_attr_t pthAttr;
+
+   LG_DBG(LG_DEBUG_STARTUP, "");
+
+   if (pthread_attr_init(&pthAttr))
+      PARAM_ERROR(LG_INIT_FAILED, "pthread_attr_init failed (%m)");
+
+   if (pthread_attr_setstacksize(&pthAttr, STACK_SIZE))
+      PARAM_ERROR(LG_INIT_FAILED, "pthread_attr_setstacksize failed (%m)");
+
+   portStr = getenv(LG_ENVPORT);
+   if (portStr) port = atoi(portStr); else port = CfgSocketPort;
+
+   /*
+      Each listener has its own socket bound to the port with
+      SO_REUSEPORT, so the kernel shares incoming connections
+      between them rather than queueing them all on one.
+   */
+
+   for (i=0; i<CfgListeners; i++)
+   {
+      gFdSock[i] = xOpenTcpSocket(port);
+
+      if (gFdSock[i] < 0) return gFdSock[i];
+
+      gNumFdSock = i + 1;
+   }
+
+   if (CfgUnixPath)
+   {
+      gFdSockUnix = socket(AF_UNIX, SOCK_STREAM, 0);
+
+      if (gFdSockUnix == -1)
+         PARAM_ERROR(LG_INIT_FAILED, "unix socket failed (%m)");
+
+      bzero((char *)&serverUnix, sizeof(serverUnix));
+      serverUnix.sun_family = AF_UNIX;
+      strcpy(serverUnix.sun_path, CfgUnixPath);
+
+      /* remove a socket left by an earlier run, but nothing else */
+      if ((lstat(CfgUnixPath, &st) == 0) && S_ISSOCK(st.st_mode))
+         unlink(CfgUnixPath);
+
+      if (bind(gFdSockUnix, (struct sockaddr *)&serverUnix,
+         sizeof(serverUnix)) < 0)
+         PARAM_ERROR(LG_INIT_FAILED, "bind to %s failed (%m)", CfgUnixPath);
+   }
+
    if (pthread_create(&pthSocket, &pthAttr, pthSocketThread, &i))
       PARAM_ERROR(LG_INIT_FAILED, "pthread_create socket failed (%m)");
 
@@ -164,16 +217,22 @@ static void xUsage()
 {
    fprintf(stderr, "\n" \
       "Usage: rgpiod [OPTION] ...\n" \
+      "   -a value,   listener threads sharing the port (1-16, default 1)\n" \
       "   -c dir,     set config dir (default launch dir)\n" \
       "   -l,         localhost socket only (default local+remote)\n" \
       "   -n IP addr, allow address, name or dotted (default allow all)\n" \
       "   -p value,   socket port (1024-32000, default 8889)\n" \
+      "   -u path,    also listen on a Unix domain socket (default off)\n" \
       "   -v,         display rgpiod version and exit\n" \
       "   -w dir,     set working directory (default launch directory)\n" \
       "   -x,         enable access control (default off)\n" \
       "EXAMPLE\n" \
       "rgpiod -p 9000 &\n" \
       "  Start with socket port 9000\n" \
+      "rgpiod -u /run/rgpiod.sock &\n" \
+      "  Also accept local clients at unix:/run/rgpiod.sock\n" \
+      "rgpiod -a 4 &\n" \
+      "  Accept connections on four threads\n" \
    "\n");
 }
 
@@ -223,10 +282,17 @@ static void xInitOpts(int argc, char *argv[])
    int opt, err, i;
    uint32_t addr;
 
-   while ((opt = getopt(argc, argv, "c:ln:p:vw:x")) != -1)
+   while ((opt = getopt(argc, argv, "a:c:ln:p:u:vw:x")) != -1)
    {
       switch (opt)
       {
+         case 'a': /* listener threads */
+            i = xGetNum(optarg, &err);
+            if ((i >= 1) && (i <= LG_MAX_LISTENERS))
+               CfgListeners = i;
+            else xFatal("invalid -a option (%d)", i);
+            break;
+
          case 'c': /* configuration directory */
             lguSetConfigDir(optarg);
             break;
@@ -249,6 +315,13 @@ static void xInitOpts(int argc, char *argv[])
             else xFatal("invalid -p option (%d)", i);
             break;
 
+         case 'u':
+            if (strlen(optarg) &&
+               (strlen(optarg) < sizeof(((struct sockaddr_un *)0)->sun_path)))
+               CfgUnixPath = optarg;
+            else xFatal("invalid -u option (%s)", optarg);
+            break;
+
          case 'v':
             printf("rgpiod_%d.%d.%d.%d\n",
                (RGPIOD_VERSION>>24)&0xff, (RGPIOD_VERSION>>16)&0xff,
@@ -29,6 +29,7 @@ For more information, please refer to <http://unlicense.org/>
 #define RGPIOD_H
 
 #include <inttypes.h>
+#include <sys/types.h>
 
 #include "lgCmd.h"
 
@@ -46,6 +47,9 @@ For more information, please refer to <http://unlicense.org/>
 #define LG_DEFAULT_SOCKET_PORT_STR    "8889"
 #define LG_DEFAULT_SOCKET_ADDR_STR    "localhost"
 
+/* an address of "unix:path" selects the Unix domain socket at path */
+#define LG_UNIX_ADDR_PREFIX "unix:"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -55,6 +59,26 @@ extern "C" {
 
 int lgExecCmd(lgCmd_p h, int bufSize);
 
+/*
+   As lgExecCmd but a large file read may leave its reply data at
+   offset in fd rather than in the buffer.  The caller sends the
+   h->size bytes and closes fd.  fd is -1 otherwise.
+*/
+int lgExecCmdFd(lgCmd_p h, int bufSize, int *fd, off_t *offset);
+
+/*
+   Some commands may be run without building an lgCmd_t, scripts
+   resolve them once when stored.  lgExecDirectFunc returns the
+   function which runs cmd, NULL if it must go through lgExecCmd.
+   lgExecDirect runs it with the command's arguments, as lgExecCmd
+   would.
+*/
+typedef int (*lgExecFunc_t)(uint32_t *arg);
+
+lgExecFunc_t lgExecDirectFunc(int cmd);
+
+int lgExecDirect(lgExecFunc_t func, int cmd, uint32_t *arg);
+
 /* port */
 
 #define LG_MIN_SOCKET_PORT 1024
@@ -64,6 +88,10 @@ int lgExecCmd(lgCmd_p h, int bufSize);
 
 #define LG_LOCALHOST_SOCK_IF 4
 
+/* Most listener threads sharing the port */
+
+#define LG_MAX_LISTENERS 16
+
 /* Allowed socket connect addresses */
 
 #define MAX_CONNECT_ADDRESSES 256
@@ -74,6 +102,7 @@ int lgExecCmd(lgCmd_p h, int bufSize);
 int lgFileOpen(char *file, int mode);
 int lgFileClose(int handle);
 int lgFileRead(int handle, char *buf, int count);
+int lgFileReadFd(int handle, int count, int *fd, off_t *offset);
 int lgFileWrite(int handle, char *buf, int count);
 int lgFileSeek(int handle, int32_t seekOffset, int seekFrom);
 int lgFileList(char *fpat,  char *buf, int count);
@@ -90,13 +119,21 @@ int lgScriptDelete(int handle);
 
 int lgShell(char *scriptName, char *scriptString);
 
+/* Stream API
+*/
+
+int lgStreamOpen(int nfyHandle, int period, int count, char *steps, int len);
+int lgStreamClose(int handle);
+
 /* globals
 */
 
 extern int gPermits;
 extern int gNumSockNetAddr;
 extern uint32_t gSockNetAddr[MAX_CONNECT_ADDRESSES];
-extern int gFdSock;
+extern int gFdSock[];
+extern int gNumFdSock;
+extern int gFdSockUnix;
 
 #ifdef __cplusplus
 }
@@ -140,6 +177,7 @@ extern int gFdSock;
 #define LG_CMD_GIC   31 // gpiochip get chip info
 #define LG_CMD_GIL   32 // gpiochip get line info
 #define LG_CMD_GMODE 33 // gpio get mode
+#define LG_CMD_GILA  34 // gpio set line info alerts
 
 #define LG_CMD_I2CO  40 // I2C open
 #define LG_CMD_I2CC  41 // I2C close
@@ -164,6 +202,7 @@ extern int gFdSock;
 #define LG_CMD_NC    71 // notification close
 #define LG_CMD_NR    72 // notification resume
 #define LG_CMD_NP    73 // notification pause
+#define LG_CMD_NF    74 // notification filter
 
 #define LG_CMD_PARSE 80 // script parse
 #define LG_CMD_PROC  81 // script store
@@ -193,9 +232,16 @@ extern int gFdSock;
 #define LG_CMD_CSI   116 // set internals setting
 #define LG_CMD_NOIB  117 // open a notification inband in a socket
 #define LG_CMD_SHELL 118 // run a shell command
+#define LG_CMD_NOIBC 119 // open a compact notification inband in a socket
 
 #define LG_CMD_SBC   120 // print the SBC's host name
 #define LG_CMD_FREE  121 // release resources
+#define LG_CMD_RIDS  122 // use request ids on this connection
+#define LG_CMD_BATCH 123 // execute a sequence of commands
+#define LG_CMD_STATS 124 // get per-command statistics
+#define LG_CMD_FRAME 125 // set the largest frame on this connection
+#define LG_CMD_STRO  126 // open a stream
+#define LG_CMD_STRC  127 // close a stream
 
 #define LG_CMD_SHARE 130 // set the share id for handles
 #define LG_CMD_USER  131 // set the user
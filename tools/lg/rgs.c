@@ -35,6 +35,7 @@ For more information, please refer to <http://unlicense.org/>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 
@@ -62,6 +63,17 @@ int printFlags = 0;
 
 int status = LG_OKAY;
 
+int readInput = 0; /* -i, read commands from standard input */
+
+int pipeDepth = 1; /* -p, commands sent before their results are shown */
+
+#define MAX_PIPE_DEPTH 64
+
+static int pipeSent = 0;
+static int pipeDone = 0;
+static int pipeRv[MAX_PIPE_DEPTH];
+static lgCmd_t replyBuf[CMD_MAX_EXTENSION/sizeof(lgCmd_t)];
+
 #define SOCKET_OPEN_FAILED -1
 
 #define PRINT_HEX 1
@@ -87,6 +99,7 @@ GGW h g gbits     GPIO group write (simple)\n\
 GGWX h g gbits gmask  | GPIO group write\n\
 GIC h             gpiochip information\n\
 GIL h g           gpiochip line information\n\
+GILA h g en nfyh  GPIO line information change alerts\n\
 GO gc             gpiochip open device\n\
 GP h g mon moff   GPIO tx pulses (simple)\n\
 GPX h g mon moff off cyc  | GPIO tx pulses\n\
@@ -134,6 +147,7 @@ MICS v            Microseconds delay\n\
 MILS v            Milliseconds delay\n\
 \n\
 NC h              Notification close\n\
+NF h c gm em d    Notification filter\n\
 NO                Notification open\n\
 NP h              Notification pause\n\
 NR h              Notification resume\n\
@@ -165,6 +179,7 @@ SPIO spd spc b spf  | SPI open device\n\
 SPIR h num        SPI read bytes\n\
 SPIW h bvs        SPI write bytes\n\
 SPIX h bvs        SPI transfer bytes\n\
+STATS [flags]     Get command counts, errors, and times\n\
 SX h g sf spw off cyc  | GPIO tx servo pulses\n\
 SHARE             Set share\n\
 \n\
@@ -177,9 +192,17 @@ USER              Set user\n\
 Numbers may be entered as hex (prefix 0x), octal (prefix 0),\n\
 otherwise they are assumed to be decimal.\n\
 \n\
+Options\n\
+\n\
+-a                Show returned data as ASCII\n\
+-i                Then read commands from standard input, a line at a time\n\
+-p n              Send up to n commands ahead of their results (1-64)\n\
+-x                Show returned data as hex\n\
+\n\
 Examples\n\
 \n\
 rgs u test1 s 1 i2co 1 0x20 0 # get handle to device 0x20 on I2C bus 1\n\
+rgs -i -p 16 <setup.rgs # run the commands in setup.rgs\n\
 \n\
 man rgs for full details.\n\
 \n";
@@ -200,6 +223,9 @@ static void xReport(int err, char *fmt, ...)
 
    if (err > status) status = err;
 
+   /* keep the message in order with the results */
+   fflush(stdout);
+
    va_start(ap, fmt);
    vsnprintf(buf, sizeof(buf), fmt, ap);
    va_end(ap);
@@ -217,7 +243,7 @@ static int xInitOpts(int argc, char *argv[])
 
    args = 1;
 
-   while ((opt = getopt(argc, argv, "ahvx")) != -1)
+   while ((opt = getopt(argc, argv, "ahip:vx")) != -1)
    {
       switch (opt)
       {
@@ -231,6 +257,22 @@ static int xInitOpts(int argc, char *argv[])
             args++;
             break;
 
+         case 'i':
+            readInput = 1;
+            args++;
+            break;
+
+         case 'p':
+            pipeDepth = atoi(optarg);
+            if ((pipeDepth < 1) || (pipeDepth > MAX_PIPE_DEPTH))
+            {
+               xReport(RGS_OPTION_ERR,
+                  "ERROR: pipeline depth must be 1-%d", MAX_PIPE_DEPTH);
+               pipeDepth = 1;
+            }
+            args += (optarg == argv[args+1]) ? 2 : 1;
+            break;
+
          case 'x':
             printFlags |= PRINT_HEX;
             args++;
@@ -255,6 +297,7 @@ static int xOpenSocket(void)
 {
    int sock, err;
    struct addrinfo hints, *res, *rp;
+   struct sockaddr_un unixAddr;
    const char *addrStr, *portStr;
 
    portStr = getenv(LG_ENVPORT);
@@ -265,6 +308,30 @@ static int xOpenSocket(void)
 
    if (!addrStr) addrStr = LG_DEFAULT_SOCKET_ADDR_STR;
 
+   if (!strncmp(addrStr, LG_UNIX_ADDR_PREFIX, strlen(LG_UNIX_ADDR_PREFIX)))
+   {
+      addrStr += strlen(LG_UNIX_ADDR_PREFIX);
+
+      if (strlen(addrStr) >= sizeof(unixAddr.sun_path))
+         return SOCKET_OPEN_FAILED;
+
+      memset(&unixAddr, 0, sizeof(unixAddr));
+      unixAddr.sun_family = AF_UNIX;
+      strcpy(unixAddr.sun_path, addrStr);
+
+      sock = socket(AF_UNIX, SOCK_STREAM, 0);
+
+      if (sock == -1) return SOCKET_OPEN_FAILED;
+
+      if (connect(sock, (struct sockaddr *)&unixAddr, sizeof(unixAddr)) == -1)
+      {
+         close(sock);
+         return SOCKET_OPEN_FAILED;
+      }
+
+      return sock;
+   }
+
    memset (&hints, 0, sizeof (hints));
 
    hints.ai_family   = PF_UNSPEC;
@@ -293,7 +360,9 @@ static int xOpenSocket(void)
 
 static void xShowResult(int rv, lgCmd_p cmdP, char *cmdExt)
 {
-   int i, r, ch;
+   int i, j, n, b, r, ch;
+   char *name;
+   lgCmdStats_t stats;
    uint32_t *argI=(uint32_t*)&cmdP[1];
    uint64_t *argQ=(uint64_t*)&cmdP[1];
 
@@ -421,6 +490,44 @@ static void xShowResult(int rv, lgCmd_p cmdP, char *cmdExt)
          }
          break;
 
+      case 12: /* STATS */
+         if (r < 0)
+         {
+            printf("%d\n", r);
+            xReport(RGS_SCRIPT_ERR, "ERROR: %s", lguErrorText(r));
+         }
+         else
+         {
+            /*
+               one line per command: name, calls, errors, mean and
+               maximum microseconds, then the histogram buckets up to
+               the last in use
+            */
+            n = r / sizeof(lgCmdStats_t);
+
+            for (i=0; i<n; i++)
+            {
+               memcpy(&stats, cmdExt + (i * sizeof(stats)), sizeof(stats));
+
+               name = cmdName(stats.cmd);
+
+               if (name) printf("%s", name); else printf("%d", stats.cmd);
+
+               printf(" %"PRIu64" %"PRIu64" %.1f %.1f",
+                  stats.calls, stats.errors,
+                  stats.totalNanos / (stats.calls * 1000.0),
+                  stats.maxNanos / 1000.0);
+
+               for (b=LG_STATS_BUCKETS; b>1; b--)
+                  if (stats.bucket[b-1]) break;
+
+               for (j=0; j<b; j++) printf(" %"PRIu64, stats.bucket[j]);
+
+               printf("\n");
+            }
+         }
+         break;
+
       default:
          printf("*** command=%d, status=%d\n", cmdP->cmd, r);
          if (r < 0) xReport(RGS_SCRIPT_ERR, "ERROR: %s", lguErrorText(r));
@@ -429,7 +536,7 @@ static void xShowResult(int rv, lgCmd_p cmdP, char *cmdExt)
    }
 }
 
-static int xSendCommand(int sock, lgCmd_p cmdP, char *cmdExt)
+static int xSend(int sock, lgCmd_p cmdP)
 {
    int msgLen;
 
@@ -451,6 +558,11 @@ static int xSendCommand(int sock, lgCmd_p cmdP, char *cmdExt)
       return -1;
    }
 
+   return 0;
+}
+
+static int xRecv(int sock, lgCmd_p cmdP, char *cmdExt)
+{
    if (recv(sock, cmdP, sizeof(lgCmd_t), MSG_WAITALL) != sizeof(lgCmd_t))
    {
       xReport(RGS_CONNECT_ERR, "socket receive failed");
@@ -469,62 +581,81 @@ static int xSendCommand(int sock, lgCmd_p cmdP, char *cmdExt)
    return 0;
 }
 
-int main(int argc , char *argv[])
+static int xPipeDrain(int sock, int outstanding)
 {
-   int sock;
-   int args, idx, i, pp, l, len;
-   char salt1[LG_SALT_LEN];
-   char user[LG_USER_LEN];
-   const char *userStr, *shareStr;
-   cmdCtl_t ctl;
-   cmdScript_t s;
-   lgCmd_t cmdBuf[CMD_MAX_EXTENSION/sizeof(lgCmd_t)];
-   lgCmd_p cmdP=cmdBuf;
-   char *cmdExt=(char*)&cmdP[1];
-
-   sock = xOpenSocket();
+   /*
+      shows the results of pipelined commands until at most outstanding
+      are awaiting replies.  The daemon replies in command order.
+   */
 
-   args = xInitOpts(argc, argv);
+   lgCmd_p replyP = replyBuf;
+   char *replyExt = (char*)&replyP[1];
 
-   text[0] = 0;
-   l = 0;
-   pp = 0;
+   while ((pipeSent - pipeDone) > outstanding)
+   {
+      if (xRecv(sock, replyP, replyExt) < 0)
+      {
+         pipeDone = pipeSent; /* the replies won't arrive */
+         return -1;
+      }
 
-   userStr = getenv(LG_ENVUSER);
+      xShowResult(pipeRv[pipeDone % MAX_PIPE_DEPTH], replyP, replyExt);
 
-   if (userStr && strlen(userStr))
-   {
-      sprintf(text, "u %s ", userStr);
-      l = strlen(text);
-      pp = l;
+      pipeDone++;
    }
 
-   shareStr = getenv(LG_ENVSHARE);
+   return 0;
+}
 
-   if (shareStr && strlen(shareStr))
-   {
-      sprintf(text+pp, "c %s ", shareStr);
-      l = strlen(text);
-      pp = l;
-   }
+static int xPipeCommand(int sock, lgCmd_p cmdP, int rv)
+{
+   /* sends a command, its result is shown when its reply arrives */
 
-   for (i=args; i<argc; i++)
-   {
-      l += (strlen(argv[i]) + 1);
-      if (l < sizeof(text)) {sprintf(text+pp, "%s ", argv[i]); pp=l;}
-   }
+   if (xPipeDrain(sock, pipeDepth-1) < 0) return -1;
 
-   if (pp) {text[--pp] = 0;}
+   if (xSend(sock, cmdP) < 0) return -1;
+
+   pipeRv[pipeSent % MAX_PIPE_DEPTH] = rv;
+
+   pipeSent++;
+
+   return 0;
+}
+
+static int xSendCommand(int sock, lgCmd_p cmdP, char *cmdExt)
+{
+   /* sends a command and waits for its reply */
+
+   if (xPipeDrain(sock, 0) < 0) return -1;
+
+   if (xSend(sock, cmdP) < 0) return -1;
+
+   return xRecv(sock, cmdP, cmdExt);
+}
+
+static int xRunCommands(int sock, char *cmds)
+{
+   /* runs the commands in cmds, returns -1 if the connection failed */
+
+   int idx, len, err;
+   char salt1[LG_SALT_LEN];
+   char user[LG_USER_LEN];
+   cmdCtl_t ctl;
+   cmdScript_t s;
+   lgCmd_t cmdBuf[CMD_MAX_EXTENSION/sizeof(lgCmd_t)];
+   lgCmd_p cmdP=cmdBuf;
+   char *cmdExt=(char*)&cmdP[1];
 
    ctl.inScript = 0;
    ctl.eaten = 0;
 
-   len = strlen(text);
+   len = strlen(cmds);
    idx = 0;
+   err = 0;
 
-   while ((idx >= 0) && (ctl.eaten < len))
+   while ((idx >= 0) && (err == 0) && (ctl.eaten < len))
    {
-      if ((idx=cmdParse(text, &ctl, cmdBuf, sizeof(cmdBuf))) >= 0)
+      if ((idx=cmdParse(cmds, &ctl, cmdBuf, sizeof(cmdBuf))) >= 0)
       {
          cmdP->magic = LG_MAGIC;
          cmdP->doubles = 0;
@@ -548,19 +679,23 @@ int main(int argc , char *argv[])
                sprintf(cmdExt, "%s.%s", salt1, user);
                cmdP->size = strlen(cmdExt);
                
-               if (xSendCommand(sock, cmdP, cmdExt) == 0)
+               if ((err = xSendCommand(sock, cmdP, cmdExt)) == 0)
                {
                   /* take salt2 from message and overwrite with hash */
                   lgMd5UserHash(user, salt1, cmdExt, "", cmdExt);
                   cmdP->cmd = LG_CMD_PASSW;
                   cmdP->size = strlen(cmdExt);
-                  if (xSendCommand(sock, cmdP, cmdExt) == 0)
+                  if ((err = xSendCommand(sock, cmdP, cmdExt)) == 0)
                      xShowResult(0, cmdP, cmdExt);
                }
             }
+            else if (pipeDepth > 1)
+            {
+               err = xPipeCommand(sock, cmdP, cmdInfo[idx].rv);
+            }
             else
             {
-               if (xSendCommand(sock, cmdP, cmdExt) == 0)
+               if ((err = xSendCommand(sock, cmdP, cmdExt)) == 0)
                   xShowResult(cmdInfo[idx].rv, cmdP, cmdExt);
             }
          }
@@ -569,6 +704,9 @@ int main(int argc , char *argv[])
       }
       else
       {
+         /* earlier results first */
+         xPipeDrain(sock, 0);
+
          if (idx == CMD_UNKNOWN_CMD)
             xReport(RGS_SCRIPT_ERR,
                "%s? unknown command, rgs -h for help", cmdStr());
@@ -578,8 +716,96 @@ int main(int argc , char *argv[])
       }
    }
 
+   return err;
+}
+
+static void xRunInput(int sock)
+{
+   /* runs each line of standard input over the one connection */
+
+   char *line = NULL;
+   size_t size = 0;
+   ssize_t len;
+   int interactive, i;
+
+   interactive = isatty(STDIN_FILENO);
+
+   while (1)
+   {
+      if (interactive)
+      {
+         printf("rgs> ");
+         fflush(stdout);
+      }
+
+      if ((len = getline(&line, &size, stdin)) < 0) break;
+
+      if (len && (line[len-1] == '\n')) line[--len] = 0;
+
+      /* skip comment lines */
+      for (i=0; isspace(line[i]); i++);
+      if (line[i] == '#') continue;
+
+      if (xRunCommands(sock, line) < 0) break;
+
+      /* show a typed line's results before the next prompt */
+      if (interactive) xPipeDrain(sock, 0);
+
+      fflush(stdout);
+   }
+
+   if (interactive) printf("\n");
+
+   free(line);
+}
+
+int main(int argc , char *argv[])
+{
+   int sock;
+   int args, i, pp, l;
+   const char *userStr, *shareStr;
+
+   sock = xOpenSocket();
+
+   args = xInitOpts(argc, argv);
+
+   text[0] = 0;
+   l = 0;
+   pp = 0;
+
+   userStr = getenv(LG_ENVUSER);
+
+   if (userStr && strlen(userStr))
+   {
+      sprintf(text, "u %s ", userStr);
+      l = strlen(text);
+      pp = l;
+   }
+
+   shareStr = getenv(LG_ENVSHARE);
+
+   if (shareStr && strlen(shareStr))
+   {
+      sprintf(text+pp, "c %s ", shareStr);
+      l = strlen(text);
+      pp = l;
+   }
+
+   for (i=args; i<argc; i++)
+   {
+      l += (strlen(argv[i]) + 1);
+      if (l < sizeof(text)) {sprintf(text+pp, "%s ", argv[i]); pp=l;}
+   }
+
+   if (pp) {text[--pp] = 0;}
+
+   /* the user and share apply to the input commands as well */
+
+   if ((xRunCommands(sock, text) == 0) && readInput) xRunInput(sock);
+
+   xPipeDrain(sock, 0);
+
    if (sock >= 0) close(sock);
 
    return status;
 }
-